@@ -29,40 +29,55 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/time.h>
 #include <unistd.h>
 
+// Marcel: Built with -DDRAT_TRIM_LIBRARY, drat-trim is linked into ferat-check,
+// which hands it the already parsed formula, see drat_trim_check_arena. Every
+// exit of the checker then returns from there as a failed check instead.
+#ifdef DRAT_TRIM_LIBRARY
+#include <setjmp.h>
+static jmp_buf libraryExit;
+#define exit(code) longjmp(libraryExit, 1)
+#endif
+
 // Marcel: Magic numbers for various compression formats, taken from Armin
 //         Biere's KISSAT.
 #define MAX_SIGNATURE_SIZE (24)
 struct Compression {
-    char const *const suffix, *const cmd;
+    char const *const suffix, *const cmd, *const write_cmd;
     int const signature[MAX_SIGNATURE_SIZE];
 };
 #define NUM_COMPRESSION_FORMATS (5)
 static struct Compression const bz2 = {
     .suffix = ".bz2",
     .cmd = "bzip2 -c -d \"%s\"",
+    .write_cmd = "bzip2 -c > \"%s\"",
     .signature = {0x42, 0x5A, 0x68, EOF},
 };
 static struct Compression const gz = {
     .suffix = ".gz",
     .cmd = "gzip -c -d \"%s\"",
+    .write_cmd = "gzip -c > \"%s\"",
     .signature = {0x1F, 0x8B, EOF},
 };
 static struct Compression const lzma = {
     .suffix = ".lzma",
     .cmd = "lzma -c -d \"%s\"",
+    .write_cmd = "lzma -c > \"%s\"",
     .signature = {0x5D, 0x00, 0x00, 0x80, 0x00, EOF},
 };
 static struct Compression const _7z = {
     .suffix = ".7z",
     .cmd = "7z x -so \"%s\" 2>/dev/null",
+    .write_cmd = "7z a -si \"%s\" >/dev/null",
     .signature = {0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C, EOF},
 };
 static struct Compression const xz = {
     .suffix = ".xz",
     .cmd = "xz -c -d \"%s\"",
+    .write_cmd = "xz -c > \"%s\"",
     .signature = {0xFD, 0x37, 0x7A, 0x58, 0x5A, 0x00, 0x00, EOF},
 };
 static struct Compression const compression_formats[NUM_COMPRESSION_FORMATS] = {
@@ -137,8 +152,8 @@ static FILE *open_pipe(char const *const fmt, char const *const path,
         free(cmd);
         exit(0);
     }
+    // Marcel: The callers report a failed popen, so that it is never ignored
     FILE *pipe = popen(cmd, mode);
-    assert(pipe != NULL);
     free(cmd);
     return pipe;
 }
@@ -159,14 +174,126 @@ static struct CompressableFile open_to_read_compressed(char const *const path) {
     return out;
 }
 
-static void close_file(struct CompressableFile *const file) {
+// Marcel: Returns non-zero if closing failed, or the compressor of a pipe
+//         exited with an error
+static int close_file(struct CompressableFile *const file) {
     assert(file != NULL);
     assert(file->file != NULL);
+    int status;
     if (file->pipe)
-        pclose(file->file);
+        status = pclose(file->file);
     else
-        fclose(file->file);
+        status = fclose(file->file);
     file->file = NULL;
+    return status;
+}
+
+// Marcel: Buffered output. The core, lemma and LRAT files can hold tens of
+//         millions of literals, so instead of one fprintf per literal we
+//         format integers by hand into a large buffer and hand it to the
+//         (potentially compressing) output stream in one go.
+#define WRITER_BUFFER_SIZE (1 << 20)
+#define WRITER_MAX_INT_SIZE (24)
+
+struct Writer {
+    struct CompressableFile out;
+    int owned;
+    size_t used;
+    char buffer[WRITER_BUFFER_SIZE];
+};
+
+static struct Writer *open_writer(struct CompressableFile out, int owned) {
+    struct Writer *w = malloc(sizeof(struct Writer));
+    if (w == NULL) {
+        printf("c MEMOUT: allocation of output buffer failed\n");
+        exit(0);
+    }
+    w->out = out;
+    w->owned = owned;
+    w->used = 0;
+    return w;
+}
+
+// Open a file for writing. If the path ends in a known compression suffix, the
+// output is piped through the respective compressor.
+static struct Writer *open_to_write_compressed(char const *const path) {
+    assert(path != NULL);
+    struct CompressableFile out = {.file = NULL, .pipe = 0};
+    for (size_t i = 0; i < NUM_COMPRESSION_FORMATS; ++i)
+        if (file_has_suffix(path, compression_formats[i].suffix)) {
+            out.pipe = 1;
+            out.file = open_pipe(compression_formats[i].write_cmd, path, "w");
+            // Marcel: Never fall back to writing uncompressed data under the
+            //         name of a compressed file
+            if (out.file == NULL) {
+                printf("c ERROR: Unable to start compressor for '%s'\n", path);
+                exit(1);
+            }
+            break;
+        }
+    if (!out.pipe) out.file = fopen(path, "w");
+    if (out.file == NULL) {
+        printf("c ERROR: Unable to open file '%s' for writing\n", path);
+        exit(1);
+    }
+    return open_writer(out, 1);
+}
+
+// Wrap an already open stream, which stays open when the writer is closed
+static struct Writer *attach_writer(FILE *file) {
+    assert(file != NULL);
+    struct CompressableFile out = {.file = file, .pipe = 0};
+    return open_writer(out, 0);
+}
+
+static void flush_writer(struct Writer *w) {
+    if (w->used && fwrite(w->buffer, 1, w->used, w->out.file) != w->used) {
+        printf("c ERROR: Unable to write output\n");
+        exit(1);
+    }
+    w->used = 0;
+}
+
+static void close_writer(struct Writer *w) {
+    flush_writer(w);
+    if (w->owned) {
+        int const pipe = w->out.pipe;
+        if (close_file(&w->out) != 0) {
+            printf("c ERROR: Unable to %s output\n",
+                   pipe ? "compress" : "close");
+            exit(1);
+        }
+    } else
+        fflush(w->out.file);
+    free(w);
+}
+
+static inline void write_char(struct Writer *w, char c) {
+    if (w->used == WRITER_BUFFER_SIZE) flush_writer(w);
+    w->buffer[w->used++] = c;
+}
+
+static inline void write_str(struct Writer *w, char const *str) {
+    while (*str) write_char(w, *str++);
+}
+
+static inline void write_long(struct Writer *w, long value) {
+    if (w->used + WRITER_MAX_INT_SIZE > WRITER_BUFFER_SIZE) flush_writer(w);
+    char digits[WRITER_MAX_INT_SIZE];
+    unsigned long u = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    int n = 0;
+    do {
+        digits[n++] = '0' + (u % 10);
+        u /= 10;
+    } while (u);
+    if (value < 0) w->buffer[w->used++] = '-';
+    while (n) w->buffer[w->used++] = digits[--n];
+}
+
+// Write an integer followed by a separator, e.g. "-12 " or "0\n"
+static inline void write_int(struct Writer *w, long value, char sep) {
+    write_long(w, value);
+    w->buffer[w->used++] = sep;
 }
 
 // #define PARTIALPROOF
@@ -182,6 +309,7 @@ static void close_file(struct CompressableFile *const file) {
 #define PIVOT -2
 #define MAXDEP -3
 #define EXTRA 4     // ID + PIVOT + MAXDEP + terminating 0
+#define PACKED 3    // ID + PIVOT + terminating 0, MAXDEP only used by -O
 #define INFOBITS 2  // could be 1 for SAT, must be 2 for QBF
 #define DBIT 1
 #define ASSUMED 2
@@ -200,22 +328,40 @@ static void close_file(struct CompressableFile *const file) {
 
 #define COMPRESS
 
+// Marcel: Compact clause arena. When compiled with -DCOMPACT, all references
+// into the clause database (formula, proof, reasons, watches, units and the
+// hash buckets) are stored as 32-bit unsigned integers instead of longs. The
+// largest reference is an offset shifted left by INFOBITS, so the database may
+// hold at most REFLIMIT integers. Exceeding this limit is reported as MEMOUT.
+#ifdef COMPACT
+typedef unsigned int ref;
+#define REFLIMIT (((long)1 << (32 - INFOBITS)) - 1)
+#else
+typedef long ref;
+#define REFLIMIT (((long)1 << (63 - INFOBITS)) - 1)
+#endif
+
 struct solver {
     struct CompressableFile inputFile, proofFile;
     FILE *lratFile, *traceFile, *activeFile;
+    struct Writer *lratWriter;
     int *DB, nVars, timeout, mask, delete, *falseStack, *falseA, *forced,
         binMode, optimize, binOutput, *processed, *assigned, count, *used, *max,
         COREcount, RATmode, RATcount, nActive, *lratTable, nLemmas, maxRAT,
         *preRAT, maxDependencies, nDependencies, bar, backforce, reduce,
         *dependencies, maxVar, maxSize, mode, verb, unitSize, unitStackSize,
         prep, *current, nRemoved, warning, delProof, *setMap, *setTruth,
-        rupOnly;
-    char *coreStr, *lemmaStr;
+        rupOnly, extra;
+    char *coreStr, *lemmaStr, *mappings;
     struct timeval start_time;
     long mem_used, time, nClauses, nStep, nOpt, nAlloc, nOrigins, cOrigins,
-        *unitStack, *reason, lemmas, nResolve, *RATset, nReads, nWrites,
-        lratSize, lratAlloc, *lratLookup, **wlist, *optproof, *formula, *proof,
+        nMappings, cMappings, lemmas, nResolve, nReads, nWrites, lratSize, lratAlloc, *lratLookup,
         *origins;
+    ref *unitStack, *reason, *RATset, **wlist, *optproof, *formula, *proof;
+    // Marcel: The literals of the formula, each clause ending in 0, if they are
+    // already parsed, in which case inputFile is not read
+    int const *arena;
+    long arenaPos;
 };
 
 static inline void assign(struct solver *S, int lit) {
@@ -229,17 +375,22 @@ int abscompare(const void *a, const void *b) {
     return (abs(*(int *)a) - abs(*(int *)b));
 }
 
+int refcompare(const void *a, const void *b) {
+    ref x = *(ref *)a, y = *(ref *)b;
+    return (x > y) - (x < y);
+}
+
 static inline void printClause(int *clause) {
     printf("[%i] ", clause[ID]);
     while (*clause) printf("%i ", *clause++);
     printf("0\n");
 }
 
-static inline void addWatchPtr(struct solver *S, int lit, long watch) {
+static inline void addWatchPtr(struct solver *S, int lit, ref watch) {
     if (S->used[lit] + 1 == S->max[lit]) {
         S->max[lit] *= 1.5;
         S->wlist[lit] =
-            (long *)realloc(S->wlist[lit], sizeof(long) * S->max[lit]);
+            (ref *)realloc(S->wlist[lit], sizeof(ref) * S->max[lit]);
         if (S->wlist[lit] == NULL) {
             printf("c MEMOUT: reallocation failed for watch list of %i\n", lit);
             exit(0);
@@ -250,7 +401,7 @@ static inline void addWatchPtr(struct solver *S, int lit, long watch) {
 }
 
 static inline void addWatch(struct solver *S, int *clause, int index) {
-    addWatchPtr(S, clause[index], ((long)(((clause)-S->DB)) << 1));
+    addWatchPtr(S, clause[index], ((ref)(((clause)-S->DB)) << 1));
 }
 
 static inline void removeWatch(struct solver *S, int *clause, int index) {
@@ -258,10 +409,10 @@ static inline void removeWatch(struct solver *S, int *clause, int index) {
     if ((S->used[lit] > INIT) && (S->max[lit] > 2 * S->used[lit])) {
         S->max[lit] = (3 * S->used[lit]) >> 1;
         S->wlist[lit] =
-            (long *)realloc(S->wlist[lit], sizeof(long) * S->max[lit]);
+            (ref *)realloc(S->wlist[lit], sizeof(ref) * S->max[lit]);
         assert(S->wlist[lit] != NULL);
     }
-    long *watch = S->wlist[lit];
+    ref *watch = S->wlist[lit];
     for (i = 0; i < S->used[lit]; i++) {
         int *_clause = S->DB + (*(watch++) >> 1);
         if (_clause == clause) {
@@ -272,12 +423,12 @@ static inline void removeWatch(struct solver *S, int *clause, int index) {
     }
 }
 
-static inline void addUnit(struct solver *S, long index) {
+static inline void addUnit(struct solver *S, ref index) {
     //  printf("c adding unit %i\n", S->DB[index]);
     if (S->unitSize >= S->unitStackSize) {
         S->unitStackSize = (S->unitStackSize * 3) >> 1;
         S->unitStack =
-            (long *)realloc(S->unitStack, sizeof(long) * S->unitStackSize);
+            (ref *)realloc(S->unitStack, sizeof(ref) * S->unitStackSize);
         if (S->unitStack == NULL) {
             printf("c failed to reallocate unit stack\n");
             exit(0);
@@ -307,7 +458,7 @@ static inline void unassignUnit(struct solver *S, int lit) {
 
 static inline void markWatch(struct solver *S, int *clause, int index,
                              int offset) {
-    long *watch = S->wlist[clause[index]];
+    ref *watch = S->wlist[clause[index]];
     for (;;) {
         int *_clause = (S->DB + (*(watch++) >> 1) + (long)offset);
         if (_clause == clause) {
@@ -318,7 +469,10 @@ static inline void markWatch(struct solver *S, int *clause, int index,
 }
 
 static inline void addDependency(struct solver *S, int dep, int forced) {
-    if (1 || S->traceFile || S->lratFile) {  // temporary for MAXDEP
+    // Marcel: The dependencies are only needed for the TRACECHECK and LRAT
+    // output, or to compute MAXDEP when optimizing (-O). Otherwise, the table
+    // is not even allocated.
+    if (S->dependencies) {
         if (S->nDependencies == S->maxDependencies) {
             S->maxDependencies = (S->maxDependencies * 3) >> 1;
             //      printf ("c dependencies increased to %i\n",
@@ -348,7 +502,7 @@ static inline void markClause(struct solver *S, int *clause, int index) {
         // #endif
         if ((S->mode == BACKWARD_UNSAT) && clause[index + 1]) {
             S->optproof[S->nOpt++] =
-                (((long)(clause - S->DB) + index) << INFOBITS) + 1;
+                (((ref)(clause - S->DB) + index) << INFOBITS) + 1;
         }
         if (clause[1 + index] == 0) return;
         markWatch(S, clause, index, -index);
@@ -403,7 +557,7 @@ int propagate(struct solver *S, int init,
     int *start[2];
     int check = 0, mode = !S->prep;
     int i, lit, _lit = 0;
-    long *watch, *_watch;
+    ref *watch, *_watch;
     start[0] = start[1] = S->processed;
 flip_check:;
     check ^= 1;
@@ -446,7 +600,7 @@ flip_check:;
                                           // falsified,
                 assign(S, clause[0]);  // A unit clause is found, and the reason
                                        // is set
-                S->reason[abs(clause[0])] = ((long)((clause)-S->DB)) + 1;
+                S->reason[abs(clause[0])] = ((ref)((clause)-S->DB)) + 1;
                 if (!check) {
                     start[0]--;
                     _lit = lit;
@@ -516,45 +670,49 @@ void printCore(struct solver *S) {
            S->COREcount, S->nClauses);
 
     if (S->coreStr) {
-        FILE *coreFile = fopen(S->coreStr, "w");
+        struct Writer *coreFile = open_to_write_compressed(S->coreStr);
+        write_str(coreFile, S->mappings);
         if (S->nOrigins > 0) {
             assert(S->origins != NULL);
             // Marcel: Reconstruct the origin mapping comment of form:
             //   c o 1 3 2 ... 93 ... 0
-            fprintf(coreFile, "c o");
+            write_str(coreFile, "c o ");
             long origin = -1;
             for (i = 0; i < S->nClauses; i++) {
                 int *clause = S->DB + (S->formula[i] >> INFOBITS);
                 if (clause[ID] & ACTIVE) {
                     origin = S->origins[i];
                     assert(origin >= 0);
-                    fprintf(coreFile, " %ld", origin);
+                    write_int(coreFile, origin, ' ');
                 }
             }
             // Marcel: Last origin should be 0
-            fprintf(coreFile, " 0\n");
+            write_str(coreFile, "0\n");
         }
-        fprintf(coreFile, "p cnf %i %i\n", S->nVars, S->COREcount);
+        write_str(coreFile, "p cnf ");
+        write_int(coreFile, S->nVars, ' ');
+        write_int(coreFile, S->COREcount, '\n');
         for (i = 0; i < S->nClauses; i++) {
             int *clause = S->DB + (S->formula[i] >> INFOBITS);
             if (clause[ID] & ACTIVE) {
-                while (*clause) fprintf(coreFile, "%i ", *clause++);
-                fprintf(coreFile, "0\n");
+                while (*clause) write_int(coreFile, *clause++, ' ');
+                write_str(coreFile, "0\n");
             }
         }
-        fclose(coreFile);
+        close_writer(coreFile);
     }
 }
 
-void write_lit(struct solver *S, FILE *output, int lit) {  // change to long?
+void write_lit(struct solver *S, struct Writer *output,
+               int lit) {  // change to long?
     unsigned int l = abs(lit) << 1;
     if (lit < 0) l++;
 
     do {
         if (l <= 127) {
-            fputc((char)l, output);
+            write_char(output, (char)l);
         } else {
-            fputc((char)(128 + (l & 127)), output);
+            write_char(output, (char)(128 + (l & 127)));
         }
         S->nWrites++;
         l = l >> 7;
@@ -563,18 +721,19 @@ void write_lit(struct solver *S, FILE *output, int lit) {  // change to long?
 
 void printLRATline(struct solver *S, int time) {
     int *line = S->lratTable + S->lratLookup[time];
+    struct Writer *lratFile = S->lratWriter;
     if (S->binOutput) {
-        fputc('a', S->lratFile);
+        write_char(lratFile, 'a');
         S->nWrites++;
-        while (*line) write_lit(S, S->lratFile, *line++);
-        write_lit(S, S->lratFile, *line++);
-        while (*line) write_lit(S, S->lratFile, *line++);
-        write_lit(S, S->lratFile, *line++);
+        while (*line) write_lit(S, lratFile, *line++);
+        write_lit(S, lratFile, *line++);
+        while (*line) write_lit(S, lratFile, *line++);
+        write_lit(S, lratFile, *line++);
     } else {
-        while (*line) fprintf(S->lratFile, "%i ", *line++);
-        fprintf(S->lratFile, "%i ", *line++);
-        while (*line) fprintf(S->lratFile, "%i ", *line++);
-        fprintf(S->lratFile, "%i\n", *line++);
+        while (*line) write_int(lratFile, *line++, ' ');
+        write_int(lratFile, *line++, ' ');
+        while (*line) write_int(lratFile, *line++, ' ');
+        write_int(lratFile, *line++, '\n');
     }
 }
 
@@ -596,7 +755,7 @@ void printProof(struct solver *S) {
     if (S->mode == BACKWARD_UNSAT) {
         if (S->nOpt > S->nAlloc) {
             S->nAlloc = S->nOpt;
-            S->proof = (long *)realloc(S->proof, sizeof(long) * S->nAlloc);
+            S->proof = (ref *)realloc(S->proof, sizeof(ref) * S->nAlloc);
             if (S->proof == NULL) {
                 printf("c MEMOUT: reallocation of proof list failed\n");
                 exit(0);
@@ -615,7 +774,7 @@ void printProof(struct solver *S) {
     }  // why not reuse ad?
 
     if (S->lemmaStr) {
-        FILE *lemmaFile = fopen(S->lemmaStr, "w");
+        struct Writer *lemmaFile = open_to_write_compressed(S->lemmaStr);
         for (step = 0; step < S->nStep; step++) {
             long ad = S->proof[step];
             int *lemmas = S->DB + (ad >> INFOBITS);
@@ -623,11 +782,11 @@ void printProof(struct solver *S) {
             if (S->binOutput) {
                 S->nWrites++;
                 if (ad & 1)
-                    fputc('d', lemmaFile);
+                    write_char(lemmaFile, 'd');
                 else
-                    fputc('a', lemmaFile);
+                    write_char(lemmaFile, 'a');
             } else if (ad & 1)
-                fprintf(lemmaFile, "d ");
+                write_str(lemmaFile, "d ");
             int reslit = lemmas[PIVOT];
             while (*lemmas) {
                 int lit = *lemmas++;
@@ -635,7 +794,7 @@ void printProof(struct solver *S) {
                     if (S->binOutput)
                         write_lit(S, lemmaFile, lit);
                     else
-                        fprintf(lemmaFile, "%i ", lit);
+                        write_int(lemmaFile, lit, ' ');
                 }
             }
             lemmas = S->DB + (ad >> INFOBITS);
@@ -645,23 +804,24 @@ void printProof(struct solver *S) {
                     if (S->binOutput)
                         write_lit(S, lemmaFile, lit);
                     else
-                        fprintf(lemmaFile, "%i ", lit);
+                        write_int(lemmaFile, lit, ' ');
                 }
             }
             if (S->binOutput)
                 write_lit(S, lemmaFile, 0);
             else
-                fprintf(lemmaFile, "0\n");
+                write_str(lemmaFile, "0\n");
         }
         if (S->binOutput) {
-            fputc('a', lemmaFile);
+            write_char(lemmaFile, 'a');
             write_lit(S, lemmaFile, 0);
         } else
-            fprintf(lemmaFile, "0\n");
-        fclose(lemmaFile);
+            write_str(lemmaFile, "0\n");
+        close_writer(lemmaFile);
     }
 
     if (S->lratFile) {
+        struct Writer *lratFile = S->lratWriter;
         int lastAdded = S->nClauses;
         int flag = 0;
         for (step = 0; step < S->nStep; step++) {
@@ -670,9 +830,9 @@ void printProof(struct solver *S) {
             if ((ad & 1) == 0) {
                 if (lastAdded == 0) {
                     if (S->binOutput) {
-                        write_lit(S, S->lratFile, 0);
+                        write_lit(S, lratFile, 0);
                     } else {
-                        fprintf(S->lratFile, "0\n");
+                        write_str(lratFile, "0\n");
                     }
                 }
                 lastAdded = lemmas[ID] >> 1;
@@ -684,30 +844,33 @@ void printProof(struct solver *S) {
             else if (ad & 1) {
                 if (lastAdded != 0) {
                     if (S->binOutput) {
-                        fputc('d', S->lratFile);
+                        write_char(lratFile, 'd');
                         S->nWrites++;
                     } else {
-                        fprintf(S->lratFile, "%i d ", lastAdded);
+                        write_int(lratFile, lastAdded, ' ');
+                        write_str(lratFile, "d ");
                     }
                 }
                 lastAdded = 0;
                 if (S->binOutput) {
-                    write_lit(S, S->lratFile, lemmas[ID] >> 1);
+                    write_lit(S, lratFile, lemmas[ID] >> 1);
                 } else {
-                    fprintf(S->lratFile, "%i ", lemmas[ID] >> 1);
+                    write_int(lratFile, lemmas[ID] >> 1, ' ');
                 }
             }
         }
         if (lastAdded != S->nClauses) {
             if (S->binOutput) {
-                write_lit(S, S->lratFile, 0);
+                write_lit(S, lratFile, 0);
             } else {
-                fprintf(S->lratFile, "0\n");
+                write_str(lratFile, "0\n");
             }
         }
 
         printLRATline(S, S->count);
 
+        close_writer(lratFile);
+        S->lratWriter = NULL;
         fclose(S->lratFile);
         if (S->nWrites)
             printf("c wrote optimized proof in LRAT format of %li bytes\n",
@@ -717,31 +880,67 @@ void printProof(struct solver *S) {
 
 void printNoCore(struct solver *S) {
     if (S->lratFile) {
+        struct Writer *lratFile = S->lratWriter = attach_writer(S->lratFile);
         if (S->binOutput) {
-            fputc('d', S->lratFile);
+            write_char(lratFile, 'd');
             S->nWrites++;
         } else {
-            fprintf(S->lratFile, "%ld d ", S->nClauses);
+            write_int(lratFile, S->nClauses, ' ');
+            write_str(lratFile, "d ");
         }
         int i;
         for (i = 0; i < S->nClauses; i++) {
             int *clause = S->DB + (S->formula[i] >> INFOBITS);
             if ((clause[ID] & ACTIVE) == 0) {
                 if (S->binOutput) {
-                    write_lit(S, S->lratFile, clause[ID] >> 1);
+                    write_lit(S, lratFile, clause[ID] >> 1);
                 } else {
-                    fprintf(S->lratFile, "%i ", clause[ID] >> 1);
+                    write_int(lratFile, clause[ID] >> 1, ' ');
                 }
             }
         }
         if (S->binOutput) {
-            write_lit(S, S->lratFile, 0);
+            write_lit(S, lratFile, 0);
         } else {
-            fprintf(S->lratFile, "0\n");
+            write_str(lratFile, "0\n");
         }
     }
 }
 
+// Marcel: Print an LRAT line deriving the empty clause with the given
+//         zero-terminated hints, in text or binary format
+void printUnitLRAT(struct solver *S, long id, int *hints) {
+    struct Writer *lratFile = attach_writer(S->lratFile);
+    if (S->binOutput) {
+        write_char(lratFile, 'a');
+        write_lit(S, lratFile, id);
+        write_lit(S, lratFile, 0);
+        while (*hints) write_lit(S, lratFile, *hints++);
+        write_lit(S, lratFile, 0);
+    } else {
+        write_int(lratFile, id, ' ');
+        write_str(lratFile, "0 ");
+        while (*hints) write_int(lratFile, *hints++, ' ');
+        write_str(lratFile, "0\n");
+    }
+    close_writer(lratFile);
+}
+
+// Marcel: If the formula already contains the empty clause, the LRAT proof only
+//         needs to derive it once more, using the empty clause as hint.
+void printTrivialLRAT(struct solver *S) {
+    int i;
+    for (i = 0; i < S->nClauses; i++) {
+        int *clause = S->DB + (S->formula[i] >> INFOBITS);
+        if (clause[0] == 0) {
+            int hints[2] = {i + 1, 0};
+            printUnitLRAT(S, S->nClauses + 1, hints);
+            break;
+        }
+    }
+    fclose(S->lratFile);
+}
+
 // print the dependency graph to traceFile in TraceCheck+ format
 // this procedure adds the active clauses at the end of the trace
 void printTrace(struct solver *S) {
@@ -893,7 +1092,9 @@ void printDependenciesFile(struct solver *S, int *clause, int RATflag,
 }
 
 void printDependencies(struct solver *S, int *clause, int RATflag) {
-    if (clause != NULL) {
+    // Marcel: MAXDEP is only read when shuffling the proof (-O), and packed
+    // clause headers do not even reserve space for it.
+    if (clause != NULL && S->optimize) {
         int i;
         clause[MAXDEP] = 0;
         for (i = 0; i < S->nDependencies; i++) {
@@ -930,7 +1131,7 @@ int checkRAT(struct solver *S, int pivot, int mark) {
                         if (nRAT == S->maxRAT) {
                             S->maxRAT = (S->maxRAT * 3) >> 1;
                             S->RATset =
-                                realloc(S->RATset, sizeof(long) * S->maxRAT);
+                                realloc(S->RATset, sizeof(ref) * S->maxRAT);
                             assert(S->RATset != NULL);
                         }
                         S->RATset[nRAT++] = S->wlist[i][j] >> 1;
@@ -943,7 +1144,7 @@ int checkRAT(struct solver *S, int pivot, int mark) {
     // S->prep = 1;
     // Check all clauses in RATset for RUP
     int flag = 1;
-    qsort(S->RATset, nRAT, sizeof(long), compare);
+    qsort(S->RATset, nRAT, sizeof(ref), refcompare);
     S->nDependencies = 0;
     for (i = nRAT - 1; i >= 0; i--) {
         int *RATcls = (int *)(S->DB + S->RATset[i]);
@@ -1141,14 +1342,16 @@ int init(struct solver *S) {
         if (clause[0] == 0) {
             printf("\rc formula contains empty clause\n");
             if (S->coreStr) {
-                FILE *coreFile = fopen(S->coreStr, "w");
-                fprintf(coreFile, "p cnf 0 1\n 0\n");
-                fclose(coreFile);
+                struct Writer *coreFile = open_to_write_compressed(S->coreStr);
+                write_str(coreFile, S->mappings);
+                write_str(coreFile, "p cnf 0 1\n 0\n");
+                close_writer(coreFile);
             }
             if (S->lemmaStr) {
-                FILE *lemmaFile = fopen(S->lemmaStr, "w");
-                fprintf(lemmaFile, "0\n");
-                fclose(lemmaFile);
+                struct Writer *lemmaFile =
+                    open_to_write_compressed(S->lemmaStr);
+                write_str(lemmaFile, "0\n");
+                close_writer(lemmaFile);
             }
             return UNSAT;
         }
@@ -1158,7 +1361,7 @@ int init(struct solver *S) {
         } else if (S->falseA[clause[0]]) {
             printf("\rc found complementary unit clauses: %i\n", clause[0]);
             if (S->coreStr) {
-                FILE *coreFile = fopen(S->coreStr, "w");
+                struct Writer *coreFile = open_to_write_compressed(S->coreStr);
                 // Marcel: Also include the 'c o 1 2 ... 5 0' mapping here!
                 //         Here, we find the index of the complementary unit
                 //         clause.
@@ -1180,15 +1383,24 @@ int init(struct solver *S) {
                 assert(i < S->nOrigins);
                 assert(complUnitIdx < S->nOrigins);
                 assert(complUnitIdx >= 0);
-                fprintf(coreFile, "c o %lu %lu 0\np cnf %i 2\n%i 0\n%i 0\n",
-                        S->origins[i], S->origins[complUnitIdx], abs(clause[0]),
-                        clause[0], -clause[0]);
-                fclose(coreFile);
+                write_str(coreFile, S->mappings);
+                write_str(coreFile, "c o ");
+                write_int(coreFile, S->origins[i], ' ');
+                write_int(coreFile, S->origins[complUnitIdx], ' ');
+                write_str(coreFile, "0\np cnf ");
+                write_int(coreFile, abs(clause[0]), ' ');
+                write_str(coreFile, "2\n");
+                write_int(coreFile, clause[0], ' ');
+                write_str(coreFile, "0\n");
+                write_int(coreFile, -clause[0], ' ');
+                write_str(coreFile, "0\n");
+                close_writer(coreFile);
             }
             if (S->lemmaStr) {
-                FILE *lemmaFile = fopen(S->lemmaStr, "w");
-                fprintf(lemmaFile, "0\n");
-                fclose(lemmaFile);
+                struct Writer *lemmaFile =
+                    open_to_write_compressed(S->lemmaStr);
+                write_str(lemmaFile, "0\n");
+                close_writer(lemmaFile);
             }
             if (S->lratFile) {
                 int j;
@@ -1196,12 +1408,12 @@ int init(struct solver *S) {
                     int *_clause = S->DB + (S->formula[j] >> INFOBITS);
                     if ((_clause[0] == -clause[0]) && !_clause[1]) break;
                 }
-                fprintf(S->lratFile, "%li 0 %i %i 0\n", S->nClauses + 1, j + 1,
-                        i + 1);
+                int hints[3] = {j + 1, i + 1, 0};
+                printUnitLRAT(S, S->nClauses + 1, hints);
             }
             return UNSAT;
         } else if (!S->falseA[-clause[0]]) {
-            addUnit(S, (long)(clause - S->DB));
+            addUnit(S, (ref)(clause - S->DB));
             assign(S, clause[0]);
         }
     }
@@ -1268,7 +1480,7 @@ int verify(struct solver *S, int begin, int end) {
                     S->proof[step] = 0;
                     continue;
                 } else {
-                    addUnit(S, (long)(lemmas - S->DB));
+                    addUnit(S, (ref)(lemmas - S->DB));
                 }
             }
         }
@@ -1345,7 +1557,7 @@ int verify(struct solver *S, int begin, int end) {
         if (size == 1) {
             if (S->verb) printf("\rc found unit %i\n", lemmas[0]);
             assign(S, lemmas[0]);
-            S->reason[abs(lemmas[0])] = ((long)((lemmas)-S->DB)) + 1;
+            S->reason[abs(lemmas[0])] = ((ref)((lemmas)-S->DB)) + 1;
             if (propagate(S, 1, 1) == UNSAT) goto start_verification;
             S->forced = S->processed;
         }
@@ -1507,15 +1719,15 @@ start_verification:;
     return UNSAT;
 }
 
-long matchClause(struct solver *S, long *clauselist, int listsize, int *input,
-                 int size) {
+ref matchClause(struct solver *S, ref *clauselist, int listsize, int *input,
+                int size) {
     int i, j;
     for (i = 0; i < listsize; ++i) {
         int *clause = S->DB + clauselist[i];
         for (j = 0; j <= size; j++)
             if (clause[j] != input[j]) goto match_next;
 
-        long result = clauselist[i];
+        ref result = clauselist[i];
         clauselist[i] = clauselist[--listsize];
         return result;
     match_next:;
@@ -1623,20 +1835,38 @@ void shuffleProof(struct solver *S, int iteration) {
     }
 }
 
+// Marcel: Append a character to the NUL-terminated expansion mappings
+static void addMapping(struct solver *S, char c) {
+    if (S->nMappings + 1 >= S->cMappings) {
+        S->cMappings = (S->cMappings * 3) >> 1;
+        S->mappings = (char *)realloc(S->mappings, sizeof(char) * S->cMappings);
+        if (S->mappings == NULL) {
+            printf("c MEMOUT: failed to reallocate expansion mappings\n");
+            exit(0);
+        }
+    }
+    S->mappings[S->nMappings++] = c;
+    S->mappings[S->nMappings] = 0;
+}
+
 int parse(struct solver *S) {
     int tmp, active = 0, retvalue = SAT;
     int del = 0, fileLine = 0;
     int *buffer, bufferAlloc;
 
-    S->nVars = 0;
-    S->nClauses = 0;
+    // Marcel: The header of an arena is already known
+    if (S->arena == NULL) S->nVars = 0, S->nClauses = 0;
     S->nOrigins = 0;
     S->cOrigins = BIGINIT;
     S->origins = (long *)malloc(sizeof(long) * S->cOrigins);
+    S->nMappings = 0;
+    S->cMappings = INIT;
+    S->mappings = (char *)malloc(sizeof(char) * S->cMappings);
+    S->mappings[0] = 0;
 
     int found_origin = 0;
     char c;
-    while (!feof(S->inputFile.file)) {
+    while ((S->arena == NULL) && !feof(S->inputFile.file)) {
         tmp = fscanf(S->inputFile.file, " p cnf %i %li \n", &S->nVars,
                      &S->nClauses);  // Read the first line
         if (tmp == 2 || tmp == EOF) break;
@@ -1703,6 +1933,18 @@ int parse(struct solver *S) {
                         "by 0, as specified in the FERAT pipeline\n");
                 if (S->warning == HARDWARNING) exit(HARDWARNING);
             }
+        } else if (c == 'x' && (S->coreStr != NULL)) {
+            // Marcel: The 'c x ...' expansion mapping comments are copied into
+            // the core as they are, so that it is a complete CNF expansion
+            // again, next to the 'c o ...' comment we reconstruct
+            addMapping(S, 'c');
+            addMapping(S, ' ');
+            addMapping(S, 'x');
+            addMapping(S, ' ');
+            int ch;
+            while ((ch = fgetc(S->inputFile.file)) != EOF && ch != '\n')
+                addMapping(S, ch);
+            addMapping(S, '\n');
         } else {
             // Marcel: Consume the rest of an ordinary comment line
             while (!feof(S->inputFile.file) &&
@@ -1746,9 +1988,9 @@ int parse(struct solver *S) {
     S->maxSize = 0;
     S->nLemmas = 0;
     S->nAlloc = BIGINIT;
-    S->formula = (long *)malloc(sizeof(long) * S->nClauses);
-    S->proof = (long *)malloc(sizeof(long) * S->nAlloc);
-    long **hashTable = (long **)malloc(sizeof(long *) * BIGINIT);
+    S->formula = (ref *)malloc(sizeof(ref) * S->nClauses);
+    S->proof = (ref *)malloc(sizeof(ref) * S->nAlloc);
+    ref **hashTable = (ref **)malloc(sizeof(ref *) * BIGINIT);
     int *hashUsed = (int *)malloc(sizeof(int) * BIGINIT);
     int *hashMax = (int *)malloc(sizeof(int) * BIGINIT);
 
@@ -1756,7 +1998,7 @@ int parse(struct solver *S) {
     for (i = 0; i < BIGINIT; i++) {
         hashUsed[i] = 0;
         hashMax[i] = INIT;
-        hashTable[i] = (long *)malloc(sizeof(long) * hashMax[i]);
+        hashTable[i] = (ref *)malloc(sizeof(ref) * hashMax[i]);
     }
 
     int fileSwitchFlag = 0;
@@ -1796,10 +2038,13 @@ int parse(struct solver *S) {
         }
 
         if (!lit) {
-            if (!fileSwitchFlag)
-                tmp =
-                    fscanf(S->inputFile.file, " %i ", &lit);  // Read a literal.
-            else {
+            if (!fileSwitchFlag) {
+                if (S->arena != NULL)
+                    tmp = 1, lit = S->arena[S->arenaPos++];
+                else
+                    tmp = fscanf(S->inputFile.file, " %i ",
+                                 &lit);  // Read a literal.
+            } else {
                 if (S->binMode == 1) {
                     tmp = read_lit(S, &lit);
                 } else {
@@ -1886,7 +2131,7 @@ int parse(struct solver *S) {
             unsigned int hash = getHash(buffer);
             if (del) {
                 if (S->delete) {
-                    long match = 0;
+                    ref match = 0;
                     match = matchClause(S, hashTable[hash], hashUsed[hash],
                                         buffer, size);
                     if (match == 0) {
@@ -1906,7 +2151,7 @@ int parse(struct solver *S) {
                     if (S->nStep == S->nAlloc) {
                         S->nAlloc = (S->nAlloc * 3) >> 1;
                         S->proof =
-                            (long *)realloc(S->proof, sizeof(long) * S->nAlloc);
+                            (ref *)realloc(S->proof, sizeof(ref) * S->nAlloc);
                         //              printf ("c proof allocation increased to
                         //              %li\n", S->nAlloc);
                         if (S->proof == NULL) {
@@ -1926,8 +2171,16 @@ int parse(struct solver *S) {
                 }
             }
 
-            if (S->mem_used + size + EXTRA >= DBsize) {
+            if (S->mem_used + size + S->extra >= DBsize) {
                 DBsize = (DBsize * 3) >> 1;
+                if (DBsize > REFLIMIT) DBsize = REFLIMIT;
+                if (S->mem_used + size + S->extra >= DBsize) {
+                    printf(
+                        "c MEMOUT: clause database exceeds %li integers, which "
+                        "is the limit of the compact arena\n",
+                        (long)REFLIMIT);
+                    exit(0);
+                }
                 S->DB = (int *)realloc(S->DB, DBsize * sizeof(int));
                 //        printf("c database increased to %li\n", DBsize);
                 if (S->DB == NULL) {
@@ -1936,11 +2189,11 @@ int parse(struct solver *S) {
                     exit(0);
                 }
             }
-            int *clause = &S->DB[S->mem_used + EXTRA - 1];
+            int *clause = &S->DB[S->mem_used + S->extra - 1];
             if (size != 0) clause[PIVOT] = pivot;
             clause[ID] = 2 * S->count;
             S->count++;
-            finalClause = S->mem_used + EXTRA - 1;
+            finalClause = S->mem_used + S->extra - 1;
             if (S->mode == FORWARD_SAT)
                 if (nZeros > 0) clause[ID] |= ACTIVE;
 
@@ -1948,30 +2201,30 @@ int parse(struct solver *S) {
                 clause[i] = buffer[i];
             }
             clause[i] = 0;
-            S->mem_used += size + EXTRA;
+            S->mem_used += size + S->extra;
 
             hash = getHash(clause);
             if (hashUsed[hash] == hashMax[hash]) {
                 hashMax[hash] = (hashMax[hash] * 3) >> 1;
-                hashTable[hash] = (long *)realloc(
-                    hashTable[hash], sizeof(long *) * hashMax[hash]);
+                hashTable[hash] = (ref *)realloc(hashTable[hash],
+                                                 sizeof(ref) * hashMax[hash]);
                 if (hashTable[hash] == NULL) {
                     printf("c MEMOUT reallocation of hash table %i failed\n",
                            hash);
                     exit(0);
                 }
             }
-            hashTable[hash][hashUsed[hash]++] = (long)(clause - S->DB);
+            hashTable[hash][hashUsed[hash]++] = (ref)(clause - S->DB);
 
             active++;
             if (nZeros > 0) {  // if still parsing the formula
                 S->formula[S->nClauses - nZeros] =
-                    (((long)(clause - S->DB)) << INFOBITS);
+                    (((ref)(clause - S->DB)) << INFOBITS);
             } else {
                 if (S->nStep == S->nAlloc) {
                     S->nAlloc = (S->nAlloc * 3) >> 1;
                     S->proof =
-                        (long *)realloc(S->proof, sizeof(long) * S->nAlloc);
+                        (ref *)realloc(S->proof, sizeof(ref) * S->nAlloc);
                     //        printf ("c proof allocation increased to %li\n",
                     //        S->nAlloc);
                     if (S->proof == NULL) {
@@ -1979,7 +2232,7 @@ int parse(struct solver *S) {
                         exit(0);
                     }
                 }
-                S->proof[S->nStep++] = (((long)(clause - S->DB)) << INFOBITS);
+                S->proof[S->nStep++] = (((ref)(clause - S->DB)) << INFOBITS);
             }
 
             if (nZeros <= 0) S->nLemmas++;
@@ -2018,7 +2271,7 @@ int parse(struct solver *S) {
                 if (S->nStep == S->nAlloc) {
                     S->nAlloc = (S->nAlloc * 3) >> 1;
                     S->proof =
-                        (long *)realloc(S->proof, sizeof(long) * S->nAlloc);
+                        (ref *)realloc(S->proof, sizeof(ref) * S->nAlloc);
                     //          printf ("c proof allocation increased to %li\n",
                     //          S->nAlloc);
                     if (S->proof == NULL) {
@@ -2027,7 +2280,7 @@ int parse(struct solver *S) {
                     }
                 }
                 S->proof[S->nStep++] =
-                    (((long)(clause - S->DB)) << INFOBITS) + 1;
+                    (((ref)(clause - S->DB)) << INFOBITS) + 1;
             }
         }
     }
@@ -2055,7 +2308,7 @@ int parse(struct solver *S) {
     S->falseStack =
         (int *)malloc((n + 1) * sizeof(int));  // Stack of falsified literals --
                                                // this pointer is never changed
-    S->reason = (long *)malloc((n + 1) * sizeof(long));  // Array of clauses
+    S->reason = (ref *)malloc((n + 1) * sizeof(ref));  // Array of clauses
     S->used = (int *)malloc((2 * n + 1) * sizeof(int));
     S->used += n;  // Labels for variables, non-zero means false
     S->max = (int *)malloc((2 * n + 1) * sizeof(int));
@@ -2067,37 +2320,52 @@ int parse(struct solver *S) {
     S->setTruth = (int *)malloc((2 * n + 1) * sizeof(int));
     S->setTruth += n;  // Labels for variables, non-zero means false
 
-    S->optproof = (long *)malloc(sizeof(long) * (2 * S->nLemmas + S->nClauses));
+    S->optproof = (ref *)malloc(sizeof(ref) * (2 * S->nLemmas + S->nClauses));
 
     S->maxRAT = INIT;
-    S->RATset = (long *)malloc(sizeof(long) * S->maxRAT);
+    S->RATset = (ref *)malloc(sizeof(ref) * S->maxRAT);
     for (i = 0; i < S->maxRAT; i++) S->RATset[i] = 0;  // is this required?
 
-    S->preRAT = (int *)malloc(sizeof(int) * n);
-
+    // Marcel: The dependency and LRAT tables are only allocated when the
+    // output requested on the command line needs them. The lookup table alone
+    // holds one long per clause and lemma.
+    S->preRAT = NULL;
+    S->lratTable = NULL;
+    S->lratLookup = NULL;
+    S->dependencies = NULL;
     S->lratAlloc = INIT;
     S->lratSize = 0;
-    S->lratTable = (int *)malloc(sizeof(int) * S->lratAlloc);
-    S->lratLookup = (long *)malloc(sizeof(long) * (S->count + 1));
+    if (S->traceFile || S->lratFile) {
+        S->preRAT = (int *)malloc(sizeof(int) * n);
+        S->lratTable = (int *)malloc(sizeof(int) * S->lratAlloc);
+        S->lratLookup = (long *)malloc(sizeof(long) * (S->count + 1));
+        if (S->preRAT == NULL || S->lratTable == NULL ||
+            S->lratLookup == NULL) {
+            printf("c MEMOUT: allocation of LRAT tables failed\n");
+            exit(0);
+        }
+    }
 
     S->maxDependencies = INIT;
-    S->dependencies = (int *)malloc(sizeof(int) * S->maxDependencies);
-    for (i = 0; i < S->maxDependencies; i++)
-        S->dependencies[i] = 0;  // is this required?
+    if (S->traceFile || S->lratFile || S->optimize) {
+        S->dependencies = (int *)malloc(sizeof(int) * S->maxDependencies);
+        for (i = 0; i < S->maxDependencies; i++)
+            S->dependencies[i] = 0;  // is this required?
+    }
 
-    S->wlist = (long **)malloc(sizeof(long *) * (2 * n + 1));
+    S->wlist = (ref **)malloc(sizeof(ref *) * (2 * n + 1));
     S->wlist += n;
 
     for (i = 1; i <= n; ++i) {
         S->max[i] = S->max[-i] = INIT;
         S->setMap[i] = S->setMap[-i] = 0;
         S->setTruth[i] = S->setTruth[-i] = 0;
-        S->wlist[i] = (long *)malloc(sizeof(long) * S->max[i]);
-        S->wlist[-i] = (long *)malloc(sizeof(long) * S->max[-i]);
+        S->wlist[i] = (ref *)malloc(sizeof(ref) * S->max[i]);
+        S->wlist[-i] = (ref *)malloc(sizeof(ref) * S->max[-i]);
     }
 
     S->unitStackSize = INIT;
-    S->unitStack = (long *)malloc(sizeof(long) * S->unitStackSize);
+    S->unitStack = (ref *)malloc(sizeof(ref) * S->unitStackSize);
 
     return retvalue;
 }
@@ -2109,6 +2377,7 @@ void freeMemory(struct solver *S) {
     free(S->proof);
     free(S->formula);
     free(S->origins);
+    free(S->mappings);
     int i;
     for (i = 1; i <= S->maxVar; ++i) {
         free(S->wlist[i]);
@@ -2120,6 +2389,9 @@ void freeMemory(struct solver *S) {
     free(S->wlist - S->maxVar);
     free(S->RATset);
     free(S->dependencies);
+    free(S->preRAT);
+    free(S->lratTable);
+    free(S->lratLookup);
     return;
 }
 
@@ -2173,35 +2445,76 @@ void printHelp() {
     printf("  INPUT       input file in DIMACS format\n");
     printf(
         "  PROOF       proof file in DRAT format (stdin if no argument)\n\n");
+    printf("CORE and LEMMAS files ending in .gz, .bz2, .lzma, .7z or .xz are "
+           "compressed\n");
     exit(0);
 }
 
-int main(int argc, char **argv) {
+// Marcel: The defaults of all options, shared by main and drat_trim_check_arena
+static void initSolver(struct solver *S) {
+    S->coreStr = NULL;
+    S->activeFile = NULL;
+    S->lemmaStr = NULL;
+    S->lratFile = NULL;
+    S->lratWriter = NULL;
+    S->traceFile = NULL;
+    S->timeout = TIMEOUT;
+    S->nReads = 0;
+    S->nWrites = 0;
+    S->mask = 0;
+    S->verb = 0;
+    S->delProof = 0;
+    S->backforce = 0;
+    S->optimize = 0;
+    S->warning = 0;
+    S->prep = 0;
+    S->bar = 0;
+    S->mode = BACKWARD_UNSAT;
+    S->delete = 1;
+    S->reduce = 1;
+    S->binMode = 0;
+    S->binOutput = 0;
+    S->rupOnly = 0;
+    S->arena = NULL;
+    S->arenaPos = 0;
+    gettimeofday(&S->start_time, NULL);
+}
+
+#ifdef DRAT_TRIM_LIBRARY
+// Marcel: Checks the proof in 'proof' against the 'nClauses' clauses over
+// 'nVars' variables in 'arena', each ending in 0, which is only read, such
+// that it can be shared with other checkers. The proof is binary if 'binary'
+// is set. Returns 1 if the proof is verified, and 0 otherwise.
+int drat_trim_check_arena(int nVars, long nClauses, int const *arena,
+                          FILE *proof, int binary) {
     struct solver S;
+    initSolver(&S);
+    S.nVars = nVars;
+    S.nClauses = nClauses;
+    S.arena = arena;
+    S.inputFile.file = NULL, S.inputFile.pipe = 0;
+    S.proofFile.file = proof, S.proofFile.pipe = 0;
+    S.binMode = binary;
+    S.extra = PACKED;
+    // NOTE: Whatever the checker allocated is left behind on an exit, which
+    //       ends the process soon after anyway
+    if (setjmp(libraryExit)) return 0;
 
-    S.coreStr = NULL;
-    S.activeFile = NULL;
-    S.lemmaStr = NULL;
-    S.lratFile = NULL;
-    S.traceFile = NULL;
-    S.timeout = TIMEOUT;
-    S.nReads = 0;
-    S.nWrites = 0;
-    S.mask = 0;
-    S.verb = 0;
-    S.delProof = 0;
-    S.backforce = 0;
-    S.optimize = 0;
-    S.warning = 0;
-    S.prep = 0;
-    S.bar = 0;
-    S.mode = BACKWARD_UNSAT;
-    S.delete = 1;
-    S.reduce = 1;
-    S.binMode = 0;
-    S.binOutput = 0;
-    S.rupOnly = 0;
-    gettimeofday(&S.start_time, NULL);
+    int parseReturnValue = parse(&S);
+    int sts = ERROR;
+    if (parseReturnValue == ERROR)
+        printf("\rc MEMORY ALLOCATION ERROR\n");
+    else if (parseReturnValue == UNSAT)
+        sts = UNSAT, printf("\rc trivial UNSAT\n");
+    else
+        sts = verify(&S, -1, -1);
+    freeMemory(&S);
+    return sts == UNSAT;
+}
+#else
+int main(int argc, char **argv) {
+    struct solver S;
+    initSolver(&S);
 
     int i, tmp = 0;
     for (i = 1; i < argc; i++) {
@@ -2310,19 +2623,26 @@ int main(int argc, char **argv) {
                     }
                 }
                 close_file(&S.proofFile);
-                if (S.binMode == -1) S.binMode = 0;
                 // Marcel: Reopen file we just read some bytes from
                 S.proofFile = open_to_read_compressed(argv[2]);
             }
         }
     }
 
+    // Marcel: Forcing ASCII mode with -I is only a hint for the detection
+    //         above, parsing then runs in ASCII mode, no matter whether -I
+    //         came before or after the proof file.
+    if (S.binMode == -1) S.binMode = 0;
+
     if (S.proofFile.file == NULL)
         S.proofFile.pipe = 0, S.proofFile.file = fdopen(STDIN_FILENO, "r");
 
     if (tmp == 1) printf("\rc reading proof from stdin\n");
     if (tmp == 0) printHelp();
 
+    // Marcel: Without -O, clause headers do not need a MAXDEP slot
+    S.extra = S.optimize ? EXTRA : PACKED;
+
     int parseReturnValue = parse(&S);
 
     close_file(&S.inputFile);
@@ -2340,8 +2660,10 @@ int main(int argc, char **argv) {
     int sts = ERROR;
     if (parseReturnValue == ERROR)
         printf("\rs MEMORY ALLOCATION ERROR\n");
-    else if (parseReturnValue == UNSAT)
+    else if (parseReturnValue == UNSAT) {
         printf("\rc trivial UNSAT\ns VERIFIED\n");
+        if (S.lratFile) printTrivialLRAT(&S);
+    }
     else if ((sts = verify(&S, -1, -1)) == UNSAT)
         printf("\rs VERIFIED\n");
     else if (sts == DERIVATION)
@@ -2354,6 +2676,10 @@ int main(int argc, char **argv) {
                    (current_time.tv_usec - S.start_time.tv_usec);
     printf("\rc verification time: %.3f seconds\n",
            (double)(runtime / 1000000.0));
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        printf("\rc peak memory usage: %.1f MB\n",
+               (double)(usage.ru_maxrss / 1024.0));
 
     if (S.optimize) {
         printf("c proof optimization started (ignoring the timeout)\n");
@@ -2369,3 +2695,4 @@ int main(int argc, char **argv) {
     freeMemory(&S);
     return (sts != UNSAT);  // 0 on success, 1 on any failure
 }
+#endif
@@ -20,10 +20,22 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <limits.h>
 #include <sys/time.h>
 
+// Marcel: Built with -DLRAT_CHECK_LIBRARY, lrat-check is linked into
+// ferat-check next to drat-trim, see lrat_check_arena. Every exit of the
+// checker then returns from there as a failed check instead, and 'compress'
+// is renamed so as to not interpose the function of zlib.
+#ifdef LRAT_CHECK_LIBRARY
+#include <setjmp.h>
+static jmp_buf libraryExit;
+#define exit(code) longjmp(libraryExit, 1)
+#define compress lratCompress
+#endif
+
 #define PRINT		0
 #define DELETED		-1
 #define CONFLICT	2
@@ -62,6 +74,11 @@ int *litList, litCount, litAlloc;
 int *inBucket;
 int *topTable, topAlloc;
 
+// Marcel: The literals of the formula, each clause ending in 0, if they are
+// already parsed, in which case the formula is not read from a file
+static int const *arena;
+static int arenaClauses;
+
 int  getType   (int* list) { return list[1]; }
 int  getIndex  (int* list) { return list[0]; }
 int  getLength (int* list) { int i = 2; while (list[i]) i++; return i - 2; }
@@ -310,10 +327,66 @@ static void addLit (int lit) {
   }
   litList[litCount++] = lit; }
 
+// Marcel: Numbers in binary LRAT are variable-length encoded, seven bits per
+//         byte, with the sign in the lowest bit. Returns 0 at the end of file,
+//         and for numbers longer than 32 bits, which cannot be shifted in.
+int readBinary (FILE* file, int* number) {
+  unsigned u = 0, shift = 0;
+  int c;
+  do {
+    c = getc (file);
+    if (c == EOF) return 0;
+    if (shift > 28) {
+      printf ("c ERROR: number too large in binary proof\n");
+      return 0; }
+    u |= (unsigned) (c & 127) << shift;
+    shift += 7; } while (c & 128);
+  *number = (u & 1) ? -(int) (u >> 1) : (int) (u >> 1);
+  return 1; }
+
+int parseBinaryLine (FILE* file) {
+  int lit, index;
+  litCount = 0;
+  int c = getc (file);
+  if (c == EOF) return 0;
+  if (c == 'd') {
+    addLit (0);
+    addLit ((int) 'd');
+    while (1) {
+      if (!readBinary (file, &lit)) return 0;
+      addLit (lit);
+      if (lit == 0) return litCount; } }
+  if (c != 'a') {
+    printf ("c ERROR: unexpected character %i in binary proof\n", c);
+    return 0; }
+  if (!readBinary (file, &index)) return 0;
+  addLit (index);
+  addLit ((int) 'a');
+  int zeros = 2;
+  while (zeros) {
+    if (!readBinary (file, &lit)) return 0;
+    addLit (lit);
+    if (lit == 0) zeros--; }
+  return litCount; }
+
+// Marcel: Like parseLine in CNF mode, but reads the next clause of the arena
+int parseArenaLine (int line) {
+  litCount = 0;
+  if (arenaClauses-- <= 0) return 0;
+  line++;
+  while (1) {
+    int lit = *arena++;
+    int clit = convertLit (lit);
+    if (intro[clit] == 0) intro[clit] = line - 1;
+    addLit (lit);
+    if (lit == 0) return litCount; } }
+
 int parseLine (FILE* file, int mode, int line) {
   int lit, tmp;
   litCount = 0;
   char c = 0;
+  if (mode == CLRAT) return parseBinaryLine (file);
+  if (mode == CNF && arena != NULL) return parseArenaLine (line);
   while (1) {
     tmp = fscanf (file, " c%c", &c);
     if (tmp == EOF) return 0;
@@ -368,33 +441,17 @@ int parseLine (FILE* file, int mode, int line) {
   }
   return 0; }
 
-int main (int argc, char** argv) {
-  if (argc < 2)
-     usage(argv[0]);
-  if (argc == 2)
-    printf ("c expecting proof in stdin\n");
-
+// Marcel: Checks the proof in 'proof' against the formula of 'nCls' clauses
+// over 'nVar' variables in 'cnf', or in the arena if it is set, and writes
+// the DRAT proof to 'drat' if it is given. Returns 0 if the proof is
+// verified, and 1 otherwise.
+static int check (int nVar, int nCls, FILE* cnf, FILE* proof, FILE* drat) {
   struct timeval start_time, finish_time;
   int found_error = 0; // encountered an error?
   int found_empty_clause = 0; // encountered derivation of empty clause?
   gettimeofday(&start_time, NULL);
   now = 0, clsLast = 0;
 
-  int nVar = 0, nCls = 0;
-  char ignore[1024];
-  FILE* cnf   = fopen (argv[1], "r");
-  if (!cnf) {
-      printf("Couldn't open file '%s'\n", argv[1]);
-      exit(1); }
-
-  for (;;) {
-    int tmp = fscanf (cnf, " p cnf %i %i ", &nVar, &nCls);
-    if (tmp == 2) break;
-    fgets (ignore, sizeof (ignore), cnf);
-    int j; for (j = 0; j < 1024; j++) { if (ignore[j] == '\n') break; }
-    if (j == 1024) {
-      printf ("c ERROR: comment longer than 1024 characters: %s\n", ignore); exit (0); } }
-
   if (nVar <= 0) nVar = 1;
 
   topAlloc = INIT;
@@ -424,26 +481,18 @@ int main (int argc, char** argv) {
     int size = parseLine (cnf, CNF, index);
     if (size == 0) break;
     addClause (index++, litList, size, NULL); }
-  fclose (cnf);
 
   printf ("c parsed a formula with %i variables and %i clauses\n", nVar, nCls);
 
-  FILE* proof = stdin;
-  if (argc > 2)
-    proof = fopen (argv[2], "r");
-  if (!proof) {
-    printf("c Couldn't open file '%s'\n", argv[2]);
-    exit(1); }
-
-  FILE* drat = NULL;
-  if (argc > 3) {
-    drat = fopen (argv[3], "w");
-    if (!drat) {
-      printf("c Couldn't open file '%s'\n", argv[3]);
-      exit(1); } }
-
   int print = PRINT;
   int mode = LRAT;
+  // Marcel: Lines of ASCII LRAT start with an index or a comment, while
+  //         binary LRAT lines start with 'a' or 'd'
+  int first = getc (proof);
+  if (first == 'a' || first == 'd') {
+    printf ("c turning on binary mode checking\n");
+    mode = CLRAT; }
+  if (first != EOF) ungetc (first, proof);
   int line = 0;
   ltype del = 0;
   while (1) {
@@ -451,7 +500,7 @@ int main (int argc, char** argv) {
       compress (line, print);
       del = deleted_clauses; }
 
-    int size = parseLine (proof, LRAT, 0);
+    int size = parseLine (proof, mode, 0);
     if (size == 0) break;
 
     if (getType (litList) == (int) 'd') {
@@ -502,3 +551,60 @@ int main (int argc, char** argv) {
   printf("c verification time = %.2f secs\n", secs);
   return return_code;
 }
+
+#ifdef LRAT_CHECK_LIBRARY
+// Marcel: Checks the proof in 'proof' against the 'nCls' clauses over 'nVar'
+// variables in 'clauses', each ending in 0, which is only read, such that it
+// can be shared with other checkers. Returns 1 if the proof is verified, and
+// 0 otherwise. The checker keeps its state in globals, so this may only be
+// called once.
+int lrat_check_arena (int nVar, int nCls, int const *clauses, FILE* proof) {
+  arena = clauses, arenaClauses = nCls;
+  // NOTE: Whatever the checker allocated is left behind on an exit, which
+  //       ends the process soon after anyway
+  if (setjmp (libraryExit)) return 0;
+  return check (nVar, nCls, NULL, proof, NULL) == 0;
+}
+#else
+int main (int argc, char** argv) {
+  if (argc < 2)
+     usage(argv[0]);
+  if (argc == 2)
+    printf ("c expecting proof in stdin\n");
+
+  int nVar = 0, nCls = 0;
+  char ignore[1024];
+  FILE* cnf   = fopen (argv[1], "r");
+  if (!cnf) {
+      printf("Couldn't open file '%s'\n", argv[1]);
+      exit(1); }
+
+  for (;;) {
+    int tmp = fscanf (cnf, " p cnf %i %i ", &nVar, &nCls);
+    if (tmp == 2) break;
+    // Marcel: FERAT 'c x' and 'c o' comments easily exceed any fixed buffer
+    //         size, so read comments in chunks until the end of the line.
+    do {
+      if (fgets (ignore, sizeof (ignore), cnf) == NULL) {
+        printf ("c ERROR: missing 'p cnf' header\n"); exit (1); }
+    } while (strchr (ignore, '\n') == NULL); }
+
+  FILE* proof = stdin;
+  if (argc > 2)
+    proof = fopen (argv[2], "r");
+  if (!proof) {
+    printf("c Couldn't open file '%s'\n", argv[2]);
+    exit(1); }
+
+  FILE* drat = NULL;
+  if (argc > 3) {
+    drat = fopen (argv[3], "w");
+    if (!drat) {
+      printf("c Couldn't open file '%s'\n", argv[3]);
+      exit(1); } }
+
+  int return_code = check (nVar, nCls, cnf, proof, drat);
+  fclose (cnf);
+  return return_code;
+}
+#endif
@@ -0,0 +1,64 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "../../src/arraylist.h"
+#include "bench_runner.h"
+
+#define NUM_OPERATIONS (1 << 20)
+// The U and V sets of the checker stay small, about as large as a clause
+#define SET_SIZE       64
+#define LARGE_SET_SIZE (1 << 16)
+
+static Literal lits[NUM_OPERATIONS];
+static ArrayList_Literal_t *large_set;
+
+static uint64_t
+bench_insert_sorted(void) {
+    ArrayList_Literal_t *set = allit_new(ARRAYLIST_DEFAULT_CAP);
+    for (size_t i = 0; i < NUM_OPERATIONS; ++i) {
+        if (i % SET_SIZE == 0) set->size = 0;
+        set = allit_insert_sorted(set, lits[i]);
+    }
+    bench_sink += set->size;
+    allit_free(set);
+    return NUM_OPERATIONS;
+}
+
+/** @brief Searches sets of @p size elements for the random literals.
+ */
+static uint64_t
+search(uint32_t size) {
+    uint32_t const prev_size = large_set->size;
+    large_set->size = size;
+    uint64_t found = 0;
+    for (size_t i = 0; i < NUM_OPERATIONS; ++i)
+        found += allit_binary_search_contains(large_set, lits[i]);
+    large_set->size = prev_size;
+    bench_sink += found;
+    return NUM_OPERATIONS;
+}
+
+static uint64_t
+bench_search_small(void) {
+    return search(SET_SIZE);
+}
+
+static uint64_t
+bench_search_large(void) {
+    return search(LARGE_SET_SIZE);
+}
+
+int
+main(int argc, char **argv) {
+    bench_parse_args(argc, argv);
+    for (size_t i = 0; i < NUM_OPERATIONS; ++i)
+        lits[i] = (Literal)(2 + bench_random() % (2 * LARGE_SET_SIZE));
+    // Every other literal, so that about half of the searches in the large set hit
+    large_set = allit_new(LARGE_SET_SIZE);
+    for (uint32_t i = 0; i < LARGE_SET_SIZE; ++i) large_set = allit_append(large_set, 2 + 2 * i);
+    addbench("allit_insert_sorted", "operation", NULL, bench_insert_sorted, NULL);
+    addbench("allit_binary_search_small", "operation", NULL, bench_search_small, NULL);
+    addbench("allit_binary_search_large", "operation", NULL, bench_search_large, NULL);
+    runbenches("Array List");
+}
@@ -0,0 +1,101 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "../../src/batch.h"
+#include "../../src/check.h"
+#include "../../src/expansion.h"
+#include "../../src/qbf.h"
+#include "bench_runner.h"
+
+#include <sys/stat.h>
+#include <zlib.h>
+
+static char const *qbf_file_name, *expansion_file_name;
+static uint64_t qbf_file_size;
+static gzFile fd;
+static QBF *qbf, *parsed_qbf;
+static Expansion *expansion;
+static FERATCheckResult *result;
+
+static gzFile
+open_input(char const *const file_name) {
+    gzFile const input = gzopen(file_name, "rb");
+    if (input == Z_NULL || gzbuffer(input, FERAT_ZLIB_BUFFER_SIZE) == -1) {
+        fprintf(stderr, "Unable to open input file: %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    return input;
+}
+
+static void
+open_qbf(void) {
+    fd = open_input(qbf_file_name);
+}
+
+static void
+free_qbf(void) {
+    qbf_free(parsed_qbf);
+    gzclose(fd);
+}
+
+static uint64_t
+bench_qbf_parse(void) {
+    parsed_qbf = qbf_new();
+    qbf_parse(fd, parsed_qbf, true);
+    qbf_sort_clauses_in_matrix(parsed_qbf);
+    bench_sink += parsed_qbf->matrix->size;
+    return qbf_file_size;
+}
+
+static void
+open_expansion(void) {
+    fd = open_input(expansion_file_name);
+    expansion = expansion_new();
+    result = ferat_check_result_new();
+}
+
+static void
+free_expansion(void) {
+    if (result->num_results != 0) {
+        fprintf(stderr, "CNF expansion is not valid: %s\n", expansion_file_name);
+        exit(EXIT_FAILURE);
+    }
+    expansion_free(expansion);
+    ferat_check_result_free(result);
+    gzclose(fd);
+}
+
+static uint64_t
+bench_ferat_check(void) {
+    expansion_parse_preamble(fd, expansion, true);
+    bench_sink += ferat_check(result, qbf, expansion);
+    return expansion->num_clauses_yielded;
+}
+
+int
+main(int argc, char **argv) {
+    bench_parse_args(argc, argv);
+    if (bench_argc != 2) {
+        fprintf(stderr, "Expected a QBF and a valid CNF expansion of it\n");
+        return EXIT_FAILURE;
+    }
+    qbf_file_name = bench_argv[0];
+    expansion_file_name = bench_argv[1];
+    struct stat stat_buf;
+    if (stat(qbf_file_name, &stat_buf) != 0) {
+        fprintf(stderr, "Unable to open input file: %s\n", qbf_file_name);
+        return EXIT_FAILURE;
+    }
+    qbf_file_size = (uint64_t)stat_buf.st_size;
+
+    gzFile const qbf_fd = open_input(qbf_file_name);
+    qbf = qbf_new();
+    qbf_parse(qbf_fd, qbf, true);
+    qbf_sort_clauses_in_matrix(qbf);
+    gzclose(qbf_fd);
+
+    addbench("qbf_parse", "byte", open_qbf, bench_qbf_parse, free_qbf);
+    addbench("ferat_check", "clause", open_expansion, bench_ferat_check, free_expansion);
+    runbenches("Checking");
+}
@@ -0,0 +1,73 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "../../src/hashtable.h"
+#include "bench_runner.h"
+
+// Variables of a large CNF expansion, keyed like the variable mappings
+#define NUM_KEYS   (1 << 20)
+// Misses probe all slots, since removals leave no tombstones to stop at
+#define NUM_MISSES (1 << 3)
+
+static uint64_t hits[NUM_KEYS], misses[NUM_MISSES];
+static HashTable *ht, *filled_ht;
+
+static void
+new_table(void) {
+    ht = ht_new(HASHTABLE_DEFAULT_NUM_SLOTS);
+}
+
+static void
+free_table(void) {
+    ht_free(ht);
+}
+
+static uint64_t
+bench_ht_insert(void) {
+    for (uint64_t var = 1; var <= NUM_KEYS; ++var) ht_insert(ht, hash_fnv1a(var), var);
+    bench_sink += ht->num_slots;
+    return NUM_KEYS;
+}
+
+/** @brief Looks up the @p num_keys @p keys.
+ */
+static uint64_t
+get_all(uint64_t const *const keys, size_t num_keys) {
+    uint64_t found = 0;
+    for (size_t i = 0; i < num_keys; ++i) found += ht_get(filled_ht, keys[i]).ok;
+    bench_sink += found;
+    return num_keys;
+}
+
+static uint64_t
+bench_ht_get_hit(void) {
+    return get_all(hits, NUM_KEYS);
+}
+
+static uint64_t
+bench_ht_get_miss(void) {
+    return get_all(misses, NUM_MISSES);
+}
+
+int
+main(int argc, char **argv) {
+    bench_parse_args(argc, argv);
+    filled_ht = ht_new(HASHTABLE_DEFAULT_NUM_SLOTS);
+    for (uint64_t var = 1; var <= NUM_KEYS; ++var) {
+        ht_insert(filled_ht, hash_fnv1a(var), var);
+        hits[var - 1] = hash_fnv1a(var);
+    }
+    for (uint64_t i = 0; i < NUM_MISSES; ++i) misses[i] = hash_fnv1a(NUM_KEYS + 1 + i);
+    // Shuffle, so that lookups do not follow the insertion order
+    for (size_t i = NUM_KEYS - 1; i > 0; --i) {
+        size_t const j = bench_random() % (i + 1);
+        uint64_t const tmp = hits[i];
+        hits[i] = hits[j];
+        hits[j] = tmp;
+    }
+    addbench("ht_insert", "key", new_table, bench_ht_insert, free_table);
+    addbench("ht_get_hit", "key", NULL, bench_ht_get_hit, NULL);
+    addbench("ht_get_miss", "key", NULL, bench_ht_get_miss, NULL);
+    runbenches("Hash Table");
+}
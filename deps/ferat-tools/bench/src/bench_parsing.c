@@ -0,0 +1,101 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "../../src/batch.h"
+#include "../../src/parsing.h"
+#include "bench_runner.h"
+
+#include <zlib.h>
+
+// About as large as the clauses of a mid-sized CNF expansion
+#define INPUT_SIZE (8 << 20)
+
+static char file_name[32];
+static uint64_t file_size;
+static gzFile fd;
+static Parser parser;
+
+/** @brief Writes lines of 2 to 8 random literals and a terminating @c 0, like the
+ * clauses of a CNF expansion.
+ */
+static uint64_t
+write_input(void) {
+    strcpy(file_name, "/tmp/bench_parsing_XXXXXX");
+    FILE *const file = fdopen(mkstemp(file_name), "w");
+    uint64_t size = 0;
+    while (size < INPUT_SIZE) {
+        uint64_t const num_lits = 2 + bench_random() % 7;
+        for (uint64_t i = 0; i < num_lits; ++i) {
+            uint64_t const r = bench_random();
+            size += (uint64_t)fprintf(file, "%s%" PRIu64 " ", (r & 1) ? "-" : "",
+                                      1 + (r >> 1) % (1 << 20));
+        }
+        size += (uint64_t)fprintf(file, "0\n");
+    }
+    fclose(file);
+    return size;
+}
+
+static void
+remove_input(void) {
+    unlink(file_name);
+}
+
+static void
+open_parser(void) {
+    fd = gzopen(file_name, "rb");
+    if (fd == Z_NULL || gzbuffer(fd, FERAT_ZLIB_BUFFER_SIZE) == -1) {
+        fprintf(stderr, "Unable to open input file: %s\n", file_name);
+        exit(EXIT_FAILURE);
+    }
+    parser = (Parser){.state = PARSE_STATE_NONE,
+                      .col = 1,
+                      .line = 1,
+                      .eof = false,
+                      .silent = true,
+                      .la = '\0',
+                      .prev = '\0',
+                      .stream = fd};
+    read_one_char(&parser);
+}
+
+static void
+close_parser(void) {
+    gzclose(fd);
+}
+
+static uint64_t
+bench_read_one_char(void) {
+    uint64_t newlines = 0;
+    while (!parser.eof) {
+        newlines += (parser.la == '\n');
+        read_one_char(&parser);
+    }
+    bench_sink += newlines;
+    return file_size;
+}
+
+static uint64_t
+bench_expect_literal_list(void) {
+    uint64_t num_lits = 0;
+    while (!parser.eof) {
+        ArrayList_Literal_t *const lits = expect_literal_list(&parser);
+        num_lits += lits->size;
+        allit_free(lits);
+        if (!handle_newline(&parser)) break;
+    }
+    bench_sink += num_lits;
+    return file_size;
+}
+
+int
+main(int argc, char **argv) {
+    bench_parse_args(argc, argv);
+    file_size = write_input();
+    atexit(remove_input);
+    addbench("read_one_char", "byte", open_parser, bench_read_one_char, close_parser);
+    addbench("expect_literal_list", "byte", open_parser, bench_expect_literal_list,
+             close_parser);
+    runbenches("Parsing");
+}
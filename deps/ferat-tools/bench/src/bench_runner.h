@@ -0,0 +1,328 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#ifndef FORALL_EXP_RAT_BENCHRUNNER
+#define FORALL_EXP_RAT_BENCHRUNNER
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ~~~~~~~~~~~~~~~~~~~~ BENCHMARK INFRASTRUCTURE ~~~~~~~~~~~~~~~~~~~~
+
+#define MAX_BENCHES 32
+#define MAX_SAMPLES 1024
+
+#define DEFAULT_SAMPLES 21
+#define DEFAULT_WARMUP  3
+
+#define FMT_BENCH_USAGE                                                              \
+    "%s [--samples=<N>] [--warmup=<N>] [--filter=<NAME>] [--output=<JSON>] "        \
+    "[<Input>...]\n"                                                                 \
+    "\n"                                                                             \
+    "Runs each benchmark <N> times after the warm-up runs, and writes the median,\n" \
+    "percentiles, and throughput to <JSON>, or standard output. Only benchmarks\n"   \
+    "whose name contains <NAME> are run.\n"
+#define FMT_BENCH_LISTING "  (%zu) %-28s %10.3f ms [p10 %.3f, p90 %.3f], %8.3f ns/%s"
+
+/** @brief A benchmark, whose @c run function returns the number of units it processed,
+ * for instance bytes or clauses. The @c setup and @c teardown functions are optional,
+ * and are not timed.
+ */
+typedef struct Bench {
+    char const *name, *unit;
+    void (*setup)(void);
+    uint64_t (*run)(void);
+    void (*teardown)(void);
+} Bench;
+
+/** @brief The distribution of the samples of one measure, in its own unit.
+ */
+typedef struct BenchStats {
+    double min, p10, median, p90, max;
+} BenchStats;
+
+static Bench __benches[MAX_BENCHES];
+static size_t __num = 0;
+static unsigned int __samples = DEFAULT_SAMPLES, __warmup = DEFAULT_WARMUP;
+static char const *__filter = NULL, *__output = NULL;
+// Positional arguments left over for the benchmarks themselves
+static int bench_argc = 0;
+static char **bench_argv = NULL;
+// Results are added here so that runs cannot be optimized away
+static volatile uint64_t bench_sink = 0;
+
+#define addbench(name, unit, setup, run, teardown)                         \
+    do {                                                                   \
+        if (__num >= MAX_BENCHES) {                                        \
+            fprintf(stderr, "Exceeded maximum number of benchmarks: %d\n", \
+                    MAX_BENCHES);                                          \
+            exit(EXIT_FAILURE);                                            \
+        }                                                                  \
+        __benches[__num++] = (Bench){name, unit, setup, run, teardown};    \
+    } while (0)
+
+#define runbenches(name)                                          \
+    do {                                                          \
+        return __run_benches(name) ? EXIT_SUCCESS : EXIT_FAILURE; \
+    } while (0)
+
+// ~~~~~~~~~~~~~~~~~~~~ Random Inputs ~~~~~~~~~~~~~~~~~~~~
+
+static uint64_t __random_state = 0x9E3779B97F4A7C15u;
+
+/** @brief Resets the generator of bench_random(), so that inputs are repeatable.
+ */
+static void __attribute__((unused))
+bench_seed(uint64_t seed) {
+    __random_state = (seed == 0) ? 0x9E3779B97F4A7C15u : seed;
+}
+
+/** @brief A xorshift64* generator, which is fast and good enough for inputs.
+ */
+static uint64_t __attribute__((unused))
+bench_random(void) {
+    __random_state ^= __random_state >> 12;
+    __random_state ^= __random_state << 25;
+    __random_state ^= __random_state >> 27;
+    return __random_state * 0x2545F4914F6CDD1Du;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~ Clocks ~~~~~~~~~~~~~~~~~~~~
+
+static int __perf_fd = -1;
+static char const *__cycles_source = "none";
+
+/** @brief Opens a core cycle counter for this process through perf, and falls back to
+ * the time-stamp counter, which counts at a constant reference rate, where perf is not
+ * permitted.
+ */
+static void
+__open_cycle_counter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    __perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (__perf_fd >= 0) {
+        __cycles_source = "perf";
+        return;
+    }
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+    __cycles_source = "tsc";
+#endif
+}
+
+static inline uint64_t
+__read_cycles(void) {
+    if (__perf_fd >= 0) {
+        uint64_t count;
+        if (read(__perf_fd, &count, sizeof(count)) == sizeof(count)) return count;
+        return 0;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static inline uint64_t
+__read_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~ Statistics ~~~~~~~~~~~~~~~~~~~~
+
+static int
+__cmp_double(void const *a, void const *b) {
+    double const x = *(double const *)a, y = *(double const *)b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Linearly interpolates the @p p quantile of the sorted @p values.
+ */
+static double
+__quantile(double const *const values, size_t n, double p) {
+    double const pos = p * (double)(n - 1);
+    size_t const lo = (size_t)pos;
+    if (lo + 1 >= n) return values[n - 1];
+    return values[lo] + (pos - (double)lo) * (values[lo + 1] - values[lo]);
+}
+
+/** @brief Sorts @p values in place, and summarizes them.
+ */
+static BenchStats
+__stats(double *const values, size_t n) {
+    qsort(values, n, sizeof(double), __cmp_double);
+    return (BenchStats){
+        .min = values[0],
+        .p10 = __quantile(values, n, 0.1),
+        .median = __quantile(values, n, 0.5),
+        .p90 = __quantile(values, n, 0.9),
+        .max = values[n - 1],
+    };
+}
+
+static void
+__print_stats(FILE *out, char const *key, BenchStats const *const stats) {
+    fprintf(out,
+            "\"%s\": {\"min\": %.1f, \"p10\": %.1f, \"median\": %.1f, \"p90\": %.1f, "
+            "\"max\": %.1f}",
+            key, stats->min, stats->p10, stats->median, stats->p90, stats->max);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~ Running ~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Parses the benchmark options, and leaves all other arguments in bench_argc and
+ * bench_argv. Exits on invalid options.
+ */
+static void __attribute__((unused))
+bench_parse_args(int argc, char **argv) {
+    bench_argv = malloc(sizeof(char *) * (size_t)(argc + 1));
+    for (int i = 1; i < argc; ++i) {
+        char *end = NULL;
+        if (strncmp(argv[i], "--samples=", 10) == 0) {
+            __samples = (unsigned int)strtoul(argv[i] + 10, &end, 10);
+        } else if (strncmp(argv[i], "--warmup=", 9) == 0) {
+            __warmup = (unsigned int)strtoul(argv[i] + 9, &end, 10);
+        } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+            __filter = argv[i] + 9;
+        } else if (strncmp(argv[i], "--output=", 9) == 0) {
+            __output = argv[i] + 9;
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printf(FMT_BENCH_USAGE, argv[0]);
+            exit(EXIT_SUCCESS);
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Unknown option '%s'\n" FMT_BENCH_USAGE, argv[i], argv[0]);
+            exit(EXIT_FAILURE);
+        } else {
+            bench_argv[bench_argc++] = argv[i];
+        }
+        if (end != NULL && (*end != '\0' || __samples == 0 || __samples > MAX_SAMPLES)) {
+            fprintf(stderr, "Invalid option '%s', expecting 1 to %d sample[s]\n",
+                    argv[i], MAX_SAMPLES);
+            exit(EXIT_FAILURE);
+        }
+    }
+    bench_argv[bench_argc] = NULL;
+}
+
+/** @brief Runs one sample of @p bench, and returns the number of units it processed.
+ */
+static uint64_t
+__run_sample(Bench const *const bench, double *const ns, double *const cycles) {
+    if (bench->setup != NULL) bench->setup();
+    uint64_t const start_cycles = __read_cycles(), start_ns = __read_ns();
+    uint64_t const units = bench->run();
+    uint64_t const end_ns = __read_ns(), end_cycles = __read_cycles();
+    if (bench->teardown != NULL) bench->teardown();
+    *ns = (double)(end_ns - start_ns);
+    *cycles = (double)(end_cycles - start_cycles);
+    return units;
+}
+
+/** @brief Runs all benchmarks matching the filter, and writes their results as one JSON
+ * object of the suite @p name.
+ * @returns @c true if all benchmarks processed a non-zero, constant number of units
+ */
+static bool
+__run_benches(char const *const name) {
+    FILE *out = stdout;
+    if (__output != NULL && (out = fopen(__output, "w")) == NULL) {
+        fprintf(stderr, "Unable to open output file: %s\n", __output);
+        return false;
+    }
+    __open_cycle_counter();
+    bool const has_cycles = (strcmp(__cycles_source, "none") != 0);
+    double *const ns = malloc(sizeof(double) * __samples),
+                  *const cycles = malloc(sizeof(double) * __samples);
+
+    fprintf(stderr, "Running '%s' with %u sample[s] and %u warm-up run[s]:\n", name,
+            __samples, __warmup);
+    fprintf(out,
+            "{\"suite\": \"%s\", \"samples\": %u, \"warmup\": %u, "
+            "\"cycles_source\": \"%s\", \"benchmarks\": [",
+            name, __samples, __warmup, __cycles_source);
+    bool ok = true, first = true;
+    for (size_t i = 0; i < __num; ++i) {
+        Bench const *const bench = &__benches[i];
+        if (__filter != NULL && strstr(bench->name, __filter) == NULL) continue;
+        double ignored_ns, ignored_cycles;
+        for (unsigned int j = 0; j < __warmup; ++j)
+            __run_sample(bench, &ignored_ns, &ignored_cycles);
+        uint64_t units = 0;
+        for (unsigned int j = 0; j < __samples; ++j) {
+            uint64_t const sample_units = __run_sample(bench, &ns[j], &cycles[j]);
+            if (j > 0 && sample_units != units) {
+                fprintf(stderr, "  (%zu) %s: varying units %" PRIu64 " and %" PRIu64 "\n",
+                        i, bench->name, units, sample_units);
+                ok = false;
+            }
+            units = sample_units;
+        }
+        if (units == 0) {
+            fprintf(stderr, "  (%zu) %s: processed no %s[s]\n", i, bench->name,
+                    bench->unit);
+            ok = false;
+            continue;
+        }
+        BenchStats const ns_stats = __stats(ns, __samples),
+                         cycles_stats = __stats(cycles, __samples);
+        double const ns_per_unit = ns_stats.median / (double)units;
+
+        fprintf(out, "%s\n  {\"name\": \"%s\", \"unit\": \"%s\", \"units\": %" PRIu64 ", ",
+                first ? "" : ",", bench->name, bench->unit, units);
+        __print_stats(out, "ns", &ns_stats);
+        fprintf(out, ", \"ns_per_unit\": %.4f, \"units_per_s\": %.1f", ns_per_unit,
+                1e9 / ns_per_unit);
+        if (has_cycles) {
+            fprintf(out, ", ");
+            __print_stats(out, "cycles", &cycles_stats);
+            fprintf(out, ", \"cycles_per_unit\": %.4f}",
+                    cycles_stats.median / (double)units);
+        } else {
+            fprintf(out, ", \"cycles\": null, \"cycles_per_unit\": null}");
+        }
+        first = false;
+
+        fprintf(stderr, FMT_BENCH_LISTING, i, bench->name, ns_stats.median / 1e6,
+                ns_stats.p10 / 1e6, ns_stats.p90 / 1e6, ns_per_unit, bench->unit);
+        if (has_cycles)
+            fprintf(stderr, ", %.3f cycles/%s", cycles_stats.median / (double)units,
+                    bench->unit);
+        fprintf(stderr, "\n");
+    }
+    fprintf(out, "\n]}\n");
+
+    free(ns);
+    free(cycles);
+    free(bench_argv);
+    if (__perf_fd >= 0) close(__perf_fd);
+    if (out != stdout) fclose(out);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "../../src/sorting.h"
+#include "bench_runner.h"
+
+#define NUM_VALUES  (1 << 20)
+// The typical width of a clause in a CNF expansion
+#define CLAUSE_SIZE 8
+// Sorted input is the worst case of the last-element pivot, and takes quadratic time
+#define SORTED_SIZE (1 << 13)
+
+static uint32_t random_values[NUM_VALUES], sorted_values[NUM_VALUES], values[NUM_VALUES];
+static ArrayList_uint32_t *stack;
+
+static void
+copy_random(void) {
+    memcpy(values, random_values, sizeof(values));
+}
+
+static void
+copy_sorted(void) {
+    memcpy(values, sorted_values, sizeof(values));
+}
+
+static uint64_t
+check_sorted(size_t size, size_t chunk) {
+    for (size_t i = 0; i < size; ++i) {
+        if (i % chunk != 0 && values[i - 1] > values[i]) {
+            fprintf(stderr, "Values are not sorted at index %zu\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    bench_sink += values[0];
+    return size;
+}
+
+static uint64_t
+bench_sort_clauses(void) {
+    for (size_t i = 0; i < NUM_VALUES; i += CLAUSE_SIZE)
+        iterative_inplace_quickort(&stack, &sort_identity_partial, values + i,
+                                   CLAUSE_SIZE);
+    return check_sorted(NUM_VALUES, CLAUSE_SIZE);
+}
+
+static uint64_t
+bench_sort_large(void) {
+    iterative_inplace_quickort(&stack, &sort_identity_partial, values, NUM_VALUES);
+    return check_sorted(NUM_VALUES, NUM_VALUES);
+}
+
+static uint64_t
+bench_sort_sorted(void) {
+    iterative_inplace_quickort(&stack, &sort_identity_partial, values, SORTED_SIZE);
+    return check_sorted(SORTED_SIZE, SORTED_SIZE);
+}
+
+int
+main(int argc, char **argv) {
+    bench_parse_args(argc, argv);
+    stack = al32_new(ARRAYLIST_DEFAULT_CAP);
+    for (size_t i = 0; i < NUM_VALUES; ++i) {
+        // Literals of variables up to 2^20, like in check.c
+        random_values[i] = (uint32_t)(2 + bench_random() % (2u << 20));
+        sorted_values[i] = (uint32_t)(2 + i);
+    }
+    addbench("quicksort_clauses", "literal", copy_random, bench_sort_clauses, NULL);
+    addbench("quicksort_large", "literal", copy_random, bench_sort_large, NULL);
+    addbench("quicksort_sorted", "literal", copy_sorted, bench_sort_sorted, NULL);
+    runbenches("Sorting");
+}
@@ -0,0 +1,314 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+// Needed for accept4
+#define _GNU_SOURCE
+
+#include "batch.h"
+
+#include "check.h"
+#include "expansion.h"
+#include "snapshot.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Checking ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static gzFile
+open_input(char const *const file_name, char const *const what) {
+    gzFile fd = gzopen(file_name, "rb");
+    if (fd == Z_NULL) {
+        ERR_COMMENT("Unable to open %s file: %s\n", what, file_name);
+        return Z_NULL;
+    }
+    if (gzbuffer(fd, FERAT_ZLIB_BUFFER_SIZE) == -1) {
+        ERR_COMMENT("Unable to expand zlib buffer\n");
+        gzclose(fd);
+        return Z_NULL;
+    }
+    return fd;
+}
+
+QBF *
+ferat_load_qbf(char const *const qbf_file_name, bool use_snapshot,
+               char const *const snapshot_dir, bool silent) {
+    INIT_TIME();
+
+    // QBF snapshot loading
+    QBFSource source;
+    char snapshot_file_name[PATH_MAX];
+    use_snapshot = use_snapshot && qbf_snapshot_source(qbf_file_name, &source)
+                && qbf_snapshot_file_name(qbf_file_name, snapshot_dir, &source,
+                                          snapshot_file_name, sizeof(snapshot_file_name));
+    if (use_snapshot) {
+        START_TIME(snapshot_loading_time);
+        QBF *const qbf = qbf_snapshot_load(snapshot_file_name, &source);
+        END_TIME(snapshot_loading_time);
+        if (qbf != NULL) {
+            COMMENT("Loaded QBF snapshot %s with max variable %u and %u clause[s]\n",
+                    snapshot_file_name, qbf->max_var, qbf->matrix->size);
+            COMMENT("QBF snapshot loading took " USEC_TO_HUM_RDBL_FMT "\n",
+                    USEC_TO_HUM_RDBL_FMT_ARGS(snapshot_loading_time));
+            FLUSH();
+            return qbf;
+        }
+    }
+
+    gzFile qbf_fd = open_input(qbf_file_name, "QBF input");
+    if (qbf_fd == Z_NULL) return NULL;
+
+    // QBF parsing
+    START_TIME(qbf_parsing_time);
+    INFO("Start parsing QBF\n");
+    QBF *const qbf = qbf_new();
+    qbf_parse(qbf_fd, qbf, silent);
+    COMMENT("Parsed QBF with max variable %u and %u clause[s]\n", qbf->max_var,
+            qbf->matrix->size);
+    END_TIME(qbf_parsing_time);
+    gzclose(qbf_fd);
+    FLUSH();
+
+    // QBF clause sorting
+    START_TIME(qbf_sorting_time);
+    INFO("Start sorting QBF clauses by quantifier index\n");
+    qbf_sort_clauses_in_matrix(qbf);
+    COMMENT("Sorted QBF clauses by quantifier index\n");
+    END_TIME(qbf_sorting_time);
+#if VERBOSE
+    qbf_print(qbf);
+#endif
+
+    COMMENT("QBF parsing took " USEC_TO_HUM_RDBL_FMT "\n",
+            USEC_TO_HUM_RDBL_FMT_ARGS(qbf_parsing_time));
+    COMMENT("QBF sorting took " USEC_TO_HUM_RDBL_FMT "\n",
+            USEC_TO_HUM_RDBL_FMT_ARGS(qbf_sorting_time));
+    FLUSH();
+
+    // QBF snapshot writing, which is only worth a warning if it fails
+    if (use_snapshot) {
+        if (snapshot_dir != NULL) mkdir(snapshot_dir, 0755);
+        if (qbf_snapshot_write(qbf, snapshot_file_name, &source))
+            COMMENT("Wrote QBF snapshot %s\n", snapshot_file_name);
+        else
+            WARN_COMMENT("Unable to write QBF snapshot %s\n", snapshot_file_name);
+        FLUSH();
+    }
+    return qbf;
+}
+
+int
+ferat_check_expansion(QBF *const qbf, char const *const expansion_file_name,
+                      bool silent) {
+    assert(qbf != NULL);
+    gzFile expansion_fd = open_input(expansion_file_name, "CNF expansion");
+    if (expansion_fd == Z_NULL) return EXIT_FAILURE;
+    int const exit_code = ferat_check_expansion_stream(qbf, expansion_fd, NULL, silent);
+    gzclose(expansion_fd);
+    RESULT("%s\n", (exit_code == EXIT_VERIFIED) ? "VERIFIED" : "NOT VERIFIED");
+    FLUSH();
+    return exit_code;
+}
+
+int
+ferat_check_expansion_stream(QBF *const qbf, gzFile expansion_fd,
+                             ClauseArena const *const clauses, bool silent) {
+    assert(qbf != NULL);
+    INIT_TIME();
+
+    // CNF expansion parsing
+    START_TIME(expansion_parsing_time);
+    INFO("Start parsing CNF expansion\n");
+    Expansion *const expansion = expansion_new();
+    expansion->clause_arena = clauses;
+    expansion_parse_preamble(expansion_fd, expansion, silent);
+    COMMENT("Parsed CNF expansion with max variable %u, reporting %u clause[s]\n",
+            expansion->p_max_var, expansion->p_num_clauses);
+    END_TIME(expansion_parsing_time);
+#if VERBOSE
+    expansion_print(expansion);
+#endif
+    FLUSH();
+
+    // Checking
+    START_TIME(checking_time);
+    INFO("Start checking expansion step\n");
+    FERATCheckResult *const result = ferat_check_result_new();
+    bool valid = ferat_check(result, qbf, expansion);
+    END_TIME(checking_time);
+#if VERBOSE
+    expansion_print(expansion);
+#endif
+    FLUSH();
+
+    // Result output
+    int exit_code;
+    COMMENT("\n");
+    if (valid) {
+        COMMENT("Expansion is sound\n");
+        exit_code = EXIT_VERIFIED;
+    } else {
+        COMMENT("Expansion is unsound\n");
+        ferat_check_result_print(result);
+        exit_code = EXIT_NOT_VERIFIED;
+    }
+    COMMENT("\n");
+    COMMENT("CNF expansion parsing took " USEC_TO_HUM_RDBL_FMT "\n",
+            USEC_TO_HUM_RDBL_FMT_ARGS(expansion_parsing_time));
+    COMMENT("Expansion verification took " USEC_TO_HUM_RDBL_FMT "\n",
+            USEC_TO_HUM_RDBL_FMT_ARGS(checking_time));
+    FLUSH();
+
+    // Cleanup
+    expansion_free(expansion);
+    ferat_check_result_free(result);
+
+    return exit_code;
+}
+
+int
+ferat_check_isolated(QBF *const qbf, char const *const expansion_file_name, int out_fd) {
+    // Anything still buffered would otherwise be written by both processes
+    FLUSH();
+    pid_t const pid = fork();
+    if (pid == -1) {
+        ERR_COMMENT("Unable to fork checker for %s\n", expansion_file_name);
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+        if (out_fd >= 0 && (dup2(out_fd, STDOUT_FILENO) == -1
+                            || dup2(out_fd, STDERR_FILENO) == -1))
+            _exit(EXIT_FAILURE);
+        int const exit_code = ferat_check_expansion(qbf, expansion_file_name, false);
+        FLUSH();
+        // The QBF is shared with the parent, and freeing it would only cost time
+        _exit(exit_code);
+    }
+
+    int wstatus;
+    while (waitpid(pid, &wstatus, 0) == -1) {
+        if (errno != EINTR) {
+            ERR_COMMENT("Unable to wait for checker of %s\n", expansion_file_name);
+            return EXIT_FAILURE;
+        }
+    }
+    if (WIFSIGNALED(wstatus)) return 128 + WTERMSIG(wstatus);
+    return WEXITSTATUS(wstatus);
+}
+
+int
+ferat_check_many(QBF *const qbf, char const *const *const expansion_file_names,
+                 size_t num_expansions) {
+    size_t num_verified = 0;
+    for (size_t i = 0; i < num_expansions; ++i) {
+        int const exit_code = ferat_check_isolated(qbf, expansion_file_names[i], -1);
+        printf(FERAT_BATCH_RESULT_PREFIX "%d %s\n", exit_code, expansion_file_names[i]);
+        FLUSH();
+        if (exit_code == EXIT_VERIFIED) ++num_verified;
+    }
+    COMMENT("Verified %zu of %zu CNF expansion[s]\n", num_verified, num_expansions);
+    return (num_verified == num_expansions) ? EXIT_VERIFIED : EXIT_NOT_VERIFIED;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Server ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Answers the requests of one client on @p conn_fd until it disconnects, or asks
+ * for a shutdown, and closes @p conn_fd.
+ *
+ * @returns true if the client asked for a shutdown
+ */
+static bool
+serve_client(QBF *const qbf, int conn_fd) {
+    int const requests_fd = dup(conn_fd);
+    FILE *const requests = (requests_fd == -1) ? NULL : fdopen(requests_fd, "r");
+    if (requests == NULL) {
+        ERR_COMMENT("Unable to read requests from client\n");
+        if (requests_fd != -1) close(requests_fd);
+        close(conn_fd);
+        return false;
+    }
+
+    bool shutdown = false;
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    while ((length = getline(&line, &capacity, requests)) != -1) {
+        while (length > 0 && isspace((unsigned char)line[length - 1])) line[--length] = 0;
+        if (length == 0) continue;
+        if (!strcmp(line, FERAT_BATCH_SHUTDOWN)) {
+            shutdown = true;
+            break;
+        }
+        int const exit_code = ferat_check_isolated(qbf, line, conn_fd);
+        COMMENT("Checked %s with exit code %d\n", line, exit_code);
+        FLUSH();
+        if (dprintf(conn_fd, FERAT_BATCH_RESULT_PREFIX "%d %s\n", exit_code, line) < 0)
+            break;
+    }
+    free(line);
+    fclose(requests);
+    close(conn_fd);
+    return shutdown;
+}
+
+int
+ferat_serve(QBF *const qbf, char const *const socket_path) {
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        ERR_COMMENT("Socket path is too long: %s\n", socket_path);
+        return EXIT_FAILURE;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    int const listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        ERR_COMMENT("Unable to create socket: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) == -1
+        || listen(listen_fd, SOMAXCONN) == -1) {
+        ERR_COMMENT("Unable to listen on socket %s: %s\n", socket_path, strerror(errno));
+        close(listen_fd);
+        return EXIT_FAILURE;
+    }
+    // Clients which disconnect early must not take the server down with them
+    signal(SIGPIPE, SIG_IGN);
+    COMMENT("Serving checks on %s\n", socket_path);
+    FLUSH();
+
+    int exit_code = EXIT_SUCCESS;
+    bool shutdown = false;
+    while (!shutdown) {
+        int const conn_fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (conn_fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            ERR_COMMENT("Unable to accept client: %s\n", strerror(errno));
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+        shutdown = serve_client(qbf, conn_fd);
+    }
+    close(listen_fd);
+    unlink(socket_path);
+    COMMENT("Stopped serving checks on %s\n", socket_path);
+    FLUSH();
+    return exit_code;
+}
@@ -0,0 +1,102 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include "expansion.h"
+#include "qbf.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <zlib.h>
+
+#ifndef FORALL_EXP_RAT_BATCH_INCLUDED
+#define FORALL_EXP_RAT_BATCH_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Size of the zlib buffers of the QBF and CNF expansion inputs.
+ */
+#define FERAT_ZLIB_BUFFER_SIZE (1 << 16)
+
+/** @brief Prefix of the line reporting the exit code of one check, which is followed by
+ * the exit code, and the name of the expansion file.
+ */
+#define FERAT_BATCH_RESULT_PREFIX DIMACS_COMMENT_PREFIX "result "
+
+/** @brief The request which stops a server started by ferat_serve.
+ */
+#define FERAT_BATCH_SHUTDOWN "shutdown"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Parses the QBF in @p qbf_file_name, and sorts its clauses by quantifier index,
+ * so that any number of expansions can be checked against it. If @p use_snapshot is set,
+ * the QBF is loaded from its snapshot instead, if there is an up-to-date one, and a
+ * snapshot is written after parsing otherwise, see qbf_snapshot_file_name for where
+ * snapshots are kept with respect to @p snapshot_dir.
+ *
+ * @returns the QBF, or NULL if the file could not be opened
+ */
+QBF *
+ferat_load_qbf(char const *const qbf_file_name, bool use_snapshot,
+               char const *const snapshot_dir, bool silent);
+
+/** @brief Checks the CNF expansion in @p expansion_file_name against @p qbf, which was
+ * loaded with ferat_load_qbf, and prints the result. Parsing errors exit the process.
+ *
+ * @returns EXIT_VERIFIED, EXIT_NOT_VERIFIED, or EXIT_FAILURE if the file could not be
+ * opened
+ */
+int
+ferat_check_expansion(QBF *const qbf, char const *const expansion_file_name, bool silent);
+
+/** @brief Checks the CNF expansion in @p expansion_fd against @p qbf, like
+ * ferat_check_expansion, but leaves the final result line to the caller. If @p clauses is
+ * not NULL, only the preamble of the expansion is read from @p expansion_fd, and its
+ * clauses are taken from the arena.
+ *
+ * @returns EXIT_VERIFIED or EXIT_NOT_VERIFIED
+ */
+int
+ferat_check_expansion_stream(QBF *const qbf, gzFile expansion_fd,
+                             ClauseArena const *const clauses, bool silent);
+
+/** @brief Runs ferat_check_expansion in a child process, which shares the parsed @p qbf
+ * with this process, so that neither parsing errors, nor anything the check changes in
+ * @p qbf affect later checks. The output of the child goes to @p out_fd, or to the
+ * standard output and error if it is negative.
+ *
+ * @returns the exit code of the check, or 128 plus the number of the signal which killed
+ * it
+ */
+int
+ferat_check_isolated(QBF *const qbf, char const *const expansion_file_name, int out_fd);
+
+/** @brief Checks each of the @p num_expansions CNF expansions in @p expansion_file_names
+ * against @p qbf with ferat_check_isolated, and reports the exit code of each after its
+ * output, see FERAT_BATCH_RESULT_PREFIX.
+ *
+ * @returns EXIT_VERIFIED if all expansions were verified, and EXIT_NOT_VERIFIED otherwise
+ */
+int
+ferat_check_many(QBF *const qbf, char const *const *const expansion_file_names,
+                 size_t num_expansions);
+
+/** @brief Serves checks of CNF expansions against @p qbf on the Unix socket
+ * @p socket_path, one client at a time. Clients send the names of expansion files, one
+ * per line, and receive the output of ferat_check_isolated for each, followed by its
+ * exit code, see FERAT_BATCH_RESULT_PREFIX. The server removes the socket and returns
+ * once a client sends FERAT_BATCH_SHUTDOWN.
+ *
+ * @returns EXIT_SUCCESS after a shutdown, or EXIT_FAILURE if the socket failed
+ */
+int
+ferat_serve(QBF *const qbf, char const *const socket_path);
+
+#endif
@@ -0,0 +1,440 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+// Needed for pipe2
+#define _GNU_SOURCE
+
+#include "compress.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Private Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Size of the buffer in front of the pipe to a compressor.
+ */
+#define PIPE_BUFFER_SIZE (1 << 20)
+
+/** @brief Exit code of a child process which could not execute its compressor.
+ */
+#define EXIT_EXEC_FAILURE (127)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The states of a block of a gzip writer, which is filled by the writer while
+ * free, compressed by a thread while pending or busy, and written out once done.
+ */
+typedef enum BlockState {
+    BLOCK_FREE,
+    BLOCK_PENDING,
+    BLOCK_BUSY,
+    BLOCK_DONE,
+} BlockState;
+
+typedef struct Block {
+    BlockState state;
+    bool ok;
+    Bytef *in, *out;
+    size_t in_size, out_size, out_capacity;
+} Block;
+
+/** @brief A compressing writer. Gzip is compressed by @c num_threads threads, which
+ * take turns on a ring of @c num_blocks blocks. Since the blocks are filled and written
+ * out in the same order, the gzip members end up in the order of the input. Zstd and
+ * xz are piped into a compressor process.
+ */
+struct FERATWriter {
+    FERATCompression compression;
+    FILE *file;
+    bool ok;
+    size_t num_written;
+    // Gzip
+    pthread_mutex_t mutex;
+    pthread_cond_t pending, done;
+    pthread_t *threads;
+    Block *blocks;
+    unsigned int num_threads, num_blocks, current;
+    bool closing;
+    // Zstd and xz
+    pid_t compressor;
+};
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Child Processes ~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Runs @p argv with its standard input and output redirected to @p in_fd and
+ * @p out_fd. All other descriptors of ours are opened with O_CLOEXEC, so the child does
+ * not keep its own pipe open.
+ *
+ * @returns the process ID of the child, or -1 if it could not be forked
+ */
+static pid_t
+spawn(char const *const argv[], int in_fd, int out_fd) {
+    pid_t const pid = fork();
+    if (pid != 0) return pid;
+    if (dup2(in_fd, STDIN_FILENO) < 0 || dup2(out_fd, STDOUT_FILENO) < 0)
+        _exit(EXIT_EXEC_FAILURE);
+    execvp(argv[0], (char *const *)argv);
+    _exit(EXIT_EXEC_FAILURE);
+}
+
+/** @brief Waits for the child @p pid, and reports whether it exited successfully. A
+ * child killed by SIGPIPE counts as successful if @p allow_sigpipe is set, since then we
+ * simply stopped reading its output early.
+ */
+static bool
+wait_child(pid_t pid, char const *const name, bool allow_sigpipe) {
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+        if (errno != EINTR) return false;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) return true;
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGPIPE && allow_sigpipe) return true;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_EXEC_FAILURE)
+        ERR_COMMENT("Unable to run %s\n", name);
+    else ERR_COMMENT("Failure in %s\n", name);
+    return false;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Gzip Compression ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Compresses the input of @p block into a complete gzip member.
+ */
+static bool
+deflate_block(Block *const block) {
+    z_stream stream = { 0 };
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY)
+        != Z_OK)
+        return false;
+    size_t const bound = deflateBound(&stream, block->in_size);
+    if (block->out_capacity < bound) {
+        Bytef *const out = realloc(block->out, bound);
+        if (out == NULL) {
+            deflateEnd(&stream);
+            return false;
+        }
+        block->out = out;
+        block->out_capacity = bound;
+    }
+    stream.next_in = block->in;
+    stream.avail_in = block->in_size;
+    stream.next_out = block->out;
+    stream.avail_out = block->out_capacity;
+    bool const ok = (deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    block->out_size = stream.total_out;
+    deflateEnd(&stream);
+    return ok;
+}
+
+/** @brief Returns the pending block which has waited the longest, or NULL if there is
+ * none. The caller must hold the mutex.
+ */
+static Block *
+next_pending(FERATWriter *const writer) {
+    for (unsigned int i = 1; i <= writer->num_blocks; ++i) {
+        Block *const block = writer->blocks + (writer->current + i) % writer->num_blocks;
+        if (block->state == BLOCK_PENDING) return block;
+    }
+    return NULL;
+}
+
+static void *
+gzip_worker(void *const arg) {
+    FERATWriter *const writer = arg;
+    pthread_mutex_lock(&writer->mutex);
+    while (true) {
+        Block *block;
+        while ((block = next_pending(writer)) == NULL && !writer->closing)
+            pthread_cond_wait(&writer->pending, &writer->mutex);
+        if (block == NULL) break;
+        block->state = BLOCK_BUSY;
+        pthread_mutex_unlock(&writer->mutex);
+        bool const ok = deflate_block(block);
+        pthread_mutex_lock(&writer->mutex);
+        block->ok = ok;
+        block->state = BLOCK_DONE;
+        pthread_cond_broadcast(&writer->done);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+    return NULL;
+}
+
+/** @brief Waits for the block at @p index to be compressed, if it was submitted, writes
+ * it out, and frees it for the writer.
+ */
+static void
+reclaim_block(FERATWriter *const writer, unsigned int index) {
+    Block *const block = writer->blocks + index;
+    pthread_mutex_lock(&writer->mutex);
+    while (block->state == BLOCK_PENDING || block->state == BLOCK_BUSY)
+        pthread_cond_wait(&writer->done, &writer->mutex);
+    pthread_mutex_unlock(&writer->mutex);
+    // Workers do not touch done blocks, so they are written out without the lock
+    if (block->state == BLOCK_DONE)
+        writer->ok = writer->ok && block->ok
+                     && (fwrite(block->out, 1, block->out_size, writer->file)
+                         == block->out_size);
+    block->state = BLOCK_FREE;
+    block->in_size = 0;
+}
+
+/** @brief Hands the current block to the threads, and moves on to the next one.
+ */
+static void
+submit_block(FERATWriter *const writer) {
+    pthread_mutex_lock(&writer->mutex);
+    writer->blocks[writer->current].state = BLOCK_PENDING;
+    writer->current = (writer->current + 1) % writer->num_blocks;
+    pthread_cond_signal(&writer->pending);
+    pthread_mutex_unlock(&writer->mutex);
+    reclaim_block(writer, writer->current);
+}
+
+static bool
+gzip_writer_start(FERATWriter *const writer, unsigned int num_threads) {
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->pending, NULL);
+    pthread_cond_init(&writer->done, NULL);
+    writer->num_blocks = 2 * num_threads;
+    writer->threads = calloc(num_threads, sizeof(pthread_t));
+    writer->blocks = calloc(writer->num_blocks, sizeof(Block));
+    if (writer->threads == NULL || writer->blocks == NULL) return false;
+    for (unsigned int i = 0; i < writer->num_blocks; ++i) {
+        writer->blocks[i].in = malloc(FERAT_GZIP_BLOCK_SIZE);
+        if (writer->blocks[i].in == NULL) return false;
+    }
+    // Whichever threads did start are joined on close
+    for (; writer->num_threads < num_threads; ++writer->num_threads)
+        if (pthread_create(writer->threads + writer->num_threads, NULL, gzip_worker,
+                           writer)
+            != 0)
+            return false;
+    return true;
+}
+
+static bool
+gzip_writer_write(FERATWriter *const writer, Bytef const *data, size_t size) {
+    while (size > 0) {
+        Block *const block = writer->blocks + writer->current;
+        size_t const free_size = FERAT_GZIP_BLOCK_SIZE - block->in_size;
+        size_t const chunk_size = (size < free_size) ? size : free_size;
+        memcpy(block->in + block->in_size, data, chunk_size);
+        block->in_size += chunk_size;
+        data += chunk_size;
+        size -= chunk_size;
+        if (block->in_size == FERAT_GZIP_BLOCK_SIZE) submit_block(writer);
+    }
+    return writer->ok;
+}
+
+static void
+gzip_writer_stop(FERATWriter *const writer) {
+    // Nothing is flushed after errors, including failing to start
+    if (writer->ok) {
+        // An empty file is not valid gzip, so even empty output gets one member
+        if (writer->blocks[writer->current].in_size > 0 || writer->num_written == 0)
+            submit_block(writer);
+        for (unsigned int i = 1; i < writer->num_blocks; ++i)
+            reclaim_block(writer, (writer->current + i) % writer->num_blocks);
+    }
+    if (writer->threads != NULL) {
+        pthread_mutex_lock(&writer->mutex);
+        writer->closing = true;
+        pthread_cond_broadcast(&writer->pending);
+        pthread_mutex_unlock(&writer->mutex);
+        for (unsigned int i = 0; i < writer->num_threads; ++i)
+            pthread_join(writer->threads[i], NULL);
+        free(writer->threads);
+    }
+    if (writer->blocks != NULL) {
+        for (unsigned int i = 0; i < writer->num_blocks; ++i) {
+            free(writer->blocks[i].in);
+            free(writer->blocks[i].out);
+        }
+        free(writer->blocks);
+    }
+}
+
+static bool
+has_suffix(char const *const file_name, char const *const suffix) {
+    size_t const length = strlen(file_name), suffix_length = strlen(suffix);
+    return length >= suffix_length && !strcmp(file_name + length - suffix_length, suffix);
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Function Definitions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+bool
+ferat_compression_from_name(char const *const name, FERATCompression *const compression) {
+    if (!strcmp(name, "none")) *compression = FERAT_COMPRESSION_NONE;
+    else if (!strcmp(name, "gz")) *compression = FERAT_COMPRESSION_GZIP;
+    else if (!strcmp(name, "zstd")) *compression = FERAT_COMPRESSION_ZSTD;
+    else if (!strcmp(name, "xz")) *compression = FERAT_COMPRESSION_XZ;
+    else return false;
+    return true;
+}
+
+FERATCompression
+ferat_compression_from_suffix(char const *const file_name) {
+    if (has_suffix(file_name, ".gz")) return FERAT_COMPRESSION_GZIP;
+    if (has_suffix(file_name, ".zst")) return FERAT_COMPRESSION_ZSTD;
+    if (has_suffix(file_name, ".xz")) return FERAT_COMPRESSION_XZ;
+    return FERAT_COMPRESSION_NONE;
+}
+
+FERATWriter *
+ferat_writer_open(char const *const file_name, FERATCompression compression,
+                  unsigned int num_threads) {
+    assert(file_name != NULL && compression != FERAT_COMPRESSION_NONE);
+    if (num_threads == 0) {
+        long const num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (num_cpus > 0) ? (unsigned int)num_cpus : 1;
+    }
+    FERATWriter *const writer = calloc(1, sizeof(FERATWriter));
+    if (writer == NULL) return NULL;
+    writer->compression = compression;
+    writer->ok = true;
+    writer->compressor = -1;
+
+    int const out_fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out_fd < 0) {
+        ERR_COMMENT("Unable to open output file: %s\n", file_name);
+        free(writer);
+        return NULL;
+    }
+
+    if (compression == FERAT_COMPRESSION_GZIP) {
+        writer->file = fdopen(out_fd, "wb");
+        if (writer->file == NULL) close(out_fd);
+        if (writer->file == NULL || !gzip_writer_start(writer, num_threads)) {
+            ERR_COMMENT("Unable to start gzip compression\n");
+            writer->ok = false;
+            ferat_writer_close(writer);
+            return NULL;
+        }
+        setvbuf(writer->file, NULL, _IOFBF, FERAT_GZIP_BLOCK_SIZE);
+        return writer;
+    }
+
+    // A failing compressor must not take us down with it when we write to its pipe
+    signal(SIGPIPE, SIG_IGN);
+    char threads_flag[16];
+    snprintf(threads_flag, sizeof(threads_flag), "-T%u", num_threads);
+    char const *const zstd_argv[] = { "zstd", "-q", threads_flag, "-c", NULL };
+    char const *const xz_argv[] = { "xz", "-q", threads_flag, "-c", NULL };
+    char const *const *const argv
+        = (compression == FERAT_COMPRESSION_ZSTD) ? zstd_argv : xz_argv;
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        ERR_COMMENT("Unable to create pipe to '%s'\n", argv[0]);
+        close(out_fd);
+        free(writer);
+        return NULL;
+    }
+    writer->compressor = spawn(argv, pipe_fds[0], out_fd);
+    close(pipe_fds[0]);
+    close(out_fd);
+    writer->file = fdopen(pipe_fds[1], "wb");
+    if (writer->compressor < 0 || writer->file == NULL) {
+        ERR_COMMENT("Unable to start '%s'\n", argv[0]);
+        if (writer->file == NULL) close(pipe_fds[1]);
+        ferat_writer_close(writer);
+        return NULL;
+    }
+    setvbuf(writer->file, NULL, _IOFBF, PIPE_BUFFER_SIZE);
+    return writer;
+}
+
+bool
+ferat_writer_write(FERATWriter *const writer, void const *const data, size_t size) {
+    writer->num_written += size;
+    if (writer->compression == FERAT_COMPRESSION_GZIP)
+        return gzip_writer_write(writer, data, size);
+    writer->ok = writer->ok && (fwrite(data, 1, size, writer->file) == size);
+    return writer->ok;
+}
+
+bool
+ferat_writer_close(FERATWriter *const writer) {
+    if (writer->compression == FERAT_COMPRESSION_GZIP && writer->num_blocks > 0)
+        gzip_writer_stop(writer);
+    if (writer->file != NULL) writer->ok = (fclose(writer->file) == 0) && writer->ok;
+    if (writer->compressor > 0) {
+        char const *const name
+            = (writer->compression == FERAT_COMPRESSION_ZSTD) ? "zstd" : "xz";
+        writer->ok = wait_child(writer->compressor, name, false) && writer->ok;
+    }
+    bool const ok = writer->ok;
+    free(writer);
+    return ok;
+}
+
+gzFile
+ferat_reader_open(char const *const file_name, pid_t *const decompressor) {
+    *decompressor = -1;
+    static u_char const zstd_magic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+    static u_char const xz_magic[] = { 0xFD, '7', 'z', 'X', 'Z', 0x00 };
+    u_char magic[sizeof(xz_magic)] = { 0 };
+    FILE *const file = fopen(file_name, "rb");
+    if (file == NULL) return Z_NULL;
+    size_t const magic_size = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+
+    char const *name = NULL;
+    if (magic_size >= sizeof(zstd_magic)
+        && !memcmp(magic, zstd_magic, sizeof(zstd_magic)))
+        name = "zstd";
+    else if (magic_size == sizeof(xz_magic) && !memcmp(magic, xz_magic, magic_size))
+        name = "xz";
+    // Gzipped and plain files are read by zlib itself
+    if (name == NULL) return gzopen(file_name, "rb");
+
+    // Otherwise, zlib reads the output of the decompressor as is
+    int const in_fd = open(file_name, O_RDONLY | O_CLOEXEC);
+    int pipe_fds[2];
+    if (in_fd < 0) return Z_NULL;
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        close(in_fd);
+        return Z_NULL;
+    }
+    char const *const argv[] = { name, "-d", "-q", "-c", NULL };
+    *decompressor = spawn(argv, in_fd, pipe_fds[1]);
+    close(in_fd);
+    close(pipe_fds[1]);
+    if (*decompressor < 0) {
+        close(pipe_fds[0]);
+        return Z_NULL;
+    }
+    gzFile const fd = gzdopen(pipe_fds[0], "rb");
+    if (fd == Z_NULL) {
+        close(pipe_fds[0]);
+        wait_child(*decompressor, name, true);
+        *decompressor = -1;
+    }
+    return fd;
+}
+
+bool
+ferat_reader_close(gzFile fd, pid_t decompressor) {
+    bool ok = (gzclose(fd) == Z_OK);
+    if (decompressor > 0) ok = wait_child(decompressor, "decompressor", true) && ok;
+    return ok;
+}
@@ -0,0 +1,102 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <zlib.h>
+
+#ifndef FORALL_EXP_RAT_COMPRESS_INCLUDED
+#define FORALL_EXP_RAT_COMPRESS_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Size of the blocks which are compressed independently, each into its own gzip
+ * member, by the threads of a gzip writer.
+ */
+#define FERAT_GZIP_BLOCK_SIZE (1 << 20)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The compression formats of FERAT proofs. Gzip is compressed in-process, and
+ * zstd and xz by their multi-threaded command line tools.
+ */
+typedef enum FERATCompression {
+    FERAT_COMPRESSION_NONE,
+    FERAT_COMPRESSION_GZIP,
+    FERAT_COMPRESSION_ZSTD,
+    FERAT_COMPRESSION_XZ,
+} FERATCompression;
+
+/** @brief A compressing writer, see ferat_writer_open.
+ */
+typedef struct FERATWriter FERATWriter;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Returns the compression format named @p name, which is one of 'none', 'gz',
+ * 'zstd', and 'xz'.
+ *
+ * @returns false if @p name is not a compression format
+ */
+bool
+ferat_compression_from_name(char const *const name, FERATCompression *const compression);
+
+/** @brief Returns the compression format of the file @p file_name by its suffix, which is
+ * one of '.gz', '.zst', and '.xz', or FERAT_COMPRESSION_NONE for any other file.
+ */
+FERATCompression
+ferat_compression_from_suffix(char const *const file_name);
+
+/** @brief Opens @p file_name for writing with @p compression, which must not be
+ * FERAT_COMPRESSION_NONE, on @p num_threads threads, or one per CPU if it is 0. Gzip is
+ * written as one gzip member per FERAT_GZIP_BLOCK_SIZE bytes, which any gzip reader
+ * reads back as a single stream.
+ *
+ * @returns the writer, or NULL if the file or compressor could not be opened
+ */
+FERATWriter *
+ferat_writer_open(char const *const file_name, FERATCompression compression,
+                  unsigned int num_threads);
+
+/** @brief Writes @p size bytes of @p data to @p writer.
+ *
+ * @returns false if writing failed
+ */
+bool
+ferat_writer_write(FERATWriter *const writer, void const *const data, size_t size);
+
+/** @brief Flushes, closes, and frees @p writer, and waits for its compressor to finish.
+ *
+ * @returns false if writing or compressing failed at any point
+ */
+bool
+ferat_writer_close(FERATWriter *const writer);
+
+/** @brief Opens the (compressed) file @p file_name for reading through zlib. Gzipped
+ * and plain files are read in-process, and zstd and xz files, recognized by their magic
+ * numbers, are decompressed by a child process, whose ID is stored in @p decompressor,
+ * or -1 if there is none.
+ *
+ * @returns the opened file, or Z_NULL if it could not be opened
+ */
+gzFile
+ferat_reader_open(char const *const file_name, pid_t *const decompressor);
+
+/** @brief Closes @p fd, and waits for its @p decompressor, if any.
+ *
+ * @returns false if the decompressor failed
+ */
+bool
+ferat_reader_close(gzFile fd, pid_t decompressor);
+
+#endif
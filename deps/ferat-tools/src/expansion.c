@@ -31,6 +31,8 @@ expansion_new(void) {
     expansion->exp_var_mapping_keys
         = alvar_new(ARRAYLIST_EXP_VAR_MAPPING_KEYS_DEFAULT_CAP);
     expansion->exp_var_mappings = ht_new(HASHTABLE_EXP_VAR_MAPPING_KEYS_DEFAULT_CAP);
+    expansion->clause_arena = NULL;
+    expansion->clause_arena_pos = 0;
     return expansion;
 }
 
@@ -274,7 +276,7 @@ expansion_parse_preamble(gzFile stream, Expansion *const expansion, bool silent)
 }
 
 /** @brief Yields an ExpClause struct every time the function is called, or @c NULL, if
- * the stream is used up.
+ * the stream is used up. With a ClauseArena, the clauses are copied out of it instead.
  *
  * @param eparser ExpParser struct from the expansion_parse_preamble() function
  * @returns a single new ExpClause pointer, which must be freed manually, or @c NULL, if
@@ -283,6 +285,22 @@ expansion_parse_preamble(gzFile stream, Expansion *const expansion, bool silent)
 ExpClause *
 expansion_yield_clause(Expansion *const expansion) {
     assert(expansion != NULL);
+    ClauseArena const *const arena = expansion->clause_arena;
+    if (arena != NULL) {
+        if (expansion->clause_arena_pos >= arena->size) return NULL;
+        int32_t const *const lits = arena->lits + expansion->clause_arena_pos;
+        uint32_t num_literals = 0;
+        while (lits[num_literals] != 0) ++num_literals;
+        ExpClause *exp_clause
+            = malloc(sizeof(ExpClause) + sizeof(Literal) * num_literals);
+        assert(exp_clause != NULL);
+        exp_clause->num_literals = num_literals;
+        for (uint32_t i = 0; i < num_literals; ++i)
+            exp_clause->lits[i] = SIGNED_LIT2LIT(lits[i]);
+        expansion->clause_arena_pos += num_literals + 1;
+        expansion->num_clauses_yielded += 1;
+        return exp_clause;
+    }
     Parser *const parser = &expansion->parser;
     assert(parser->state == PARSE_STATE_CLAUSE);
     do
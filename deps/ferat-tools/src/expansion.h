@@ -40,6 +40,17 @@ typedef struct ExpClause {
     Literal lits[0];
 } ExpClause;
 
+/** @brief The literals of the clauses of a CNF expansion in one contiguous array, as
+ * signed DIMACS literals, with each clause ending in @c 0. A FERAT proof is parsed into
+ * it once, and the checkers of the expansion and the RAT proof only read it, so that they
+ * can share it across threads.
+ */
+typedef struct ClauseArena {
+    int32_t *lits;
+    size_t size, capacity;
+    uint64_t num_clauses;
+} ClauseArena;
+
 /** @brief A CNF expansion formula.
  *
  * An expansion struct describes the CNF expansion of some original QBF formula. It
@@ -47,7 +58,8 @@ typedef struct ExpClause {
  * as keys for the HashTable holding a pointer to each ExpVarMapping, and a BitArray for
  * keeping track of checked clauses.
  *
- * To get more clauses, pass this struct to the expansion_yield_clause() function
+ * To get more clauses, pass this struct to the expansion_yield_clause() function, which
+ * reads them from the stream, or from a ClauseArena that was parsed already.
  */
 typedef struct Expansion {
     Parser parser;                      ///< @brief The Parser state
@@ -61,6 +73,9 @@ typedef struct Expansion {
     ArrayList_Variable_t *exp_var_mapping_keys; ///< @brief ArrayList of (Exp) ::Variable
     HashTable *exp_var_mappings; ///< @brief HashTable of (Exp) ::Variable (key),
                                  ///< and ExpVarMapping * (value)
+    ClauseArena const *clause_arena; ///< @brief If not @c NULL, the clauses are taken
+                                     ///< from this arena instead of the parser
+    size_t clause_arena_pos;         ///< @brief The start of the next clause in the arena
 } Expansion;
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
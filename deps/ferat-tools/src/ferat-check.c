@@ -0,0 +1,204 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "batch.h"
+#include "compress.h"
+#include "ferat-tools.h"
+#include "proof.h"
+#include "qbf.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ RAT Checking Cores ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Checks the DRAT proof @p proof against the @p num_clauses clauses over
+ * @p num_vars variables in @p arena, which is only read. This is the checking core of
+ * drat-trim, which is compiled into ferat-check with @c -DDRAT_TRIM_LIBRARY.
+ *
+ * @returns 1 if the proof is verified, and 0 otherwise
+ */
+int
+drat_trim_check_arena(int num_vars, long num_clauses, int const *arena, FILE *proof,
+                      int binary);
+
+/** @brief Checks the hinted LRAT proof @p proof like drat_trim_check_arena, with the
+ * checking core of lrat-check, which is compiled into ferat-check with
+ * @c -DLRAT_CHECK_LIBRARY.
+ *
+ * @returns 1 if the proof is verified, and 0 otherwise
+ */
+int
+lrat_check_arena(int num_vars, int num_clauses, int const *arena, FILE *proof);
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Expansion Checking ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The inputs of the thread checking the expansion of a FERAT proof.
+ */
+typedef struct ExpansionCheck {
+    char const *qbf_file_name, *snapshot_dir;
+    bool use_snapshot;
+    FERATProof const *proof;
+} ExpansionCheck;
+
+/** @brief Held by the thread which ends the process, such that only one of both threads
+ * reports a verdict, and calls exit.
+ */
+static pthread_mutex_t exit_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Ends the process with @p exit_code, unless the other thread already does so,
+ * in which case this blocks until the process ends.
+ */
+static void __attribute__((noreturn))
+stop(int exit_code) {
+    pthread_mutex_lock(&exit_mutex);
+    exit(exit_code);
+}
+
+/** @brief Reports the verdict of both checks, and ends the process. Whichever check
+ * fails first calls this, such that the other one does not run to its end.
+ */
+static void __attribute__((noreturn))
+finish(bool valid, char const *const failure) {
+    pthread_mutex_lock(&exit_mutex);
+    if (failure != NULL) COMMENT("FERAT proof is invalid (%s)\n", failure);
+    RESULT("%s\n", valid ? "VERIFIED" : "NOT VERIFIED");
+    FLUSH();
+    exit(valid ? EXIT_VERIFIED : EXIT_NOT_VERIFIED);
+}
+
+/** @brief Checks the expansion of the FERAT proof of an ExpansionCheck, and ends the
+ * process if it is unsound.
+ */
+static void *
+check_expansion(void *const arg) {
+    ExpansionCheck const *const check = arg;
+    QBF *const qbf = ferat_load_qbf(check->qbf_file_name, check->use_snapshot,
+                                    check->snapshot_dir, false);
+    if (qbf == NULL) stop(EXIT_FAILURE);
+    gzFile preamble_fd = gzdopen(dup(fileno(check->proof->preamble)), "rb");
+    if (preamble_fd == Z_NULL) {
+        ERR_COMMENT("Unable to read expansion preamble\n");
+        stop(EXIT_FAILURE);
+    }
+    int const exit_code = ferat_check_expansion_stream(qbf, preamble_fd,
+                                                       &check->proof->clauses, false);
+    gzclose(preamble_fd);
+    qbf_free(qbf);
+    if (exit_code != EXIT_VERIFIED) finish(false, "expansion is unsound");
+    return NULL;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Main Entry Point ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Reads the FERAT proof in @p ferat_file_name once, see ferat_proof_read, and
+ * checks its expansion against the QBF in @p check on another thread, while the RAT proof
+ * is checked on this one.
+ */
+static int
+check_ferat(char const *const ferat_file_name, ExpansionCheck *const check) {
+    INIT_TIME();
+    START_TIME(reading_time);
+    pid_t decompressor;
+    gzFile ferat_fd = ferat_reader_open(ferat_file_name, &decompressor);
+    if (ferat_fd == Z_NULL) {
+        ERR_COMMENT("Unable to open FERAT input file: %s\n", ferat_file_name);
+        return EXIT_FAILURE;
+    }
+    if (gzbuffer(ferat_fd, FERAT_ZLIB_BUFFER_SIZE) == -1) {
+        ERR_COMMENT("Unable to expand zlib buffer\n");
+        return EXIT_FAILURE;
+    }
+    // Only a plain proof can be read at the offsets of its index
+    bool const plain = decompressor == -1 && gzdirect(ferat_fd);
+    FERATProof proof;
+    bool ok = ferat_proof_read(plain ? ferat_file_name : NULL, ferat_fd, &proof);
+    ok = ferat_reader_close(ferat_fd, decompressor) && ok;
+    if (!ok) {
+        ferat_proof_free(&proof);
+        return EXIT_FAILURE;
+    }
+    END_TIME(reading_time);
+    COMMENT("Read FERAT proof with max variable %u and %" PRIu64 " clause[s] in "
+            USEC_TO_HUM_RDBL_FMT "\n",
+            proof.max_var, proof.clauses.num_clauses,
+            USEC_TO_HUM_RDBL_FMT_ARGS(reading_time));
+    if (proof.hints) COMMENT("Proof carries LRAT hints\n");
+    if (proof.binary) COMMENT("Proof is binary\n");
+    FLUSH();
+
+    check->proof = &proof;
+    pthread_t expansion_thread;
+    if (pthread_create(&expansion_thread, NULL, &check_expansion, check) != 0) {
+        ERR_COMMENT("Unable to start expansion checker\n");
+        ferat_proof_free(&proof);
+        return EXIT_FAILURE;
+    }
+    // Both cores read binary proofs on their own, lrat-check by their first byte
+    bool const rat_valid
+        = proof.hints
+              ? lrat_check_arena((int)proof.max_var, (int)proof.clauses.num_clauses,
+                                 proof.clauses.lits, proof.rat)
+              : drat_trim_check_arena((int)proof.max_var,
+                                      (long)proof.clauses.num_clauses,
+                                      proof.clauses.lits, proof.rat, proof.binary);
+    if (!rat_valid) finish(false, "RAT proof is invalid");
+    COMMENT("RAT proof is valid\n");
+    FLUSH();
+    pthread_join(expansion_thread, NULL);
+    ferat_proof_free(&proof);
+    finish(true, NULL);
+}
+
+/** @brief Checks a FERAT proof without splitting it first. The expansion clauses are
+ * parsed once into a ClauseArena, which the expansion checker of FERAT-tools and the
+ * checking core of drat-trim read at the same time.
+ */
+int
+main(int argc, char const **argv) {
+    assert(argc >= 1);
+    char const *const program_name = argv[0];
+    ExpansionCheck check = { 0 };
+    int i = 1;
+    for (; i < argc && !strncmp(argv[i], "-", 1); ++i) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            printf(FERAT_CHECK_USAGE_FMT "\n", program_name);
+            return EXIT_SUCCESS;
+        } else if (!strcmp(argv[i], "-v") || !strcmp(argv[i], "--version")) {
+            printf("FERAT by Simader, Seidl, and Rebola-Pardo\n");
+            printf("Version %s\n", FERAT_VERSION);
+            return EXIT_SUCCESS;
+        } else if (!strcmp(argv[i], "--snapshot")) {
+            check.use_snapshot = true;
+        } else if (!strncmp(argv[i], "--snapshot-dir=", 15) && argv[i][15] != '\0') {
+            check.use_snapshot = true;
+            check.snapshot_dir = argv[i] + 15;
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            printf(FERAT_CHECK_USAGE_FMT "\n", program_name);
+            return EXIT_CLI_FAILURE;
+        }
+    }
+    if (argc - i != 2) {
+        printf("Expected 2 file arguments, received %d\n", argc - i);
+        printf(FERAT_CHECK_USAGE_FMT "\n", program_name);
+        return EXIT_CLI_FAILURE;
+    }
+    check.qbf_file_name = argv[i];
+    return check_ferat(argv[i + 1], &check);
+}
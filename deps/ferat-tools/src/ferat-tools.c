@@ -5,23 +5,21 @@
 #include "common.h"
 
 #include "arraylist.h"
-#include "check.h"
-#include "expansion.h"
+#include "batch.h"
+#include "compress.h"
 #include "ferat-tools.h"
+#include "merge.h"
 #include "qbf.h"
-#include "sorting.h"
+#include "split.h"
 
+#include <ctype.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <zlib.h>
 
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* ~~~~~~~~~~~~~~~~~~~~ Private Macros ~~~~~~~~~~~~~~~~~~~~ */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#define FERAT_ZLIB_BUFFER_SIZE (1 << 16)
-
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 /* ~~~~~~~~~~~~~~~~~~~~ Main Entry Point ~~~~~~~~~~~~~~~~~~~~ */
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -39,131 +37,186 @@ cli_version(void) {
     exit(EXIT_SUCCESS);
 }
 
-/** @mainpage
- * FERAT-tools is a utility developed by Martina Seidl and Marcel Simader at the Institute
- * for Symbolic Artificial Intelligence at Johannes Kepler University. It can check the
- * expansion of an expansion-based QBF solver. We use it to combine an expansion trace in
- * CNF with a RAT proof to create a FERAT proof.
+/** @brief Splits a FERAT proof into its CNF expansion and RAT proof, see ferat_split.
+ * The flags of the proof are reported as 'c hints <0|1>' and 'c binary <0|1>', and the
+ * RAT section of indexed proofs as 'c rat <offset> <size>'. The RAT proof is not written
+ * if @p rat_file_name is NULL.
  */
 int
-main(int argc, char const **argv) {
-    assert(argc >= 1);
-    char const *const program_name = argv[0];
-
-    for (uint8_t i = 1; i < argc; ++i) {
-        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
-            cli_help(program_name, EXIT_SUCCESS);
-        else if (!strcmp(argv[i], "-v") || !strcmp(argv[1], "--version"))
-            cli_version();
+cli_split(char const *const ferat_file_name, char const *const cnf_file_name,
+          char const *const rat_file_name) {
+    pid_t decompressor;
+    gzFile ferat_fd = ferat_reader_open(ferat_file_name, &decompressor);
+    if (ferat_fd == Z_NULL) {
+        ERR_COMMENT("Unable to open FERAT input file: %s\n", ferat_file_name);
+        return EXIT_FAILURE;
     }
-
-    // Neither -v nor -h, so we have to get exactly 2 arguments
-    if (argc != 3) {
-        printf("Expected 2 arguments, received %u\n", argc - 1);
-        cli_help(program_name, EXIT_FAILURE);
+    if (gzbuffer(ferat_fd, FERAT_ZLIB_BUFFER_SIZE) == -1) {
+        ERR_COMMENT("Unable to expand zlib buffer\n");
+        return EXIT_FAILURE;
     }
 
-    char const *qbf_file_name = argv[1], *expansion_file_name = argv[2];
-
-    gzFile qbf_fd = gzopen(qbf_file_name, "rb");
-    if (gzbuffer(qbf_fd, FERAT_ZLIB_BUFFER_SIZE) == -1) {
-        ERR_COMMENT("Unable to expand zlib buffer\n");
+    FILE *const cnf_fd = fopen(cnf_file_name, "wb");
+    if (cnf_fd == NULL) {
+        ERR_COMMENT("Unable to open CNF expansion output file: %s\n", cnf_file_name);
         return EXIT_FAILURE;
     }
-    if (qbf_fd == Z_NULL) {
-        ERR_COMMENT("Unable to open QBF input file: %s\n", qbf_file_name);
+    FILE *const rat_fd = (rat_file_name == NULL) ? NULL : fopen(rat_file_name, "wb");
+    if (rat_file_name != NULL && rat_fd == NULL) {
+        ERR_COMMENT("Unable to open RAT output file: %s\n", rat_file_name);
         return EXIT_FAILURE;
     }
+    setvbuf(cnf_fd, NULL, _IOFBF, FERAT_SPLIT_CHUNK_SIZE);
+    if (rat_fd != NULL) setvbuf(rat_fd, NULL, _IOFBF, FERAT_SPLIT_CHUNK_SIZE);
+
+    FERATSplitResult result;
+    bool ok = ferat_split(ferat_fd, cnf_fd, rat_fd, &result);
+    ok = (fclose(cnf_fd) == 0) && ok;
+    if (rat_fd != NULL) ok = (fclose(rat_fd) == 0) && ok;
+    ok = ferat_reader_close(ferat_fd, decompressor) && ok;
+    if (!ok) return EXIT_FAILURE;
+
+    COMMENT("Split FERAT proof with max variable %u and %" PRIu64 " clause[s]\n",
+            result.max_var, result.num_clauses);
+    COMMENT("hints %d\n", result.hints);
+    COMMENT("binary %d\n", result.binary);
+    if (result.indexed)
+        COMMENT("rat %" PRIu64 " %" PRIu64 "\n", result.index.rat.offset,
+                result.index.rat.size);
+    FLUSH();
+    return EXIT_SUCCESS;
+}
 
-    gzFile expansion_fd = gzopen(expansion_file_name, "rb");
-    if (gzbuffer(expansion_fd, FERAT_ZLIB_BUFFER_SIZE) == -1) {
-        ERR_COMMENT("Unable to expand zlib buffer\n");
-        return EXIT_FAILURE;
+/** @brief Merges a CNF expansion and a RAT proof into a FERAT proof, see ferat_merge.
+ * The arguments are any of '--hints', '--binary', '--index', '--compress=<FORMAT>', and
+ * '--threads=<N>', followed by the three file names. Without '--compress', the FERAT
+ * proof is compressed according to the suffix of its name.
+ */
+int
+cli_merge(int argc, char const **argv) {
+    FERATMergeOptions options = { 0 };
+    bool has_compression = false;
+    int i = 0;
+    for (; i < argc && !strncmp(argv[i], "--", 2); ++i) {
+        if (!strcmp(argv[i], "--hints")) options.hints = true;
+        else if (!strcmp(argv[i], "--binary")) options.binary = true;
+        else if (!strcmp(argv[i], "--index")) options.index = true;
+        else if (!strncmp(argv[i], "--compress=", 11)
+                 && ferat_compression_from_name(argv[i] + 11, &options.compression))
+            has_compression = true;
+        else if (!strncmp(argv[i], "--threads=", 10) && isdigit((u_char)argv[i][10]))
+            options.num_threads = strtoul(argv[i] + 10, NULL, 10);
+        else {
+            printf("Unknown option to 'merge': %s\n", argv[i]);
+            return EXIT_CLI_FAILURE;
+        }
     }
-    if (expansion_fd == Z_NULL) {
-        ERR_COMMENT("Unable to open CNF expansion file: %s\n", expansion_file_name);
-        return EXIT_FAILURE;
+    if (argc - i != 3) {
+        printf("Expected 3 file arguments to 'merge', received %d\n", argc - i);
+        return EXIT_CLI_FAILURE;
+    }
+    char const *const ferat_file_name = argv[i + 2];
+    if (!has_compression)
+        options.compression = ferat_compression_from_suffix(ferat_file_name);
+    return ferat_merge(argv[i], argv[i + 1], ferat_file_name, &options) ? EXIT_SUCCESS
+                                                                       : EXIT_FAILURE;
+}
+
+/** @brief Checks CNF expansions against a QBF, see ferat_check_expansion for the
+ * default mode @p mode NULL, ferat_check_many for 'check-many', and ferat_serve for
+ * 'serve'. The arguments are any of '--snapshot' and '--snapshot-dir=<DIR>', see
+ * ferat_load_qbf, followed by the file names of the mode.
+ */
+int
+cli_check(char const *const mode, int argc, char const **argv) {
+    bool use_snapshot = false;
+    char const *snapshot_dir = NULL;
+    int i = 0;
+    for (; i < argc && !strncmp(argv[i], "--", 2); ++i) {
+        if (!strcmp(argv[i], "--snapshot")) {
+            use_snapshot = true;
+        } else if (!strncmp(argv[i], "--snapshot-dir=", 15) && argv[i][15] != '\0') {
+            use_snapshot = true;
+            snapshot_dir = argv[i] + 15;
+        } else {
+            printf("Unknown option: %s\n", argv[i]);
+            return EXIT_CLI_FAILURE;
+        }
+    }
+    argc -= i;
+    argv += i;
+    if (mode == NULL && argc != 2) {
+        printf("Expected 2 file arguments, received %d\n", argc);
+        return EXIT_CLI_FAILURE;
+    }
+    if (mode != NULL && !strcmp(mode, "serve") && argc != 2) {
+        printf("Expected 2 file arguments to 'serve', received %d\n", argc);
+        return EXIT_CLI_FAILURE;
+    }
+    if (mode != NULL && !strcmp(mode, "check-many") && argc < 2) {
+        printf("Expected at least 2 file arguments to 'check-many', received %d\n",
+               argc);
+        return EXIT_CLI_FAILURE;
     }
 
     /* TODO(Marcel): Make more CLI flags */
     bool const silent = false;
 
     INIT_TIME();
-
-    // QBF parsing
-    START_TIME(qbf_parsing_time);
-    INFO("Start parsing QBF\n");
-    QBF *const qbf = qbf_new();
-    qbf_parse(qbf_fd, qbf, silent);
-    COMMENT("Parsed QBF with max variable %u and %u clause[s]\n", qbf->max_var,
-            qbf->matrix->size);
-    END_TIME(qbf_parsing_time);
-    FLUSH();
-
-    // QBF clause sorting
-    START_TIME(qbf_sorting_time);
-    INFO("Start sorting QBF clauses by quantifier index\n");
-    qbf_sort_clauses_in_matrix(qbf);
-    COMMENT("Sorted QBF clauses by quantifier index\n");
-    END_TIME(qbf_sorting_time);
-#if VERBOSE
-    qbf_print(qbf);
-#endif
+    START_TIME(total_time);
+    QBF *const qbf = ferat_load_qbf(argv[0], use_snapshot, snapshot_dir, silent);
+    if (qbf == NULL) return EXIT_FAILURE;
+    int exit_code;
+    if (mode == NULL) exit_code = ferat_check_expansion(qbf, argv[1], silent);
+    else if (!strcmp(mode, "serve")) exit_code = ferat_serve(qbf, argv[1]);
+    else exit_code = ferat_check_many(qbf, argv + 1, argc - 1);
+    END_TIME(total_time);
+    COMMENT("Total time " USEC_TO_HUM_RDBL_FMT "\n", USEC_TO_HUM_RDBL_FMT_ARGS(total_time));
     FLUSH();
 
-    // CNF expansion parsing
-    START_TIME(expansion_parsing_time);
-    INFO("Start parsing CNF expansion\n");
-    Expansion *const expansion = expansion_new();
-    expansion_parse_preamble(expansion_fd, expansion, silent);
-    COMMENT("Parsed CNF expansion with max variable %u, reporting %u clause[s]\n",
-            expansion->p_max_var, expansion->p_num_clauses);
-    END_TIME(expansion_parsing_time);
-#if VERBOSE
-    expansion_print(expansion);
-#endif
-    FLUSH();
+    qbf_free(qbf);
+    return exit_code;
+}
 
-    // Checking
-    START_TIME(checking_time);
-    INFO("Start checking expansion step\n");
-    FERATCheckResult *const result = ferat_check_result_new();
-    bool valid = ferat_check(result, qbf, expansion);
-    END_TIME(checking_time);
-#if VERBOSE
-    expansion_print(expansion);
-#endif
-    FLUSH();
+/** @mainpage
+ * FERAT-tools is a utility developed by Martina Seidl and Marcel Simader at the Institute
+ * for Symbolic Artificial Intelligence at Johannes Kepler University. It can check the
+ * expansion of an expansion-based QBF solver. We use it to combine an expansion trace in
+ * CNF with a RAT proof to create a FERAT proof, and to split a FERAT proof back into
+ * these two parts.
+ */
+int
+main(int argc, char const **argv) {
+    assert(argc >= 1);
+    char const *const program_name = argv[0];
 
-    // Result output
-    uint8_t exit_code;
-    COMMENT("\n");
-    if (valid) {
-        RESULT("VERIFIED\n");
-        exit_code = EXIT_VERIFIED;
-    } else {
-        RESULT("NOT VERIFIED\n");
-        ferat_check_result_print(result);
-        exit_code = EXIT_NOT_VERIFIED;
+    for (uint8_t i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
+            cli_help(program_name, EXIT_SUCCESS);
+        else if (!strcmp(argv[i], "-v") || !strcmp(argv[1], "--version"))
+            cli_version();
     }
-    COMMENT("\n");
-    COMMENT("QBF parsing took " USEC_TO_HUM_RDBL_FMT "\n",
-            USEC_TO_HUM_RDBL_FMT_ARGS(qbf_parsing_time));
-    COMMENT("QBF sorting took " USEC_TO_HUM_RDBL_FMT "\n",
-            USEC_TO_HUM_RDBL_FMT_ARGS(qbf_sorting_time));
-    COMMENT("CNF expansion parsing took " USEC_TO_HUM_RDBL_FMT "\n",
-            USEC_TO_HUM_RDBL_FMT_ARGS(expansion_parsing_time));
-    COMMENT("Expansion verification took " USEC_TO_HUM_RDBL_FMT "\n",
-            USEC_TO_HUM_RDBL_FMT_ARGS(checking_time));
-    COMMENT("Total time " USEC_TO_HUM_RDBL_FMT "\n",
-            USEC_TO_HUM_RDBL_FMT_ARGS(qbf_parsing_time + qbf_sorting_time
-                                      + expansion_parsing_time + checking_time));
-    FLUSH();
 
-    // Cleanup
-    expansion_free(expansion);
-    qbf_free(qbf);
-    ferat_check_result_free(result);
+    if (argc >= 2 && !strcmp(argv[1], "split")) {
+        if (argc != 4 && argc != 5) {
+            printf("Expected 2 or 3 arguments to 'split', received %u\n", argc - 2);
+            cli_help(program_name, EXIT_CLI_FAILURE);
+        }
+        return cli_split(argv[2], argv[3], (argc == 5) ? argv[4] : NULL);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "merge")) {
+        int const exit_code = cli_merge(argc - 2, argv + 2);
+        if (exit_code == EXIT_CLI_FAILURE) cli_help(program_name, EXIT_CLI_FAILURE);
+        return exit_code;
+    }
 
+    // The checking modes share their options
+    char const *const mode
+        = (argc >= 2 && (!strcmp(argv[1], "check-many") || !strcmp(argv[1], "serve")))
+            ? argv[1]
+            : NULL;
+    int const num_skipped = (mode == NULL) ? 1 : 2;
+    int const exit_code = cli_check(mode, argc - num_skipped, argv + num_skipped);
+    if (exit_code == EXIT_CLI_FAILURE) cli_help(program_name, EXIT_CLI_FAILURE);
     return exit_code;
 }
@@ -7,10 +7,60 @@
 
 /** @brief Program usage help string.
  */
-#define FERAT_USAGE_FMT "%s [-h, --help] [-v, --version] <QBF> <CNF Expansion>"
+#define FERAT_USAGE_FMT                                                               \
+    "%1$s [-h, --help] [-v, --version] [<Options>] <QBF> <CNF Expansion>\n"           \
+    "%1$s split <FERAT> <CNF Expansion> [<RAT>]\n"                                    \
+    "%1$s merge [<Merge Options>] <CNF Expansion> <RAT> <FERAT>\n"                    \
+    "%1$s check-many [<Options>] <QBF> <CNF Expansion>...\n"                          \
+    "%1$s serve [<Options>] <QBF> <Socket>\n"                                         \
+    "\n"                                                                              \
+    "The 'split' mode splits a (compressed) FERAT proof into its CNF expansion and\n" \
+    "its RAT proof, and reports whether the RAT proof is a hinted LRAT proof, and\n"  \
+    "whether it is binary. The 'merge' mode does the opposite. FERAT proofs may be\n" \
+    "compressed with gzip, zstd, or xz, the latter two of which need their\n"         \
+    "command line tools.\n"                                                           \
+    "\n"                                                                              \
+    "With '--index', 'merge' starts a plain FERAT proof with an index of its\n"       \
+    "sections. 'split' checks the proof against such an index, reports the offset\n"  \
+    "and size of the RAT proof as 'c rat <offset> <size>', and skips writing it if\n" \
+    "<RAT> is omitted, so that it can be read from the FERAT proof directly.\n"       \
+    "\n"                                                                              \
+    "The 'check-many' mode parses the QBF once, checks each CNF expansion against\n"  \
+    "it, and reports 'c result <exit code> <CNF Expansion>' after the output of\n"    \
+    "each check. The 'serve' mode does the same for the names of CNF expansions\n"    \
+    "sent to the Unix socket, one per line, until it receives 'shutdown'.\n"          \
+    "\n"                                                                              \
+    "Options of the merge mode:\n"                                                    \
+    "  --hints               the RAT proof is a hinted LRAT proof\n"                  \
+    "  --binary              the RAT proof is binary\n"                               \
+    "  --index               start the proof with an index, unless compressed\n"      \
+    "  --compress=<FORMAT>   one of 'none', 'gz', 'zstd', and 'xz', instead of\n"     \
+    "                        the suffix of <FERAT> ('.gz', '.zst', or '.xz')\n"       \
+    "  --threads=<N>         compress on <N> threads, or one per CPU if 0\n"          \
+    "\n"                                                                              \
+    "Options of the checking modes:\n"                                                \
+    "  --snapshot            load the parsed and sorted QBF from a snapshot next\n"   \
+    "                        to it, which is written if missing or out of date\n"     \
+    "  --snapshot-dir=<DIR>  the same, but keep snapshots in <DIR>"
+
+/** @brief Usage help string of the ferat-check program.
+ */
+#define FERAT_CHECK_USAGE_FMT                                                         \
+    "%1$s [-h, --help] [-v, --version] [<Options>] <QBF> <FERAT>\n"                   \
+    "\n"                                                                              \
+    "Checks a (compressed) FERAT proof of a QBF in one process. The proof is read\n"  \
+    "once, its expansion clauses are parsed into one arena, and the expansion and\n"  \
+    "the RAT proof are checked on two threads, which both read that arena. The\n"     \
+    "RAT proof is checked by drat-trim, or by lrat-check if it carries hints. The\n"  \
+    "first failure of either check ends the check.\n"                                 \
+    "\n"                                                                              \
+    "Options:\n"                                                                      \
+    "  --snapshot            load the parsed and sorted QBF from a snapshot next\n"   \
+    "                        to it, which is written if missing or out of date\n"     \
+    "  --snapshot-dir=<DIR>  the same, but keep snapshots in <DIR>"
 
 /** @brief Version string.
  */
-#define FERAT_VERSION "v0.5.2"
+#define FERAT_VERSION "v0.10.0"
 
 #endif
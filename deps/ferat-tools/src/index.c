@@ -0,0 +1,71 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "index.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Private Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define SECTION_FMT        "%" PRIu64 " %" PRIu64 " %" PRIu64
+#define SECTION_FMT_ARGS(s) (s).offset, (s).size, (s).count
+#define SECTION_SCN        "%" SCNu64 " %" SCNu64 " %" SCNu64
+#define SECTION_SCN_ARGS(s) &(s).offset, &(s).size, &(s).count
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Function Definitions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void
+ferat_section_add_line(FERATSection *const section, uint64_t offset, uint64_t size) {
+    if (section->count++ == 0) section->offset = offset;
+    section->size = offset + size - section->offset;
+}
+
+void
+ferat_index_format(FERATIndex const *const index, char buffer[FERAT_INDEX_WIDTH + 1]) {
+    int const size = snprintf(
+        buffer, FERAT_INDEX_WIDTH + 1,
+        FERAT_INDEX_TAG " %d hints %d binary %d p %" PRIu32 " %" PRIu64 " x " SECTION_FMT
+                        " o " SECTION_FMT " e " SECTION_FMT " r %" PRIu64 " %" PRIu64,
+        FERAT_INDEX_VERSION, index->hints, index->binary, index->max_var,
+        index->num_clauses, SECTION_FMT_ARGS(index->mapping),
+        SECTION_FMT_ARGS(index->origin), SECTION_FMT_ARGS(index->expansion),
+        index->rat.offset, index->rat.size);
+    // All numbers at their maximum still fit
+    assert(size > 0 && size < FERAT_INDEX_WIDTH);
+    memset(buffer + size, ' ', FERAT_INDEX_WIDTH - size);
+    buffer[FERAT_INDEX_WIDTH] = '\n';
+}
+
+bool
+ferat_index_parse(char const *const line, size_t size, FERATIndex *const index) {
+    // The line is neither null-terminated, nor necessarily an index line at all
+    char buffer[FERAT_INDEX_WIDTH + 2];
+    if (size > FERAT_INDEX_WIDTH + 1 || size < sizeof(FERAT_INDEX_TAG)
+        || memcmp(line, FERAT_INDEX_TAG " ", sizeof(FERAT_INDEX_TAG)) != 0)
+        return false;
+    memcpy(buffer, line, size);
+    buffer[size] = '\0';
+
+    int version, hints, binary, end = -1;
+    *index = (FERATIndex){ 0 };
+    sscanf(buffer,
+           FERAT_INDEX_TAG " %d hints %d binary %d p %" SCNu32 " %" SCNu64
+                           " x " SECTION_SCN " o " SECTION_SCN " e " SECTION_SCN
+                           " r %" SCNu64 " %" SCNu64 "%n",
+           &version, &hints, &binary, &index->max_var, &index->num_clauses,
+           SECTION_SCN_ARGS(index->mapping), SECTION_SCN_ARGS(index->origin),
+           SECTION_SCN_ARGS(index->expansion), &index->rat.offset, &index->rat.size,
+           &end);
+    if (end < 0 || version != FERAT_INDEX_VERSION) return false;
+    index->hints = (hints != 0);
+    index->binary = (binary != 0);
+    return true;
+}
@@ -0,0 +1,80 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FORALL_EXP_RAT_INDEX_INCLUDED
+#define FORALL_EXP_RAT_INDEX_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The start of the index line of a FERAT proof, which is followed by the
+ * version of the index.
+ */
+#define FERAT_INDEX_TAG     DIMACS_COMMENT_PREFIX "ferat-index"
+#define FERAT_INDEX_VERSION (1)
+
+/** @brief Width of the index line, which is padded with spaces so it can be written as a
+ * placeholder first, and back-patched once all offsets are known, excluding the newline.
+ */
+#define FERAT_INDEX_WIDTH (383)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief A section of a FERAT proof, which spans from the start of the first to the end
+ * of the last of its @c count lines, in bytes of the uncompressed proof. The 'x', 'o',
+ * and 'e' sections may contain comments.
+ */
+typedef struct FERATSection {
+    uint64_t offset, size, count;
+} FERATSection;
+
+/** @brief The index of a FERAT proof, which is written as a fixed-width comment on its
+ * first line, so that the RAT section runs up to the end of the file, and can be read
+ * from an offset into the proof without splitting it:
+ *
+ * <tt>c ferat-index 1 hints <0|1> binary <0|1> p <max var> <num clauses>
+ * x <offset> <size> <count> o ... e ... r <offset> <size></tt>
+ *
+ * The 'p' values are those of the 'p cnf ...' header of the split CNF expansion. The
+ * RAT section starts after the 'b' line of binary RAT proofs.
+ */
+typedef struct FERATIndex {
+    bool hints, binary;
+    Variable max_var;
+    uint64_t num_clauses;
+    FERATSection mapping, origin, expansion, rat;
+} FERATIndex;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Extends @p section by the line of @p size bytes at @p offset.
+ */
+void
+ferat_section_add_line(FERATSection *const section, uint64_t offset, uint64_t size);
+
+/** @brief Writes the index line of @p index, padded to FERAT_INDEX_WIDTH and followed by
+ * a newline, into @p buffer.
+ */
+void
+ferat_index_format(FERATIndex const *const index, char buffer[FERAT_INDEX_WIDTH + 1]);
+
+/** @brief Parses the index line @p line of @p size bytes into @p index.
+ *
+ * @returns false if @p line is not an index line of this version
+ */
+bool
+ferat_index_parse(char const *const line, size_t size, FERATIndex *const index);
+
+#endif
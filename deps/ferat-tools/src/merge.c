@@ -0,0 +1,266 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+// Needed for copy_file_range
+#define _GNU_SOURCE
+
+#include "merge.h"
+
+#include "index.h"
+#include "parsing.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The FERAT proof being written, which is either a plain or a compressed file,
+ * and the number of (uncompressed) bytes written to it so far.
+ */
+typedef struct Sink {
+    FILE *file;
+    FERATWriter *writer;
+    uint64_t offset;
+} Sink;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Output ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static bool
+sink_write(Sink *const sink, void const *const data, size_t size) {
+    if (size == 0) return true;
+    sink->offset += size;
+    if (sink->writer != NULL) return ferat_writer_write(sink->writer, data, size);
+    return fwrite(data, 1, size, sink->file) == size;
+}
+
+/** @brief Writes @p size bytes of @p data, and a newline if @p data does not already end
+ * in one.
+ */
+static bool
+sink_write_line(Sink *const sink, char const *const data, size_t size) {
+    bool const has_newline = (size > 0) && (data[size - 1] == '\n');
+    return sink_write(sink, data, size) && (has_newline || sink_write(sink, "\n", 1));
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Expansion Rewriting ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Writes one line of the CNF expansion as a line of the FERAT proof. Clauses
+ * become 'e' lines, 'c x' and 'c o' comments become 'x' and 'o' lines, other comments
+ * are copied over, and the header and empty lines are dropped. The written 'x', 'o', and
+ * 'e' lines are recorded in @p index, unless it is NULL.
+ */
+static bool
+merge_expansion_line(Sink *const sink, LineBuffer const *const line,
+                     FERATIndex *const index) {
+    char const *p = line->data, *const end = line->data + line->size;
+    while (p < end && isspace((u_char)*p)) ++p;
+    if (p == end) return true;
+    uint64_t const offset = sink->offset;
+    FERATSection *section = NULL;
+    bool ok;
+    switch (tolower((u_char)*p)) {
+    case 'p': return true;
+    case 'c':;
+        char const *q = p + 1;
+        if (q < end && isspace((u_char)*q)) {
+            while (q < end && isspace((u_char)*q)) ++q;
+            bool const is_mapping = (q < end) && (tolower((u_char)*q) == 'x'
+                                                  || tolower((u_char)*q) == 'o');
+            if (is_mapping && (q + 1 < end) && isspace((u_char)q[1])) {
+                ok = sink_write_line(sink, q, end - q);
+                if (index == NULL) return ok;
+                if (tolower((u_char)*q) == 'o') {
+                    section = &index->origin;
+                    break;
+                }
+                // Only the first part of 'x <exp_vars> 0 <qbf_vars> 0 <annots> 0' holds
+                // variables of the expansion
+                update_max_var(q + 1, true, &index->max_var);
+                section = &index->mapping;
+                break;
+            }
+        }
+        return sink_write_line(sink, line->data, line->size);
+    default:
+        ok = sink_write(sink, "e ", 2) && sink_write_line(sink, line->data, line->size);
+        if (index == NULL) return ok;
+        update_max_var(p, false, &index->max_var);
+        ++index->num_clauses;
+        section = &index->expansion;
+    }
+    ferat_section_add_line(section, offset, sink->offset - offset);
+    return ok;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ RAT Proof Copy ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Copies the rest of @p in_fd to @p out_fd without going through user space,
+ * using copy_file_range, or sendfile on file systems which do not support the former.
+ *
+ * @returns 1 if everything was copied, 0 if neither is supported and nothing was copied,
+ * and -1 on errors
+ */
+static int
+copy_in_kernel(int in_fd, int out_fd) {
+    ssize_t size;
+    bool copied = false;
+    while ((size = copy_file_range(in_fd, NULL, out_fd, NULL, FERAT_MERGE_CHUNK_SIZE, 0))
+           > 0)
+        copied = true;
+    if (size == 0) return 1;
+    if (copied
+        || (errno != EXDEV && errno != EINVAL && errno != ENOSYS && errno != EOPNOTSUPP))
+        return -1;
+    while ((size = sendfile(out_fd, in_fd, NULL, FERAT_MERGE_CHUNK_SIZE)) > 0)
+        copied = true;
+    if (size == 0) return 1;
+    if (copied || (errno != EINVAL && errno != ENOSYS)) return -1;
+    return 0;
+}
+
+/** @brief Appends the (gzipped) RAT proof @p rat_file_name to the FERAT proof.
+ */
+static bool
+copy_rat_proof(Sink *const sink, char const *const rat_file_name) {
+    gzFile rat_fd = gzopen(rat_file_name, "rb");
+    if (rat_fd == Z_NULL) {
+        ERR_COMMENT("Unable to open RAT input file: %s\n", rat_file_name);
+        return false;
+    }
+    gzbuffer(rat_fd, FERAT_MERGE_CHUNK_SIZE);
+
+    // Plain to plain files need no transformation, so let the kernel do it
+    if (sink->writer == NULL && gzdirect(rat_fd)) {
+        int const in_fd = open(rat_file_name, O_RDONLY);
+        if (in_fd >= 0 && fflush(sink->file) == 0) {
+            int const copied = copy_in_kernel(in_fd, fileno(sink->file));
+            close(in_fd);
+            if (copied != 0) {
+                gzclose(rat_fd);
+                return copied > 0;
+            }
+        } else if (in_fd >= 0) {
+            close(in_fd);
+        }
+    }
+
+    char *const chunk = malloc(FERAT_MERGE_CHUNK_SIZE);
+    if (chunk == NULL) {
+        ERR_COMMENT("Unable to allocate copy buffer\n");
+        gzclose(rat_fd);
+        return false;
+    }
+    int size = 0;
+    bool ok = true;
+    while (ok && (size = gzread(rat_fd, chunk, FERAT_MERGE_CHUNK_SIZE)) > 0)
+        ok = sink_write(sink, chunk, size);
+    if (size < 0) {
+        int gz_errnum;
+        ERR_COMMENT("Unable to read RAT proof: %s\n", gzerror(rat_fd, &gz_errnum));
+        ok = false;
+    }
+    free(chunk);
+    gzclose(rat_fd);
+    return ok;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Function Definitions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+bool
+ferat_merge(char const *const cnf_file_name, char const *const rat_file_name,
+            char const *const ferat_file_name, FERATMergeOptions const *const options) {
+    assert(cnf_file_name != NULL && rat_file_name != NULL && ferat_file_name != NULL);
+    assert(options != NULL);
+
+    gzFile cnf_fd = gzopen(cnf_file_name, "rb");
+    if (cnf_fd == Z_NULL) {
+        ERR_COMMENT("Unable to open CNF expansion input file: %s\n", cnf_file_name);
+        return false;
+    }
+    gzbuffer(cnf_fd, FERAT_MERGE_CHUNK_SIZE);
+
+    Sink sink = { 0 };
+    bool const compress = (options->compression != FERAT_COMPRESSION_NONE);
+    if (compress) {
+        sink.writer = ferat_writer_open(ferat_file_name, options->compression,
+                                        options->num_threads);
+    } else {
+        sink.file = fopen(ferat_file_name, "wb");
+        if (sink.file != NULL) setvbuf(sink.file, NULL, _IOFBF, FERAT_MERGE_CHUNK_SIZE);
+    }
+    if (sink.writer == NULL && sink.file == NULL) {
+        ERR_COMMENT("Unable to open FERAT output file: %s\n", ferat_file_name);
+        gzclose(cnf_fd);
+        return false;
+    }
+
+    // The index is written as a placeholder, and back-patched once all offsets are known
+    FERATIndex index = { .hints = options->hints, .binary = options->binary };
+    FERATIndex *const index_ptr = (options->index && !compress) ? &index : NULL;
+    char index_line[FERAT_INDEX_WIDTH + 1];
+    bool ok = true;
+    if (index_ptr != NULL) {
+        memset(index_line, ' ', FERAT_INDEX_WIDTH);
+        index_line[0] = 'c';
+        index_line[FERAT_INDEX_WIDTH] = '\n';
+        ok = sink_write(&sink, index_line, FERAT_INDEX_WIDTH + 1);
+    }
+
+    // Mark proofs whose RAT part is in LRAT format
+    ok = ok && (!options->hints || sink_write(&sink, "l\n", 2));
+    LineBuffer line = { 0 };
+    while (ok && read_line(cnf_fd, &line))
+        ok = merge_expansion_line(&sink, &line, index_ptr);
+    free(line.data);
+    int gz_errnum;
+    gzerror(cnf_fd, &gz_errnum);
+    if (ok && gz_errnum != Z_OK) {
+        ERR_COMMENT("Unable to read CNF expansion: %s\n", gzerror(cnf_fd, &gz_errnum));
+        ok = false;
+    }
+    gzclose(cnf_fd);
+
+    // A binary RAT proof is copied verbatim after the marker
+    if (ok && options->binary) ok = sink_write(&sink, "b\n", 2);
+    index.rat.offset = sink.offset;
+    if (ok) ok = copy_rat_proof(&sink, rat_file_name);
+
+    // The RAT proof may have been copied in the kernel, so its size is only known from
+    // the file itself
+    if (ok && index_ptr != NULL) {
+        struct stat stat_buf;
+        ok = (fflush(sink.file) == 0) && (fstat(fileno(sink.file), &stat_buf) == 0);
+        if (ok) {
+            index.rat.size = (uint64_t)stat_buf.st_size - index.rat.offset;
+            ferat_index_format(&index, index_line);
+            ok = (fseek(sink.file, 0, SEEK_SET) == 0)
+                 && (fwrite(index_line, 1, FERAT_INDEX_WIDTH + 1, sink.file)
+                     == FERAT_INDEX_WIDTH + 1);
+        }
+    }
+
+    if (sink.writer != NULL) ok = ferat_writer_close(sink.writer) && ok;
+    else ok = (fclose(sink.file) == 0) && ok;
+    if (!ok) ERR_COMMENT("Unable to write FERAT proof: %s\n", ferat_file_name);
+    return ok;
+}
@@ -0,0 +1,59 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include "compress.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#ifndef FORALL_EXP_RAT_MERGE_INCLUDED
+#define FORALL_EXP_RAT_MERGE_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Size of the output buffer, and of the chunks in which the RAT proof is copied
+ * when it cannot be copied in the kernel.
+ */
+#define FERAT_MERGE_CHUNK_SIZE (1 << 20)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Options for merging a CNF expansion and a RAT proof: whether the RAT proof is a
+ * hinted LRAT proof, whether it is binary, whether it starts with an index, see
+ * FERATIndex, and how the FERAT proof is compressed, on how many threads, see
+ * ferat_writer_open. Compressed proofs are never indexed, since their sections cannot be
+ * read by offset anyway.
+ */
+typedef struct FERATMergeOptions {
+    bool hints, binary, index;
+    FERATCompression compression;
+    unsigned int num_threads;
+} FERATMergeOptions;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Merges the (gzipped) CNF expansion @p cnf_file_name and the (gzipped) RAT
+ * proof @p rat_file_name into the FERAT proof @p ferat_file_name in a single pass. The
+ * clauses of the expansion are turned into 'e' lines, its 'c x' and 'c o' comments into
+ * 'x' and 'o' lines, and the 'p cnf ...' header is dropped. The RAT proof is appended as
+ * is, after a 'b' line if it is binary. If neither the RAT proof nor the FERAT proof are
+ * compressed, the RAT proof is copied in the kernel. An index is back-patched into the first
+ * line once everything else is written.
+ *
+ * @returns false if reading or writing failed, true otherwise
+ */
+bool
+ferat_merge(char const *const cnf_file_name, char const *const rat_file_name,
+            char const *const ferat_file_name, FERATMergeOptions const *const options);
+
+#endif
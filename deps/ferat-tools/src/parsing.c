@@ -10,6 +10,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <zlib.h>
 
 #define ARRAYLIST_WORD_DEFAULT_CAPACITY     (1 << 5)
@@ -264,3 +265,44 @@ handle_newline(Parser *const parser) {
     parser->state = PARSE_STATE_NONE;
     return true;
 }
+
+/** @brief Updates @p max_var with the variables of the space-delimited literals in
+ * @p content, stopping at the first @c 0 if @p stop_at_zero is set.
+ */
+void
+update_max_var(char const *content, bool stop_at_zero, Variable *const max_var) {
+    char *next;
+    while (true) {
+        long long const lit = strtoll(content, &next, 10);
+        if (next == content) break;
+        if (lit == 0 && stop_at_zero) break;
+        Variable const var = (Variable)llabs(lit);
+        if (var > *max_var) *max_var = var;
+        content = next;
+    }
+}
+
+/** @brief Reads one line from @p fd into @p line, growing the buffer as needed.
+ *
+ * @returns false at the end of the stream, or if reading failed
+ */
+bool
+read_line(gzFile fd, LineBuffer *const line) {
+    line->size = 0;
+    while (true) {
+        if (line->capacity - line->size < 2) {
+            line->capacity = line->capacity ? 2 * line->capacity : 4096;
+            line->data = realloc(line->data, line->capacity);
+            if (line->data == NULL) {
+                ERR_COMMENT("Unable to allocate line buffer of %zu bytes\n",
+                            line->capacity);
+                exit(EXIT_FAILURE);
+            }
+        }
+        char *const start = line->data + line->size;
+        if (gzgets(fd, start, line->capacity - line->size) == NULL) break;
+        line->size += strlen(start);
+        if (line->data[line->size - 1] == '\n') break;
+    }
+    return line->size > 0;
+}
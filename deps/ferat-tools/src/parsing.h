@@ -45,6 +45,15 @@ typedef struct Parser {
     ParseState state;
 } Parser;
 
+/** @brief A growable line buffer, which holds the current line of a (gzip) stream
+ * including its newline, if any. This is used where files are copied line by line
+ * instead of being parsed.
+ */
+typedef struct LineBuffer {
+    char *data;
+    size_t size, capacity;
+} LineBuffer;
+
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -92,4 +101,10 @@ expect_variable_list(Parser *const parser)
 bool
 handle_newline(Parser *const parser);
 
+void
+update_max_var(char const *content, bool stop_at_zero, Variable *const max_var);
+
+bool
+read_line(gzFile fd, LineBuffer *const line);
+
 #endif
@@ -0,0 +1,205 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+// Needed for fseeko
+#define _GNU_SOURCE
+
+#include "proof.h"
+
+#include "split.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Clause Parsing ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Appends @p lit to @p arena, growing it as needed.
+ */
+static bool
+arena_append(ClauseArena *const arena, int32_t lit) {
+    if (arena->size == arena->capacity) {
+        size_t const capacity
+            = arena->capacity ? 2 * arena->capacity : FERAT_ARENA_DEFAULT_CAP;
+        int32_t *const lits = realloc(arena->lits, sizeof(int32_t) * capacity);
+        if (lits == NULL) {
+            ERR_COMMENT("Unable to allocate clause arena of %zu literals\n", capacity);
+            return false;
+        }
+        arena->lits = lits;
+        arena->capacity = capacity;
+    }
+    arena->lits[arena->size++] = lit;
+    return true;
+}
+
+/** @brief Parses the literals of the 'e' line @p content into @p arena, up to and
+ * including the terminating @c 0, and raises @p max_var to the largest variable.
+ *
+ * @returns false if the line is not a list of literals ending in @c 0
+ */
+static bool
+parse_clause(char const *content, ClauseArena *const arena, Variable *const max_var) {
+    char const *const clause = content;
+    char *next;
+    while (true) {
+        errno = 0;
+        long const lit = strtol(content, &next, 10);
+        if (next == content || errno != 0 || lit < -INT32_MAX || lit > INT32_MAX
+            || (*next != '\0' && !isspace((u_char)*next))) {
+            ERR_COMMENT("Malformed expansion clause: %s", clause);
+            return false;
+        }
+        if (!arena_append(arena, (int32_t)lit)) return false;
+        if (lit == 0) break;
+        Variable const var = (Variable)labs(lit);
+        if (var > *max_var) *max_var = var;
+        content = next;
+    }
+    ++arena->num_clauses;
+    return true;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ RAT Handling ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Opens the RAT section of the indexed FERAT proof @p ferat_file_name, after
+ * checking that it runs up to the end of the file.
+ */
+static FILE *
+open_rat_section(char const *const ferat_file_name, FERATSection const *const rat) {
+    FILE *const rat_fd = fopen(ferat_file_name, "rb");
+    struct stat st;
+    if (rat_fd == NULL || fstat(fileno(rat_fd), &st) != 0
+        || (uint64_t)st.st_size != rat->offset + rat->size
+        || fseeko(rat_fd, (off_t)rat->offset, SEEK_SET) != 0) {
+        ERR_COMMENT("FERAT proof does not match its index\n");
+        if (rat_fd != NULL) fclose(rat_fd);
+        return NULL;
+    }
+    return rat_fd;
+}
+
+/** @brief Copies the rest of @p ferat_fd into @p rat_fd.
+ */
+static bool
+copy_binary_rat(gzFile ferat_fd, FILE *const rat_fd) {
+    char *const chunk = malloc(FERAT_SPLIT_CHUNK_SIZE);
+    if (chunk == NULL) {
+        ERR_COMMENT("Unable to allocate copy buffer\n");
+        return false;
+    }
+    bool ok = true;
+    int size = 0;
+    while (ok && (size = gzread(ferat_fd, chunk, FERAT_SPLIT_CHUNK_SIZE)) > 0)
+        ok = fwrite(chunk, 1, size, rat_fd) == (size_t)size;
+    free(chunk);
+    return ok && size == 0;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Function Definitions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+bool
+ferat_proof_read(char const *const ferat_file_name, gzFile ferat_fd,
+                 FERATProof *const proof) {
+    assert(ferat_fd != NULL && proof != NULL);
+    *proof = (FERATProof){ 0 };
+
+    LineBuffer line = { 0 };
+    FERATIndex index = { 0 }, counts = { 0 };
+    char const *content = NULL;
+    bool const indexed
+        = read_line(ferat_fd, &line) && ferat_index_parse(line.data, line.size, &index);
+    // The RAT section of a plain indexed proof runs to its end, so it is not copied
+    bool const direct = indexed && ferat_file_name != NULL;
+    proof->preamble = tmpfile();
+    proof->rat = direct ? NULL : tmpfile();
+    bool ok = proof->preamble != NULL && (direct || proof->rat != NULL);
+    if (!ok) ERR_COMMENT("Unable to create temporary files\n");
+
+    bool have_line = !indexed && line.size > 0;
+    while (ok && !proof->binary
+           && (!direct || gztell(ferat_fd) < (z_off_t)index.rat.offset)
+           && (have_line || read_line(ferat_fd, &line))) {
+        have_line = false;
+        char const keyword = ferat_line_keyword(&line, &content);
+        switch (keyword) {
+        case 'e':
+            ++counts.expansion.count;
+            ok = parse_clause(content, &proof->clauses, &proof->max_var);
+            break;
+        case 'x':
+            update_max_var(content, true, &proof->max_var);
+            ++counts.mapping.count;
+            ok = fprintf(proof->preamble, "c x %s", content) >= 0;
+            break;
+        case 'o':
+            ++counts.origin.count;
+            ok = fprintf(proof->preamble, "c o %s", content) >= 0;
+            break;
+        case 'l': proof->hints = true; break;
+        case 'b':
+            proof->binary = true;
+            ok = direct
+                 || ((fflush(proof->rat) == 0) && (ftruncate(fileno(proof->rat), 0) == 0)
+                     && (fseek(proof->rat, 0, SEEK_SET) == 0));
+            break;
+        default: ok = direct || fwrite(line.data, 1, line.size, proof->rat) == line.size;
+        }
+        // The last line of the proof may lack its newline
+        if (ok && (keyword == 'x' || keyword == 'o') && line.data[line.size - 1] != '\n')
+            ok = fputc('\n', proof->preamble) != EOF;
+    }
+    free(line.data);
+
+    int gz_errnum;
+    gzerror(ferat_fd, &gz_errnum);
+    if (ok && gz_errnum != Z_OK) {
+        ERR_COMMENT("Unable to read FERAT proof: %s\n", gzerror(ferat_fd, &gz_errnum));
+        return false;
+    }
+    if (ok && proof->binary && !direct) ok = copy_binary_rat(ferat_fd, proof->rat);
+    // The 'p cnf ...' header has to come after the 'c x' and 'c o' comments
+    if (ok)
+        ok = fprintf(proof->preamble, "p cnf %" PRIu32 " %" PRIu64 "\n", proof->max_var,
+                     proof->clauses.num_clauses)
+                 >= 0
+             && fflush(proof->preamble) == 0 && fseek(proof->preamble, 0, SEEK_SET) == 0;
+    if (ok && !direct)
+        ok = fflush(proof->rat) == 0 && fseek(proof->rat, 0, SEEK_SET) == 0;
+    if (!ok) return false;
+
+    if (indexed
+        && (index.hints != proof->hints || index.binary != proof->binary
+            || index.max_var != proof->max_var
+            || index.num_clauses != proof->clauses.num_clauses
+            || index.mapping.count != counts.mapping.count
+            || index.origin.count != counts.origin.count
+            || index.expansion.count != counts.expansion.count)) {
+        ERR_COMMENT("FERAT proof does not match its index\n");
+        return false;
+    }
+    if (direct) proof->rat = open_rat_section(ferat_file_name, &index.rat);
+    return proof->rat != NULL;
+}
+
+void
+ferat_proof_free(FERATProof *const proof) {
+    assert(proof != NULL);
+    free(proof->clauses.lits);
+    if (proof->preamble != NULL) fclose(proof->preamble);
+    if (proof->rat != NULL) fclose(proof->rat);
+    *proof = (FERATProof){ 0 };
+}
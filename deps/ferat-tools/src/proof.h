@@ -0,0 +1,65 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include "expansion.h"
+#include "index.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <zlib.h>
+
+#ifndef FORALL_EXP_RAT_PROOF_INCLUDED
+#define FORALL_EXP_RAT_PROOF_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Initial capacity of a ClauseArena in literals.
+ */
+#define FERAT_ARENA_DEFAULT_CAP (1 << 16)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief A FERAT proof, as read once by ferat_proof_read for both of its checks.
+ */
+typedef struct FERATProof {
+    ClauseArena clauses; ///< @brief The parsed 'e' clauses
+    FILE *preamble;      ///< @brief The 'c x' and 'c o' comments, and the 'p cnf ...'
+                         ///< header of the expansion, to be read by
+                         ///< expansion_parse_preamble()
+    FILE *rat;           ///< @brief The RAT proof, positioned at its start
+    bool hints, binary;
+    Variable max_var;
+} FERATProof;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Reads the FERAT proof in @p ferat_fd in a single pass, like ferat_split. The
+ * 'e' lines are parsed into the ClauseArena of @p proof, the 'x' and 'o' lines are kept
+ * as the preamble of the expansion, and the RAT proof is copied into an anonymous
+ * temporary file. If the proof starts with an index, see FERATIndex, and
+ * @p ferat_file_name is given, which is only possible for uncompressed proofs, the RAT
+ * proof is read from that file directly instead.
+ *
+ * @returns false if the proof is malformed, or reading or writing failed, in which case
+ * @p proof still needs to be freed with ferat_proof_free
+ */
+bool
+ferat_proof_read(char const *const ferat_file_name, gzFile ferat_fd,
+                 FERATProof *const proof);
+
+/** @brief Frees the ClauseArena of @p proof, and closes its files.
+ */
+void
+ferat_proof_free(FERATProof *const proof);
+
+#endif
@@ -13,6 +13,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <zlib.h>
 
 #define ARRAYLIST_PREFIX_DEFAULT_CAP (1 << 7)
@@ -58,6 +59,8 @@ qbf_new(void) {
     qbf->warned_free = ht_new(HASHTABLE_DEFAULT_NUM_SLOTS);
     qbf->prefix = alptr_new(ARRAYLIST_PREFIX_DEFAULT_CAP);
     qbf->matrix = alptr_new(ARRAYLIST_MATRIX_DEFAULT_CAP);
+    qbf->snapshot = NULL;
+    qbf->snapshot_size = 0;
     // qbf->num_existential_cache = ht_new(HASHTABLE_DEFAULT_NUM_SLOTS);
     return qbf;
 }
@@ -65,17 +68,22 @@ qbf_new(void) {
 void
 qbf_free(QBF *const qbf) {
     assert(qbf != NULL);
-    // NOTE: The Quantifier structs are taken care of by the array list below
+    // NOTE: The Quantifier structs are taken care of by the array list below, unless
+    //       they, and the QBFClause structs, live in a snapshot
+    bool const owns_structs = (qbf->snapshot == NULL);
     if (qbf->prefix_mapping != NULL) ht_free(qbf->prefix_mapping);
     if (qbf->warned_free != NULL) ht_free(qbf->warned_free);
     if (qbf->prefix != NULL) {
-        for (size_t i = 0; i < qbf->prefix->size; ++i) free(alptr_get(qbf->prefix, i));
+        for (size_t i = 0; owns_structs && i < qbf->prefix->size; ++i)
+            free(alptr_get(qbf->prefix, i));
         alptr_free(qbf->prefix);
     }
     if (qbf->matrix != NULL) {
-        for (size_t i = 0; i < qbf->matrix->size; ++i) free(alptr_get(qbf->matrix, i));
+        for (size_t i = 0; owns_structs && i < qbf->matrix->size; ++i)
+            free(alptr_get(qbf->matrix, i));
         alptr_free(qbf->matrix);
     }
+    if (!owns_structs) munmap(qbf->snapshot, qbf->snapshot_size);
     // if (qbf->num_existential_cache != NULL) ht_free(qbf->num_existential_cache);
 
     free(qbf);
@@ -7,6 +7,7 @@
 #include "arraylist.h"
 #include "hashtable.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <zlib.h>
 
@@ -60,6 +61,10 @@ typedef struct QBF {
                                ///< bool (value)
     ArrayList_ptr_t *prefix;   ///< @brief ArrayList of Quantifier *
     ArrayList_ptr_t *matrix;   ///< @brief ArrayList of QBFClause *
+    void *snapshot;            ///< @brief The mapped snapshot, which the Quantifier and
+                               ///< QBFClause structs point into, or NULL, see
+                               ///< qbf_snapshot_load
+    size_t snapshot_size;      ///< @brief The size of the mapped snapshot
     // HashTable *num_existential_cache; ///< @brief Cache for the number of existential
     //                                   ///< literals in a given clause
 } QBF;
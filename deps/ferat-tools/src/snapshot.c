@@ -0,0 +1,333 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "snapshot.h"
+
+#include "arraylist.h"
+#include "hashtable.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Private Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define SNAPSHOT_CHUNK_SIZE (1 << 20)
+#define ALIGN8(n)           (((n) + 7u) & ~(uint64_t)7u)
+
+_Static_assert(sizeof(Quantifier) == 3 * sizeof(uint32_t), "Quantifier layout changed");
+_Static_assert(sizeof(QBFClause) == sizeof(uint32_t), "QBFClause layout changed");
+_Static_assert(sizeof(QBFSnapshotHeader) % 8 == 0, "Header is not 8-byte aligned");
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Source ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Adds the @p size bytes at @p data to the CRC-32 @p checksum, in chunks which
+ * fit into the length argument of zlib.
+ */
+static uLong
+add_checksum(uLong checksum, unsigned char const *data, uint64_t size) {
+    while (size > 0) {
+        uInt const length
+            = (size < SNAPSHOT_CHUNK_SIZE) ? (uInt)size : SNAPSHOT_CHUNK_SIZE;
+        checksum = crc32(checksum, data, length);
+        data += length;
+        size -= length;
+    }
+    return checksum;
+}
+
+bool
+qbf_snapshot_source(char const *const qbf_file_name, QBFSource *const source) {
+    int const fd = open(qbf_file_name, O_RDONLY);
+    if (fd == -1) return false;
+    unsigned char *const chunk = malloc(SNAPSHOT_CHUNK_SIZE);
+    assert(chunk != NULL);
+    uLong checksum = crc32(0L, Z_NULL, 0);
+    uint64_t size = 0;
+    ssize_t num_read;
+    while ((num_read = read(fd, chunk, SNAPSHOT_CHUNK_SIZE)) > 0) {
+        checksum = crc32(checksum, chunk, (uInt)num_read);
+        size += (uint64_t)num_read;
+    }
+    free(chunk);
+    close(fd);
+    if (num_read == -1) return false;
+    source->size = size;
+    source->checksum = (uint32_t)checksum;
+    return true;
+}
+
+bool
+qbf_snapshot_file_name(char const *const qbf_file_name, char const *const snapshot_dir,
+                       QBFSource const *const source, char *const buffer, size_t size) {
+    int length;
+    if (snapshot_dir == NULL) {
+        length = snprintf(buffer, size, "%s" QBF_SNAPSHOT_SUFFIX, qbf_file_name);
+    } else {
+        char const *const slash = strrchr(qbf_file_name, '/');
+        char const *const base_name = (slash == NULL) ? qbf_file_name : slash + 1;
+        length = snprintf(buffer, size, "%s/%s.%08" PRIx32 QBF_SNAPSHOT_SUFFIX,
+                          snapshot_dir, base_name, source->checksum);
+    }
+    return length >= 0 && (size_t)length < size;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Loading ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Checks that the sections of the snapshot with @p header lie within its
+ * @p file_size bytes, in order, and aligned.
+ */
+static bool
+header_is_valid(QBFSnapshotHeader const *const header, uint64_t file_size,
+                QBFSource const *const source) {
+    if (memcmp(header->magic, QBF_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != QBF_SNAPSHOT_VERSION)
+        return false;
+    if (header->source_size != source->size
+        || header->source_checksum != source->checksum)
+        return false;
+    uint64_t const var_table_size = ((uint64_t)header->max_var + 1) * sizeof(uint32_t);
+    uint64_t const clause_offsets_size = (uint64_t)header->num_clauses * sizeof(uint64_t);
+    return header->file_size == file_size
+        && header->prefix_offset == sizeof(QBFSnapshotHeader)
+        && header->var_table_offset >= header->prefix_offset
+        && header->var_table_offset % 8 == 0
+        && header->clause_offsets_offset >= header->var_table_offset + var_table_size
+        && header->clause_offsets_offset % 8 == 0
+        && header->matrix_offset >= header->clause_offsets_offset + clause_offsets_size
+        && header->matrix_offset % 8 == 0 && header->matrix_offset <= file_size;
+}
+
+/** @brief Fills @p qbf with the prefix and matrix of the mapped snapshot at @p base.
+ *
+ * @returns false if the sections are inconsistent, or a variable or literal lies outside
+ * of @c 1 through @c max_var
+ */
+static bool
+fill_from_snapshot(QBF *const qbf, unsigned char *const base) {
+    QBFSnapshotHeader const *const header = (QBFSnapshotHeader *)base;
+    qbf->max_var = header->max_var;
+    qbf->num_alternations = header->num_alternations;
+
+    // Prefix
+    uint64_t offset = header->prefix_offset;
+    for (uint32_t i = 0; i < header->num_quantifiers; ++i) {
+        if (offset + sizeof(Quantifier) > header->var_table_offset) return false;
+        Quantifier *const quantifier = (Quantifier *)(base + offset);
+        offset += sizeof(Quantifier) + (uint64_t)quantifier->num_vars * sizeof(Variable);
+        if (offset > header->var_table_offset) return false;
+        if (quantifier->type != QUANT_TYPE_EXISTENTIAL
+            && quantifier->type != QUANT_TYPE_UNIVERSAL)
+            return false;
+        for (uint32_t j = 0; j < quantifier->num_vars; ++j)
+            if (quantifier->variables[j] == 0
+                || quantifier->variables[j] > header->max_var)
+                return false;
+        qbf->prefix = alptr_append(qbf->prefix, quantifier);
+    }
+
+    // Per-variable table
+    uint32_t const *const var_table = (uint32_t *)(base + header->var_table_offset);
+    for (Variable var = 0; var <= header->max_var; ++var) {
+        if (var_table[var] == 0) continue;
+        if (var_table[var] > header->num_quantifiers) return false;
+        ht_insert(qbf->prefix_mapping, hash_fnv1a(var),
+                  (uint64_t)alptr_get(qbf->prefix, var_table[var] - 1));
+    }
+
+    // Matrix
+    alptr_free(qbf->matrix);
+    qbf->matrix = alptr_new(header->num_clauses + 1);
+    uint64_t const *const clause_offsets
+        = (uint64_t *)(base + header->clause_offsets_offset);
+    uint64_t const matrix_size = header->file_size - header->matrix_offset;
+    for (uint32_t i = 0; i < header->num_clauses; ++i) {
+        uint64_t const clause_offset = clause_offsets[i];
+        if (clause_offset % 4 != 0 || clause_offset + sizeof(QBFClause) > matrix_size)
+            return false;
+        QBFClause *const clause
+            = (QBFClause *)(base + header->matrix_offset + clause_offset);
+        if (clause_offset + sizeof(QBFClause)
+                + (uint64_t)clause->num_literals * sizeof(Literal)
+            > matrix_size)
+            return false;
+        for (uint32_t j = 0; j < clause->num_literals; ++j)
+            if (LIT2VAR(clause->lits[j]) == 0
+                || LIT2VAR(clause->lits[j]) > header->max_var)
+                return false;
+        qbf->matrix = alptr_append(qbf->matrix, clause);
+    }
+    return true;
+}
+
+QBF *
+qbf_snapshot_load(char const *const snapshot_file_name, QBFSource const *const source) {
+    int const fd = open(snapshot_file_name, O_RDONLY);
+    if (fd == -1) return NULL;
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) == -1
+        || (size_t)stat_buf.st_size < sizeof(QBFSnapshotHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t const file_size = (size_t)stat_buf.st_size;
+    // Private, so that in-place changes, like sorting the clauses again, never reach the
+    // file
+    void *const base = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+    // The checksum is only worth computing once the header is known to be sound
+    QBFSnapshotHeader const *const header = base;
+    if (!header_is_valid(header, file_size, source)
+        || add_checksum(crc32(0L, Z_NULL, 0), (unsigned char *)base + sizeof(*header),
+                        file_size - sizeof(*header))
+               != header->body_checksum) {
+        munmap(base, file_size);
+        return NULL;
+    }
+
+    QBF *const qbf = qbf_new();
+    qbf->snapshot = base;
+    qbf->snapshot_size = file_size;
+    if (!fill_from_snapshot(qbf, base)) {
+        qbf_free(qbf);
+        return NULL;
+    }
+    return qbf;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Writing ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Writes the @p size bytes at @p data after the header, and adds them to the
+ * @p checksum of the body.
+ */
+static bool
+write_body(FILE *const file, void const *const data, size_t size, uLong *const checksum) {
+    *checksum = add_checksum(*checksum, data, size);
+    return fwrite(data, 1, size, file) == size;
+}
+
+static bool
+write_padding(FILE *const file, uint64_t from, uint64_t to, uLong *const checksum) {
+    static char const zeros[8] = { 0 };
+    return write_body(file, zeros, to - from, checksum);
+}
+
+bool
+qbf_snapshot_write(QBF const *const qbf, char const *const snapshot_file_name,
+                   QBFSource const *const source) {
+    assert(qbf != NULL);
+    QBFSnapshotHeader header = {
+        .version = QBF_SNAPSHOT_VERSION,
+        .max_var = qbf->max_var,
+        .num_alternations = qbf->num_alternations,
+        .num_quantifiers = qbf->prefix->size,
+        .num_clauses = qbf->matrix->size,
+        .source_checksum = source->checksum,
+        .source_size = source->size,
+        .prefix_offset = sizeof(QBFSnapshotHeader),
+    };
+    memcpy(header.magic, QBF_SNAPSHOT_MAGIC, sizeof(header.magic));
+
+    // Section layout, and per-variable table
+    uint32_t *const var_table = calloc((size_t)qbf->max_var + 1, sizeof(uint32_t));
+    assert(var_table != NULL);
+    uint64_t prefix_size = 0;
+    for (uint32_t i = 0; i < qbf->prefix->size; ++i) {
+        Quantifier const *const quantifier = alptr_get(qbf->prefix, i);
+        prefix_size += sizeof(Quantifier) + quantifier->num_vars * sizeof(Variable);
+        for (uint32_t j = 0; j < quantifier->num_vars; ++j)
+            if (quantifier->variables[j] <= qbf->max_var)
+                var_table[quantifier->variables[j]] = i + 1;
+    }
+    header.var_table_offset = ALIGN8(header.prefix_offset + prefix_size);
+    header.clause_offsets_offset = ALIGN8(
+        header.var_table_offset + ((uint64_t)qbf->max_var + 1) * sizeof(uint32_t));
+    header.matrix_offset = ALIGN8(header.clause_offsets_offset
+                                  + (uint64_t)qbf->matrix->size * sizeof(uint64_t));
+    uint64_t *const clause_offsets
+        = malloc(((size_t)qbf->matrix->size + 1) * sizeof(uint64_t));
+    assert(clause_offsets != NULL);
+    uint64_t matrix_size = 0;
+    for (uint32_t i = 0; i < qbf->matrix->size; ++i) {
+        QBFClause const *const clause = alptr_get(qbf->matrix, i);
+        clause_offsets[i] = matrix_size;
+        matrix_size += sizeof(QBFClause) + clause->num_literals * sizeof(Literal);
+    }
+    header.file_size = header.matrix_offset + matrix_size;
+
+    size_t const name_length = strlen(snapshot_file_name);
+    char *const tmp_file_name = malloc(name_length + 8);
+    assert(tmp_file_name != NULL);
+    memcpy(tmp_file_name, snapshot_file_name, name_length);
+    memcpy(tmp_file_name + name_length, ".XXXXXX", 8);
+    int const fd = mkstemp(tmp_file_name);
+    if (fd != -1) fchmod(fd, 0644);
+    FILE *const file = (fd == -1) ? NULL : fdopen(fd, "wb");
+    bool ok = (file != NULL);
+    if (ok) {
+        setvbuf(file, NULL, _IOFBF, SNAPSHOT_CHUNK_SIZE);
+        uLong checksum = crc32(0L, Z_NULL, 0);
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        for (uint32_t i = 0; ok && i < qbf->prefix->size; ++i) {
+            Quantifier const *const quantifier = alptr_get(qbf->prefix, i);
+            ok = write_body(file, quantifier, sizeof(Quantifier), &checksum)
+              && write_body(file, quantifier->variables,
+                            quantifier->num_vars * sizeof(Variable), &checksum);
+        }
+        uint64_t const var_table_end = header.prefix_offset + prefix_size;
+        ok = ok && write_padding(file, var_table_end, header.var_table_offset, &checksum)
+          && write_body(file, var_table, ((size_t)qbf->max_var + 1) * sizeof(uint32_t),
+                        &checksum);
+        ok = ok
+          && write_padding(file,
+                           header.var_table_offset
+                               + ((uint64_t)qbf->max_var + 1) * sizeof(uint32_t),
+                           header.clause_offsets_offset, &checksum)
+          && write_body(file, clause_offsets, qbf->matrix->size * sizeof(uint64_t),
+                        &checksum);
+        ok = ok
+          && write_padding(file,
+                           header.clause_offsets_offset
+                               + (uint64_t)qbf->matrix->size * sizeof(uint64_t),
+                           header.matrix_offset, &checksum);
+        for (uint32_t i = 0; ok && i < qbf->matrix->size; ++i) {
+            QBFClause const *const clause = alptr_get(qbf->matrix, i);
+            ok = write_body(file, clause, sizeof(QBFClause), &checksum)
+              && write_body(file, clause->lits, clause->num_literals * sizeof(Literal),
+                            &checksum);
+        }
+        // The checksum of the body is only known now, so the header is written again
+        header.body_checksum = (uint32_t)checksum;
+        ok = ok && fseek(file, 0, SEEK_SET) == 0
+          && fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = (fclose(file) == 0) && ok;
+    } else if (fd != -1) {
+        close(fd);
+    }
+    if (fd != -1) {
+        ok = ok && (rename(tmp_file_name, snapshot_file_name) == 0);
+        if (!ok) unlink(tmp_file_name);
+    }
+
+    free(tmp_file_name);
+    free(clause_offsets);
+    free(var_table);
+    return ok;
+}
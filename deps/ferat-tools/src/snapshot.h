@@ -0,0 +1,112 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include "qbf.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FORALL_EXP_RAT_SNAPSHOT_INCLUDED
+#define FORALL_EXP_RAT_SNAPSHOT_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#define QBF_SNAPSHOT_MAGIC "FERATQBF"
+
+/** @brief Version of the snapshot layout, which has to be bumped whenever the layout, or
+ * the Quantifier and QBFClause structs, or the clause sorting change.
+ */
+#define QBF_SNAPSHOT_VERSION (2)
+
+/** @brief File name suffix of snapshots.
+ */
+#define QBF_SNAPSHOT_SUFFIX ".fqs"
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The size and CRC-32 of the raw bytes of a QBF file, which a snapshot has to
+ * match to be used.
+ */
+typedef struct QBFSource {
+    uint64_t size;
+    uint32_t checksum;
+} QBFSource;
+
+/** @brief The header of a snapshot of a parsed, and sorted QBF. It is followed by four
+ * sections at 8-byte aligned offsets from the start of the file:
+ *
+ * - the prefix, as Quantifier structs back to back,
+ * - the per-variable table, with the index of the Quantifier of each variable plus one,
+ *   or zero for free variables, for the variables @c 0 through @c max_var,
+ * - the clause offsets, as one @c uint64_t offset into the matrix per clause,
+ * - and the matrix, as sorted QBFClause structs back to back.
+ *
+ * The CRC-32 of everything after the header is kept in @c body_checksum.
+ */
+typedef struct QBFSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t max_var;
+    uint32_t num_alternations;
+    uint32_t num_quantifiers;
+    uint32_t num_clauses;
+    uint32_t source_checksum;
+    uint64_t source_size;
+    uint64_t prefix_offset, var_table_offset, clause_offsets_offset, matrix_offset;
+    uint64_t file_size;
+    uint32_t body_checksum;
+    uint32_t padding;
+} QBFSnapshotHeader;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Reads the QBF file @p qbf_file_name to determine its size and checksum.
+ *
+ * @returns false if the file could not be read
+ */
+bool
+qbf_snapshot_source(char const *const qbf_file_name, QBFSource *const source);
+
+/** @brief Writes the name of the snapshot of the QBF file @p qbf_file_name with the
+ * given @p source into @p buffer. The snapshot lies next to the QBF file if
+ * @p snapshot_dir is NULL, and in @p snapshot_dir, named after the QBF file and its
+ * checksum, otherwise.
+ *
+ * @returns false if the name does not fit into @p buffer
+ */
+bool
+qbf_snapshot_file_name(char const *const qbf_file_name, char const *const snapshot_dir,
+                       QBFSource const *const source, char *const buffer, size_t size);
+
+/** @brief Maps the snapshot @p snapshot_file_name into memory, and creates a QBF from
+ * it, whose Quantifier and QBFClause structs point into the mapping. The clauses are
+ * already sorted by quantifier index.
+ *
+ * @returns the QBF, or NULL if the snapshot does not exist, does not match @p source, or
+ * is broken, i.e. its checksum does not match, or it holds a variable or literal outside
+ * of @c 1 through @c max_var
+ */
+QBF *
+qbf_snapshot_load(char const *const snapshot_file_name, QBFSource const *const source);
+
+/** @brief Writes a snapshot of @p qbf, which has to be sorted, to @p snapshot_file_name.
+ * The snapshot is written to a temporary file first, and renamed into place, so that
+ * concurrent readers never see half a snapshot.
+ *
+ * @returns false if writing failed
+ */
+bool
+qbf_snapshot_write(QBF const *const qbf, char const *const snapshot_file_name,
+                   QBFSource const *const source);
+
+#endif
@@ -0,0 +1,192 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "split.h"
+
+#include "parsing.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Line Handling ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+char
+ferat_line_keyword(LineBuffer const *const line, char const **const content) {
+    char const *p = line->data, *const end = line->data + line->size;
+    while (p < end && isspace((u_char)*p)) ++p;
+    if (p == end) return '\0';
+    char const keyword = tolower((u_char)*p++);
+    switch (keyword) {
+    case 'e':
+    case 'x':
+    case 'o':
+        if (p == end || !isspace((u_char)*p)) return '\0';
+        while (p < end && isspace((u_char)*p)) ++p;
+        *content = p;
+        return keyword;
+    case 'l':
+    case 'b':
+        while (p < end && isspace((u_char)*p)) ++p;
+        return (p == end) ? keyword : '\0';
+    default: return '\0';
+    }
+}
+
+/** @brief Writes @p prefix and the @p content of @p line to @p cnf_fd, always ending in
+ * a newline.
+ */
+static bool
+write_content(FILE *const cnf_fd, char const *const prefix, LineBuffer const *const line,
+              char const *const content) {
+    size_t size = line->data + line->size - content;
+    if (size > 0 && content[size - 1] == '\n') --size;
+    return fputs(prefix, cnf_fd) >= 0 && fwrite(content, 1, size, cnf_fd) == size
+           && fputc('\n', cnf_fd) != EOF;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Header Patching ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Writes the 'p cnf ...' header of @p result padded with spaces to
+ * FERAT_SPLIT_HEADER_WIDTH, followed by a newline.
+ */
+static bool
+write_header(FILE *const cnf_fd, FERATSplitResult const *const result) {
+    char header[FERAT_SPLIT_HEADER_WIDTH + 2];
+    int const size = snprintf(header, sizeof(header), "p cnf %" PRIu32 " %" PRIu64,
+                              result->max_var, result->num_clauses);
+    assert(size > 0 && size <= FERAT_SPLIT_HEADER_WIDTH);
+    memset(header + size, ' ', FERAT_SPLIT_HEADER_WIDTH - size);
+    header[FERAT_SPLIT_HEADER_WIDTH] = '\n';
+    return fwrite(header, 1, FERAT_SPLIT_HEADER_WIDTH + 1, cnf_fd)
+           == FERAT_SPLIT_HEADER_WIDTH + 1;
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Function Definitions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+bool
+ferat_split(gzFile ferat_fd, FILE *const cnf_fd, FILE *const rat_fd,
+            FERATSplitResult *const result) {
+    assert(ferat_fd != NULL && cnf_fd != NULL && result != NULL);
+    *result = (FERATSplitResult){ 0 };
+
+    LineBuffer line = { 0 };
+    long header_pos = -1;
+    bool ok = true;
+    char const *content = NULL;
+    FERATIndex counts = { 0 };
+    if (read_line(ferat_fd, &line))
+        result->indexed = ferat_index_parse(line.data, line.size, &result->index);
+    if (rat_fd == NULL && !result->indexed) {
+        ERR_COMMENT("FERAT proof has no index, so its RAT proof cannot be skipped\n");
+        free(line.data);
+        return false;
+    }
+    // The index line is already consumed, and any other first line is handled below
+    bool have_line = !result->indexed && line.size > 0;
+    while (ok && !result->binary
+           && (rat_fd != NULL || gztell(ferat_fd) < (z_off_t)result->index.rat.offset)
+           && (have_line || read_line(ferat_fd, &line))) {
+        have_line = false;
+        char const keyword = ferat_line_keyword(&line, &content);
+        switch (keyword) {
+        case 'e':
+            // The 'p cnf ...' header has to come after the 'c x' and 'c o' comments,
+            // so we reserve space for it in front of the first clause
+            if (header_pos < 0) {
+                header_pos = ftell(cnf_fd);
+                ok = (header_pos >= 0) && write_header(cnf_fd, result);
+            }
+            update_max_var(content, false, &result->max_var);
+            ++result->num_clauses;
+            ++counts.expansion.count;
+            ok = ok && write_content(cnf_fd, "", &line, content);
+            break;
+        case 'x':
+            // Only the first part of 'x <exp_vars> 0 <qbf_vars> 0 <annots> 0' holds
+            // variables of the expansion
+            update_max_var(content, true, &result->max_var);
+            ++counts.mapping.count;
+            // fall through
+        case 'o':
+            if (keyword == 'o') ++counts.origin.count;
+            ok = write_content(cnf_fd, (keyword == 'x') ? "c x " : "c o ", &line,
+                               content);
+            break;
+        case 'l': result->hints = true; break;
+        case 'b':
+            // Text lines before the marker are comments, and must not end up in front of
+            // the binary RAT proof
+            result->binary = true;
+            ok = (rat_fd == NULL)
+                 || ((fflush(rat_fd) == 0) && (ftruncate(fileno(rat_fd), 0) == 0)
+                     && (fseek(rat_fd, 0, SEEK_SET) == 0));
+            break;
+        default:
+            // RAT line, but a binary RAT proof only follows the marker
+            ok = (rat_fd == NULL) || fwrite(line.data, 1, line.size, rat_fd) == line.size;
+        }
+    }
+    free(line.data);
+
+    int gz_errnum;
+    gzerror(ferat_fd, &gz_errnum);
+    if (ok && gz_errnum != Z_OK) {
+        ERR_COMMENT("Unable to read FERAT proof: %s\n", gzerror(ferat_fd, &gz_errnum));
+        return false;
+    }
+
+    if (ok && result->binary && rat_fd != NULL) {
+        char *const chunk = malloc(FERAT_SPLIT_CHUNK_SIZE);
+        if (chunk == NULL) {
+            ERR_COMMENT("Unable to allocate copy buffer\n");
+            return false;
+        }
+        int size = 0;
+        while (ok && (size = gzread(ferat_fd, chunk, FERAT_SPLIT_CHUNK_SIZE)) > 0)
+            ok = fwrite(chunk, 1, size, rat_fd) == (size_t)size;
+        free(chunk);
+        if (size < 0) {
+            ERR_COMMENT("Unable to read FERAT proof: %s\n",
+                        gzerror(ferat_fd, &gz_errnum));
+            return false;
+        }
+    }
+
+    // Without any clauses, the header simply goes after all comments
+    if (ok && header_pos < 0) {
+        ok = write_header(cnf_fd, result);
+    } else if (ok) {
+        long const end_pos = ftell(cnf_fd);
+        ok = (end_pos >= 0) && (fseek(cnf_fd, header_pos, SEEK_SET) == 0)
+             && write_header(cnf_fd, result) && (fseek(cnf_fd, end_pos, SEEK_SET) == 0);
+    }
+    if (!ok) {
+        ERR_COMMENT("Unable to write split FERAT proof\n");
+        return false;
+    }
+
+    FERATIndex const *const index = &result->index;
+    if (result->indexed
+        && (index->hints != result->hints || index->binary != result->binary
+            || index->max_var != result->max_var
+            || index->num_clauses != result->num_clauses
+            || index->mapping.count != counts.mapping.count
+            || index->origin.count != counts.origin.count
+            || index->expansion.count != counts.expansion.count)) {
+        ERR_COMMENT("FERAT proof does not match its index\n");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+// Author: Marcel Simader (marcel.simader@jku.at)
+// Date: 17.10.2026
+// (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+#include "common.h"
+
+#include "index.h"
+#include "parsing.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <zlib.h>
+
+#ifndef FORALL_EXP_RAT_SPLIT_INCLUDED
+#define FORALL_EXP_RAT_SPLIT_INCLUDED
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Size of the chunks in which the binary RAT part of a FERAT proof is copied.
+ */
+#define FERAT_SPLIT_CHUNK_SIZE (1 << 20)
+
+/** @brief Width of the 'p cnf ...' header placeholder, which is large enough for any
+ * 32-bit maximum variable and 64-bit number of clauses, excluding the newline.
+ */
+#define FERAT_SPLIT_HEADER_WIDTH (6 + 10 + 1 + 20)
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Types ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief The result of splitting a FERAT proof: whether the RAT part is a hinted LRAT
+ * proof, whether it is binary, the values written to the 'p cnf ...' header of the
+ * expansion, and the index of the proof if it has one.
+ */
+typedef struct FERATSplitResult {
+    bool hints, binary, indexed;
+    Variable max_var;
+    uint64_t num_clauses;
+    FERATIndex index;
+} FERATSplitResult;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Functions ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Returns the lowercase keyword of a FERAT line, which is one of 'e', 'x', 'o',
+ * 'l', and 'b', or '\0' for any other line. For the first three, @p content is set to the
+ * rest of the line after the keyword and its separating whitespace, and the lines 'l' and
+ * 'b' must not contain anything but the keyword.
+ */
+char
+ferat_line_keyword(LineBuffer const *const line, char const **const content);
+
+/** @brief Splits a FERAT proof into its CNF expansion and its RAT proof in a single
+ * pass. The 'e', 'x', and 'o' lines are streamed into @p cnf_fd, and all other lines, or
+ * everything after a 'b' line, into @p rat_fd. The 'p cnf ...' header is written as a
+ * padded placeholder before the first clause, and back-patched once the maximum variable
+ * and number of clauses are known, so both outputs must be seekable. Memory use is
+ * bounded by the longest line of the textual part.
+ *
+ * If the proof starts with an index, see FERATIndex, the split is checked against it,
+ * and @p rat_fd may be NULL, in which case reading stops at the RAT section, so that it
+ * can be read directly from the FERAT proof instead.
+ *
+ * @returns false if reading or writing failed, true otherwise
+ */
+bool
+ferat_split(gzFile ferat_fd, FILE *const cnf_fd, FILE *const rat_fd,
+            FERATSplitResult *const result);
+
+#endif
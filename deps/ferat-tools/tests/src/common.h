@@ -8,6 +8,11 @@
 #include "../../src/arraylist.h"
 #include "../../src/hashtable.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
 // This is dumb, but it's a workaround for Clangd not reporting macros in the preamble.
 static int x __attribute__((unused));
 
@@ -15,16 +20,20 @@ static int x __attribute__((unused));
 // ~~~~~~~~~~~~~~~~~~~~ Macros ~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-#define DECLARE_GZ(i)       \
-    static FILE *fout_##i;  \
-    static char *fname_##i; \
+/** @brief Size of the buffers holding the names of temporary files, see tmp_file.
+ */
+#define TMP_FILE_NAME_SIZE (32)
+
+#define DECLARE_GZ(i)                          \
+    static FILE *fout_##i;                     \
+    static char fname_##i[TMP_FILE_NAME_SIZE]; \
     static gzFile gz_##i
 
 #define TMP_WRITE(i, content)            \
-    fname_##i = tmpnam(NULL);            \
+    tmp_file(fname_##i);                 \
     fout_##i = fopen(fname_##i, "w");    \
     do {                                 \
-        fprintf(fout_##i, content);      \
+        fputs(content, fout_##i);        \
         fflush(fout_##i);                \
         gz_##i = gzopen(fname_##i, "r"); \
     } while (0)
@@ -33,7 +42,18 @@ static int x __attribute__((unused));
 
 #define GZCLOSE(i)    \
     fclose(fout_##i); \
-    gzclose(gz_##i)
+    gzclose(gz_##i);  \
+    remove(fname_##i)
+
+/** @brief Reads the file @p fd back into the character array @p buffer from its start,
+ * and terminates it.
+ */
+#define READ_BACK(fd, buffer)                                         \
+    do {                                                              \
+        rewind(fd);                                                   \
+        size_t const size = fread(buffer, 1, sizeof(buffer) - 1, fd); \
+        buffer[size] = '\0';                                          \
+    } while (0)
 
 #define ARRAYLIST_EQUAL(AT, al, expected_size, expected_arr) \
     do {                                                     \
@@ -53,4 +73,29 @@ static int x __attribute__((unused));
         }                                                                        \
     } while (0)
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~ Temporary Files ~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/** @brief Creates an empty temporary file, and writes its name into @p file_name, which
+ * holds TMP_FILE_NAME_SIZE characters.
+ */
+static inline void
+tmp_file(char *const file_name) {
+    strcpy(file_name, "/tmp/ferat_test_XXXXXX");
+    int const fd = mkstemp(file_name);
+    if (fd != -1) close(fd);
+}
+
+/** @brief Like tmp_file, but writes @p content into the temporary file.
+ */
+static inline void
+tmp_write_file(char *const file_name, char const *const content) {
+    tmp_file(file_name);
+    FILE *const file = fopen(file_name, "w");
+    if (file == NULL) return;
+    fputs(content, file);
+    fclose(file);
+}
+
 #endif
@@ -0,0 +1,131 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "../../src/batch.h"
+#include "test_runner.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// ∀1 ∃2,3. (1 v 2 v 3)
+#define QBF_FORMULA "p cnf 3 1\na 1 0\ne 2 3 0\n1 2 3 0\n"
+// {1 2} <- {2 3}^[-1]
+#define VALID_EXPANSION "c x 1 2 0 2 3 0 -1 0\nc o 1 0\np cnf 2 1\n1 2 0\n"
+// {1 2} <- {2 3}^[1], but 1 is in the clause
+#define INVALID_EXPANSION "c x 1 2 0 2 3 0 1 0\nc o 1 0\np cnf 2 1\n1 2 0\n"
+#define BROKEN_EXPANSION  "c x 1 2 0 2 3 0 -1 0\nc o 1 0\np dnf 2 1\n1 2 0\n"
+
+static char qbf_file[TMP_FILE_NAME_SIZE], valid_file[TMP_FILE_NAME_SIZE],
+    invalid_file[TMP_FILE_NAME_SIZE], broken_file[TMP_FILE_NAME_SIZE];
+static QBF *qbf;
+
+void
+before_test(void) {
+    tmp_write_file(qbf_file, QBF_FORMULA);
+    tmp_write_file(valid_file, VALID_EXPANSION);
+    tmp_write_file(invalid_file, INVALID_EXPANSION);
+    tmp_write_file(broken_file, BROKEN_EXPANSION);
+    qbf = ferat_load_qbf(qbf_file, false, NULL, true);
+}
+
+void
+after_test(void) {
+    qbf_free(qbf);
+    unlink(qbf_file);
+    unlink(valid_file);
+    unlink(invalid_file);
+    unlink(broken_file);
+}
+
+int
+test_isolated() {
+    assert(qbf != NULL);
+    asserteq(EXIT_VERIFIED, ferat_check_isolated(qbf, valid_file, -1));
+    asserteq(EXIT_NOT_VERIFIED, ferat_check_isolated(qbf, invalid_file, -1));
+    asserteq(EXIT_PARSING_FAILURE, ferat_check_isolated(qbf, broken_file, -1));
+    asserteq(EXIT_FAILURE, ferat_check_isolated(qbf, "/nonexistent.cnf", -1));
+    // Failed checks leave the shared QBF intact
+    asserteq(EXIT_VERIFIED, ferat_check_isolated(qbf, valid_file, -1));
+    pass();
+}
+
+int
+test_many() {
+    char const *const all_valid[] = { valid_file, valid_file };
+    asserteq(EXIT_VERIFIED, ferat_check_many(qbf, all_valid, 2));
+    char const *const some_invalid[] = { valid_file, broken_file, valid_file };
+    asserteq(EXIT_NOT_VERIFIED, ferat_check_many(qbf, some_invalid, 3));
+    pass();
+}
+
+/** @brief Connects to the server on @p socket_path, retrying until it listens.
+ */
+static int
+connect_client(char const *const socket_path) {
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    strcpy(address.sun_path, socket_path);
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0) return fd;
+        close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+/** @brief Reads the reply of the server until the result line of the next check, and
+ * stores that line in @p result.
+ */
+static bool
+read_result(FILE *const replies, char *const result, size_t size) {
+    size_t const prefix_length = strlen(FERAT_BATCH_RESULT_PREFIX);
+    while (fgets(result, size, replies) != NULL)
+        if (!strncmp(result, FERAT_BATCH_RESULT_PREFIX, prefix_length)) return true;
+    return false;
+}
+
+int
+test_serve() {
+    char socket_path[64], result[256], expected[256];
+    snprintf(socket_path, sizeof(socket_path), "/tmp/test_batch_%d.sock", getpid());
+    FLUSH();
+    pid_t const pid = fork();
+    if (pid == 0) exit(ferat_serve(qbf, socket_path));
+
+    int const fd = connect_client(socket_path);
+    assert(fd != -1);
+    FILE *const replies = fdopen(dup(fd), "r");
+    dprintf(fd, "%s\n\n%s\n", valid_file, invalid_file);
+    assert(read_result(replies, result, sizeof(result)));
+    snprintf(expected, sizeof(expected), FERAT_BATCH_RESULT_PREFIX "%d %s\n",
+             EXIT_VERIFIED, valid_file);
+    assertstreq(expected, result);
+    assert(read_result(replies, result, sizeof(result)));
+    snprintf(expected, sizeof(expected), FERAT_BATCH_RESULT_PREFIX "%d %s\n",
+             EXIT_NOT_VERIFIED, invalid_file);
+    assertstreq(expected, result);
+    dprintf(fd, FERAT_BATCH_SHUTDOWN "\n");
+    fclose(replies);
+    close(fd);
+
+    int wstatus;
+    asserteq(pid, waitpid(pid, &wstatus, 0));
+    assert(WIFEXITED(wstatus));
+    asserteq(EXIT_SUCCESS, WEXITSTATUS(wstatus));
+    asserteq(-1, access(socket_path, F_OK));
+    pass();
+}
+
+int
+main(void) {
+    addtest(test_isolated, "Isolated Checks");
+    addtest(test_many, "Many Expansions");
+    addtest(test_serve, "Server");
+    addbefore(before_test);
+    addafter(after_test);
+    runtests("Batch Checks");
+}
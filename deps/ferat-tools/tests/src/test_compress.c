@@ -0,0 +1,129 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "../../src/compress.h"
+#include "test_runner.h"
+
+#include <sys/stat.h>
+
+// Spans a few gzip blocks, and ends in the middle of one
+#define DATA_SIZE (3 * FERAT_GZIP_BLOCK_SIZE + 12345)
+
+static char file_name[TMP_FILE_NAME_SIZE];
+static char *data, *read_back;
+
+void
+before_test(void) {
+    tmp_file(file_name);
+    data = malloc(DATA_SIZE);
+    read_back = malloc(DATA_SIZE + 1);
+    // Compressible, but not trivially so
+    for (size_t i = 0; i < DATA_SIZE; ++i) data[i] = "0123456789 -\n"[(i * i / 7) % 13];
+}
+
+void
+after_test(void) {
+    unlink(file_name);
+    free(data);
+    free(read_back);
+}
+
+/** @brief Writes @p size bytes of the test data in uneven chunks with @p compression.
+ */
+bool
+write_data(FERATCompression compression, unsigned int num_threads, size_t size) {
+    FERATWriter *const writer = ferat_writer_open(file_name, compression, num_threads);
+    if (writer == NULL) return false;
+    bool ok = true;
+    for (size_t offset = 0, chunk = 1; ok && offset < size; offset += chunk, chunk *= 3) {
+        if (chunk > size - offset) chunk = size - offset;
+        ok = ferat_writer_write(writer, data + offset, chunk);
+    }
+    return ferat_writer_close(writer) && ok;
+}
+
+/** @brief Reads back everything through ferat_reader_open.
+ *
+ * @returns the number of bytes read, or -1 on errors
+ */
+long
+read_data(void) {
+    pid_t decompressor;
+    gzFile fd = ferat_reader_open(file_name, &decompressor);
+    if (fd == Z_NULL) return -1;
+    long size = 0;
+    int chunk;
+    while ((chunk = gzread(fd, read_back + size, DATA_SIZE + 1 - size)) > 0) size += chunk;
+    if (!ferat_reader_close(fd, decompressor) || chunk < 0) return -1;
+    return size;
+}
+
+int
+test_names() {
+    FERATCompression compression;
+    assert(ferat_compression_from_name("zstd", &compression));
+    asserteq(FERAT_COMPRESSION_ZSTD, compression);
+    assert(ferat_compression_from_name("none", &compression));
+    asserteq(FERAT_COMPRESSION_NONE, compression);
+    assertn(ferat_compression_from_name("bz2", &compression));
+    asserteq(FERAT_COMPRESSION_GZIP, ferat_compression_from_suffix("a.ferat.gz"));
+    asserteq(FERAT_COMPRESSION_ZSTD, ferat_compression_from_suffix("a.ferat.zst"));
+    asserteq(FERAT_COMPRESSION_XZ, ferat_compression_from_suffix("a.ferat.xz"));
+    asserteq(FERAT_COMPRESSION_NONE, ferat_compression_from_suffix("a.ferat"));
+    asserteq(FERAT_COMPRESSION_NONE, ferat_compression_from_suffix("gz"));
+    pass();
+}
+
+int
+test_gzip() {
+    for (unsigned int num_threads = 1; num_threads <= 3; ++num_threads) {
+        assert(write_data(FERAT_COMPRESSION_GZIP, num_threads, DATA_SIZE));
+        asserteq(DATA_SIZE, read_data());
+        assert(!memcmp(data, read_back, DATA_SIZE));
+    }
+    // Plain zlib reads the gzip members back as one stream
+    gzFile fd = gzopen(file_name, "rb");
+    assertn(gzdirect(fd));
+    asserteq(DATA_SIZE, gzread(fd, read_back, DATA_SIZE + 1));
+    gzclose(fd);
+    pass();
+}
+
+int
+test_gzip_empty() {
+    assert(write_data(FERAT_COMPRESSION_GZIP, 2, 0));
+    struct stat stat_buf;
+    assert(stat(file_name, &stat_buf) == 0);
+    assert(stat_buf.st_size > 0);
+    asserteq(0, read_data());
+    pass();
+}
+
+int
+test_tools() {
+    assert(write_data(FERAT_COMPRESSION_ZSTD, 2, DATA_SIZE));
+    asserteq(DATA_SIZE, read_data());
+    assert(!memcmp(data, read_back, DATA_SIZE));
+    assert(write_data(FERAT_COMPRESSION_XZ, 2, DATA_SIZE / 8));
+    asserteq(DATA_SIZE / 8, read_data());
+    assert(!memcmp(data, read_back, DATA_SIZE / 8));
+
+    // A broken file makes the decompressor, and with it the reader, fail
+    assert(truncate(file_name, 64) == 0);
+    asserteq(-1, read_data());
+    pass();
+}
+
+int
+main(void) {
+    addtest(test_names, "Format Names");
+    addtest(test_gzip, "Parallel Gzip");
+    addtest(test_gzip_empty, "Empty Gzip");
+    addtest(test_tools, "Zstd and Xz");
+    addbefore(before_test);
+    addafter(after_test);
+    runtests("Compression");
+}
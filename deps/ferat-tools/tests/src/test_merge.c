@@ -0,0 +1,150 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "../../src/merge.h"
+#include "../../src/split.h"
+#include "test_runner.h"
+
+#define MAX_MERGE_OUTPUT_SIZE (1024)
+DECLARE_GZ(cnf_);
+DECLARE_GZ(rat_);
+static char ferat_file_name[TMP_FILE_NAME_SIZE];
+static char ferat[MAX_MERGE_OUTPUT_SIZE];
+static bool merge_ok;
+
+#define MERGE(cnf_content, rat_content, ...)                                        \
+    do {                                                                            \
+        TMP_WRITE(cnf_, cnf_content);                                               \
+        TMP_WRITE(rat_, rat_content);                                               \
+        tmp_file(ferat_file_name);                                                  \
+        FERATMergeOptions const options = { __VA_ARGS__ };                          \
+        merge_ok = ferat_merge(fname_cnf_, fname_rat_, ferat_file_name, &options);  \
+        gzFile ferat_fd = gzopen(ferat_file_name, "rb");                            \
+        int const size = gzread(ferat_fd, ferat, sizeof(ferat) - 1);                \
+        ferat[size < 0 ? 0 : size] = '\0';                                          \
+        gzclose(ferat_fd);                                                          \
+    } while (0)
+
+void
+after_test(void) {
+    GZCLOSE(cnf_);
+    GZCLOSE(rat_);
+    remove(ferat_file_name);
+}
+
+int
+test_text() {
+    MERGE("c x 1 2 0 4 5 0 1 0\nc o 1 2 0\np cnf 3 2\n1 2 0\n\n-3 -2 0\n",
+          "1 2 0\nd 1 2 0\n0\n", .hints = false);
+    assert(merge_ok);
+    assertstreq("x 1 2 0 4 5 0 1 0\no 1 2 0\ne 1 2 0\ne -3 -2 0\n1 2 0\nd 1 2 0\n0\n",
+                ferat);
+
+    // Plain comments are kept, and a missing final newline is added
+    after_test();
+    MERGE("c generated\nc x 7 0 1 0 0\np cnf 7 1\n2 -7 0", "0\n", .hints = false);
+    assert(merge_ok);
+    assertstreq("c generated\nx 7 0 1 0 0\ne 2 -7 0\n0\n", ferat);
+    pass();
+}
+
+int
+test_markers() {
+    MERGE("c x 1 0 1 0 0\np cnf 1 1\n1 0\n", "a\x02\x03", .hints = true, .binary = true);
+    assert(merge_ok);
+    assertstreq("l\nx 1 0 1 0 0\ne 1 0\nb\na\x02\x03", ferat);
+    pass();
+}
+
+int
+test_compressed() {
+    MERGE("c x 1 0 1 0 0\np cnf 1 1\n1 0\n", "2 0 1 0\n", .hints = true,
+          .compression = FERAT_COMPRESSION_GZIP);
+    assert(merge_ok);
+    assertstreq("l\nx 1 0 1 0 0\ne 1 0\n2 0 1 0\n", ferat);
+
+    // The gzipped proof splits back into the same parts
+    FILE *const cnf_fd = tmpfile(), *const rat_fd = tmpfile();
+    gzFile ferat_fd = gzopen(ferat_file_name, "rb");
+    FERATSplitResult result;
+    assert(ferat_split(ferat_fd, cnf_fd, rat_fd, &result));
+    gzclose(ferat_fd);
+    fclose(cnf_fd);
+    fclose(rat_fd);
+    assert(result.hints);
+    assertn(result.binary);
+    asserteq(1, result.max_var);
+    asserteq(1, result.num_clauses);
+    pass();
+}
+
+int
+test_indexed() {
+    MERGE("c x 1 2 0 4 5 0 1 0\nc o 1 2 0\np cnf 3 2\n1 2 0\n-3 -2 0\n",
+          "1 2 0\nd 1 2 0\n0\n", .index = true);
+    assert(merge_ok);
+    FERATIndex index;
+    assert(ferat_index_parse(ferat, FERAT_INDEX_WIDTH + 1, &index));
+    char *const body = ferat + FERAT_INDEX_WIDTH + 1;
+    assertstreq("x 1 2 0 4 5 0 1 0\no 1 2 0\ne 1 2 0\ne -3 -2 0\n1 2 0\nd 1 2 0\n0\n",
+                body);
+    assertn(index.hints);
+    assertn(index.binary);
+    asserteq(3, index.max_var);
+    asserteq(2, index.num_clauses);
+    asserteq(1, index.mapping.count);
+    assert(!strncmp("x 1 2 0 4 5 0 1 0\n", ferat + index.mapping.offset,
+                    index.mapping.size));
+    asserteq(1, index.origin.count);
+    assert(!strncmp("o 1 2 0\n", ferat + index.origin.offset, index.origin.size));
+    asserteq(2, index.expansion.count);
+    assert(!strncmp("e 1 2 0\ne -3 -2 0\n", ferat + index.expansion.offset,
+                    index.expansion.size));
+    assertstreq("1 2 0\nd 1 2 0\n0\n", ferat + index.rat.offset);
+    asserteq(strlen(ferat), index.rat.offset + index.rat.size);
+
+    // The RAT proof can be skipped when splitting, since it is read by offset instead
+    FILE *const cnf_fd = tmpfile();
+    gzFile ferat_fd = gzopen(ferat_file_name, "rb");
+    FERATSplitResult result;
+    assert(ferat_split(ferat_fd, cnf_fd, NULL, &result));
+    gzclose(ferat_fd);
+    fclose(cnf_fd);
+    assert(result.indexed);
+    asserteq(3, result.max_var);
+    asserteq(2, result.num_clauses);
+    asserteq(index.rat.offset, result.index.rat.offset);
+
+    // The RAT section of binary proofs starts after the marker
+    after_test();
+    MERGE("c x 1 0 1 0 0\np cnf 1 1\n1 0\n", "a\x02\x03", .hints = true, .binary = true,
+          .index = true);
+    assert(merge_ok);
+    assert(ferat_index_parse(ferat, FERAT_INDEX_WIDTH + 1, &index));
+    assert(index.hints);
+    assert(index.binary);
+    assertstreq("l\nx 1 0 1 0 0\ne 1 0\nb\na\x02\x03", ferat + FERAT_INDEX_WIDTH + 1);
+    assertstreq("a\x02\x03", ferat + index.rat.offset);
+    asserteq(3, index.rat.size);
+
+    // Compressed proofs are never indexed
+    after_test();
+    MERGE("c x 1 0 1 0 0\np cnf 1 1\n1 0\n", "0\n", .compression = FERAT_COMPRESSION_GZIP,
+          .index = true);
+    assert(merge_ok);
+    assertstreq("x 1 0 1 0 0\ne 1 0\n0\n", ferat);
+    pass();
+}
+
+int
+main(void) {
+    addtest(test_text, "Text RAT Proof");
+    addtest(test_markers, "Hints and Binary Markers");
+    addtest(test_compressed, "Compressed FERAT Proof");
+    addtest(test_indexed, "Indexed FERAT Proof");
+    addafter(after_test);
+    runtests("FERAT Proof Merging");
+}
@@ -0,0 +1,106 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "../../src/proof.h"
+#include "test_runner.h"
+
+#define MAX_PROOF_OUTPUT_SIZE (1024)
+DECLARE_GZ(ferat_);
+static char preamble[MAX_PROOF_OUTPUT_SIZE], rat[MAX_PROOF_OUTPUT_SIZE];
+static FERATProof proof;
+static bool read_ok;
+
+#define READ_PROOF(ferat_proof)                                      \
+    do {                                                             \
+        TMP_WRITE(ferat_, ferat_proof);                              \
+        read_ok = ferat_proof_read(NULL, GZ(ferat_), &proof);        \
+        if (read_ok) READ_BACK(proof.preamble, preamble);            \
+        if (read_ok) READ_BACK(proof.rat, rat);                      \
+    } while (0)
+
+void
+after_test(void) {
+    GZCLOSE(ferat_);
+    ferat_proof_free(&proof);
+}
+
+/** @brief Compares the literals of the ClauseArena of the proof against the
+ * @p expected_size literals in @p expected.
+ */
+int
+compare_arena(size_t expected_size, int32_t const *const expected) {
+    asserteq(expected_size, proof.clauses.size);
+    for (size_t i = 0; i < expected_size; ++i)
+        asserteq(expected[i], proof.clauses.lits[i]);
+    pass();
+}
+
+int
+test_text() {
+    READ_PROOF("x 1 2 0 4 5 0 1 0\no 1 2 0\ne 1 2 0\ne -3 -2 0\n1 2 0\nd 1 2 0\n0\n");
+    assert(read_ok);
+    assertn(proof.hints);
+    assertn(proof.binary);
+    asserteq(3, proof.max_var);
+    asserteq(2, proof.clauses.num_clauses);
+    if (compare_arena(6, (int32_t[]){ 1, 2, 0, -3, -2, 0 })) fail();
+    assertstreq("c x 1 2 0 4 5 0 1 0\nc o 1 2 0\np cnf 3 2\n", preamble);
+    assertstreq("1 2 0\nd 1 2 0\n0\n", rat);
+    after_test();
+
+    // Leading whitespace, upper case keywords, and missing final newline
+    READ_PROOF("  X 7 0 1 0 0\nE  2 -7 0\nc comment\n 0");
+    assert(read_ok);
+    asserteq(7, proof.max_var);
+    if (compare_arena(3, (int32_t[]){ 2, -7, 0 })) fail();
+    assertstreq("c x 7 0 1 0 0\np cnf 7 1\n", preamble);
+    assertstreq("c comment\n 0", rat);
+    pass();
+}
+
+int
+test_hints_binary() {
+    READ_PROOF("l\nx 1 0 1 0 0\ne 1 0\nc dropped\nb\na\x02\x03\x01" "e 1 0\n");
+    assert(read_ok);
+    assert(proof.hints);
+    assert(proof.binary);
+    if (compare_arena(2, (int32_t[]){ 1, 0 })) fail();
+    assertstreq("c x 1 0 1 0 0\np cnf 1 1\n", preamble);
+    // Everything after the marker is copied as is, even if it looks like text
+    assertstreq("a\x02\x03\x01" "e 1 0\n", rat);
+    pass();
+}
+
+int
+test_malformed() {
+    READ_PROOF("x 1 0 1 0 0\ne 1 x 0\n0\n");
+    assertn(read_ok);
+    after_test();
+
+    // Every clause ends in 0
+    READ_PROOF("x 1 0 1 0 0\ne 1 -1\n0\n");
+    assertn(read_ok);
+    after_test();
+
+    // An index which does not match the proof is rejected
+    FERATIndex index = { .max_var = 2, .num_clauses = 1 };
+    char index_line[FERAT_INDEX_WIDTH + 2] = { 0 };
+    ferat_index_format(&index, index_line);
+    char ferat[MAX_PROOF_OUTPUT_SIZE];
+    snprintf(ferat, sizeof(ferat), "%sx 1 0 1 0 0\ne 1 0\n0\n", index_line);
+    READ_PROOF(ferat);
+    assertn(read_ok);
+    pass();
+}
+
+int
+main(void) {
+    addtest(test_text, "Text RAT Proof");
+    addtest(test_hints_binary, "Binary LRAT Proof");
+    addtest(test_malformed, "Malformed Proofs");
+    addafter(after_test);
+    runtests("FERAT Proof Reading");
+}
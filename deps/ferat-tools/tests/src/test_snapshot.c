@@ -0,0 +1,191 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "../../src/snapshot.h"
+#include "test_runner.h"
+
+#include <sys/stat.h>
+#include <zlib.h>
+
+// ∀1 ∃2,3 ∀4 ∃5. (5 v 1 v 3) ∧ (4 v -2) ∧ (6), where 6 is free
+#define QBF_FORMULA "p cnf 6 3\na 1 0\ne 2 3 0\na 4 0\ne 5 0\n5 1 3 0\n4 -2 0\n6 0\n"
+
+DECLARE_GZ(qbf_);
+static char snapshot_file[TMP_FILE_NAME_SIZE];
+static QBF *qbf;
+static QBFSource source;
+
+void
+before_test(void) {
+    TMP_WRITE(qbf_, QBF_FORMULA);
+    qbf = qbf_new();
+    qbf_parse(GZ(qbf_), qbf, true);
+    qbf_sort_clauses_in_matrix(qbf);
+    tmp_file(snapshot_file);
+}
+
+void
+after_test(void) {
+    qbf_free(qbf);
+    unlink(snapshot_file);
+    GZCLOSE(qbf_);
+}
+
+/** @brief Compares the prefix, the per-variable mapping, and the matrix of two QBFs.
+ */
+int
+compare_qbfs(QBF *const expected, QBF *const actual) {
+    asserteq(expected->max_var, actual->max_var);
+    asserteq(expected->num_alternations, actual->num_alternations);
+    asserteq(expected->prefix->size, actual->prefix->size);
+    for (uint32_t i = 0; i < expected->prefix->size; ++i) {
+        Quantifier const *const q0 = alptr_get(expected->prefix, i);
+        Quantifier const *const q1 = alptr_get(actual->prefix, i);
+        asserteq(q0->type, q1->type);
+        asserteq(q0->ordering, q1->ordering);
+        asserteq(q0->num_vars, q1->num_vars);
+        assert(!memcmp(q0->variables, q1->variables, q0->num_vars * sizeof(Variable)));
+    }
+    for (Variable var = 0; var <= expected->max_var; ++var) {
+        Result const r0 = ht_get(expected->prefix_mapping, hash_fnv1a(var));
+        Result const r1 = ht_get(actual->prefix_mapping, hash_fnv1a(var));
+        asserteq(r0.ok, r1.ok);
+        if (r0.ok)
+            asserteq(((Quantifier *)r0.value.ptr)->ordering,
+                     ((Quantifier *)r1.value.ptr)->ordering);
+    }
+    asserteq(expected->matrix->size, actual->matrix->size);
+    for (uint32_t i = 0; i < expected->matrix->size; ++i) {
+        QBFClause const *const c0 = alptr_get(expected->matrix, i);
+        QBFClause const *const c1 = alptr_get(actual->matrix, i);
+        asserteq(c0->num_literals, c1->num_literals);
+        assert(!memcmp(c0->lits, c1->lits, c0->num_literals * sizeof(Literal)));
+    }
+    pass();
+}
+
+int
+test_round_trip() {
+    assert(qbf_snapshot_source(fname_qbf_, &source));
+    asserteq(strlen(QBF_FORMULA), source.size);
+    assert(qbf_snapshot_write(qbf, snapshot_file, &source));
+    QBF *const loaded = qbf_snapshot_load(snapshot_file, &source);
+    assert(loaded != NULL);
+    assert(loaded->snapshot != NULL);
+    if (compare_qbfs(qbf, loaded)) fail();
+    qbf_free(loaded);
+    pass();
+}
+
+int
+test_stale() {
+    assert(qbf_snapshot_source(fname_qbf_, &source));
+    assert(qbf_snapshot_write(qbf, snapshot_file, &source));
+    QBFSource other = source;
+    other.checksum ^= 1;
+    assert(qbf_snapshot_load(snapshot_file, &other) == NULL);
+    other = source;
+    other.size += 1;
+    assert(qbf_snapshot_load(snapshot_file, &other) == NULL);
+    assert(qbf_snapshot_load("/nonexistent.fqs", &source) == NULL);
+    pass();
+}
+
+int
+test_truncated() {
+    assert(qbf_snapshot_source(fname_qbf_, &source));
+    assert(qbf_snapshot_write(qbf, snapshot_file, &source));
+    struct stat stat_buf;
+    assert(stat(snapshot_file, &stat_buf) == 0);
+    assert(truncate(snapshot_file, stat_buf.st_size - 4) == 0);
+    assert(qbf_snapshot_load(snapshot_file, &source) == NULL);
+    assert(truncate(snapshot_file, 4) == 0);
+    assert(qbf_snapshot_load(snapshot_file, &source) == NULL);
+    pass();
+}
+
+/** @brief Reads the whole snapshot into @p buffer, which holds @p size bytes.
+ *
+ * @returns the size of the snapshot
+ */
+size_t
+read_snapshot(unsigned char *const buffer, size_t size) {
+    FILE *const file = fopen(snapshot_file, "rb");
+    size_t const file_size = fread(buffer, 1, size, file);
+    fclose(file);
+    return file_size;
+}
+
+/** @brief Overwrites the snapshot with the @p size bytes in @p buffer.
+ */
+void
+write_snapshot(unsigned char const *const buffer, size_t size) {
+    FILE *const file = fopen(snapshot_file, "wb");
+    fwrite(buffer, 1, size, file);
+    fclose(file);
+}
+
+int
+test_corrupt() {
+    assert(qbf_snapshot_source(fname_qbf_, &source));
+    assert(qbf_snapshot_write(qbf, snapshot_file, &source));
+    unsigned char buffer[1024];
+    size_t const size = read_snapshot(buffer, sizeof(buffer));
+    assert(size < sizeof(buffer));
+    QBFSnapshotHeader *const header = (QBFSnapshotHeader *)buffer;
+    // The last literal of the matrix, which is (6) after sorting
+    Literal *const lit = (Literal *)(buffer + size - sizeof(Literal));
+    asserteq(VAR2LIT(6, 0), *lit);
+
+    // A changed body does not match the checksum
+    *lit = VAR2LIT(5, 0);
+    write_snapshot(buffer, size);
+    assert(qbf_snapshot_load(snapshot_file, &source) == NULL);
+
+    // A variable out of range is rejected even if the checksum matches
+    *lit = VAR2LIT(7, 0);
+    header->body_checksum = (uint32_t)crc32(crc32(0L, Z_NULL, 0),
+                                            buffer + sizeof(QBFSnapshotHeader),
+                                            (uInt)(size - sizeof(QBFSnapshotHeader)));
+    write_snapshot(buffer, size);
+    assert(qbf_snapshot_load(snapshot_file, &source) == NULL);
+
+    // The unchanged snapshot loads again
+    *lit = VAR2LIT(6, 0);
+    header->body_checksum = (uint32_t)crc32(crc32(0L, Z_NULL, 0),
+                                            buffer + sizeof(QBFSnapshotHeader),
+                                            (uInt)(size - sizeof(QBFSnapshotHeader)));
+    write_snapshot(buffer, size);
+    QBF *const loaded = qbf_snapshot_load(snapshot_file, &source);
+    assert(loaded != NULL);
+    qbf_free(loaded);
+    pass();
+}
+
+int
+test_file_name() {
+    char buffer[64];
+    source.checksum = 0xbeef;
+    assert(qbf_snapshot_file_name("dir/f.qdimacs", NULL, &source, buffer, sizeof(buffer)));
+    assertstreq("dir/f.qdimacs" QBF_SNAPSHOT_SUFFIX, buffer);
+    assert(qbf_snapshot_file_name("dir/f.qdimacs", "snaps", &source, buffer,
+                                  sizeof(buffer)));
+    assertstreq("snaps/f.qdimacs.0000beef" QBF_SNAPSHOT_SUFFIX, buffer);
+    assertn(qbf_snapshot_file_name("dir/f.qdimacs", "snaps", &source, buffer, 8));
+    pass();
+}
+
+int
+main(void) {
+    addtest(test_round_trip, "Round Trip");
+    addtest(test_stale, "Stale Snapshot");
+    addtest(test_truncated, "Truncated Snapshot");
+    addtest(test_corrupt, "Corrupt Snapshot");
+    addtest(test_file_name, "File Names");
+    addbefore(before_test);
+    addafter(after_test);
+    runtests("QBF Snapshots");
+}
@@ -0,0 +1,134 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "common.h"
+
+#include "../../src/split.h"
+#include "test_runner.h"
+
+#define MAX_SPLIT_OUTPUT_SIZE (1024)
+DECLARE_GZ(ferat_);
+static FILE *cnf_fd, *rat_fd;
+static char cnf[MAX_SPLIT_OUTPUT_SIZE], rat[MAX_SPLIT_OUTPUT_SIZE];
+static FERATSplitResult result;
+static bool split_ok;
+
+#define SPLIT(ferat_proof)                                           \
+    do {                                                             \
+        TMP_WRITE(ferat_, ferat_proof);                              \
+        cnf_fd = tmpfile();                                          \
+        rat_fd = tmpfile();                                          \
+        split_ok = ferat_split(GZ(ferat_), cnf_fd, rat_fd, &result); \
+        READ_BACK(cnf_fd, cnf);                                      \
+        READ_BACK(rat_fd, rat);                                      \
+    } while (0)
+
+void
+after_test(void) {
+    GZCLOSE(ferat_);
+    fclose(cnf_fd);
+    fclose(rat_fd);
+}
+
+/** @brief Compares the split CNF expansion against the lines @p before, the 'p cnf ...'
+ * header @p p_line padded as done by ferat_split, and the lines @p after.
+ */
+int
+compare_cnf(char const *const p_line, char const *const before, char const *const after) {
+    char expected[MAX_SPLIT_OUTPUT_SIZE];
+    snprintf(expected, sizeof(expected), "%s%s%*s\n%s", before, p_line,
+             (int)(FERAT_SPLIT_HEADER_WIDTH - strlen(p_line)), "", after);
+    assertstreq(expected, cnf);
+    pass();
+}
+
+int
+test_text() {
+    SPLIT("x 1 2 0 4 5 0 1 0\no 1 2 0\ne 1 2 0\ne -3 -2 0\n1 2 0\nd 1 2 0\n0\n");
+    assert(split_ok);
+    assertn(result.hints);
+    assertn(result.binary);
+    asserteq(3, result.max_var);
+    asserteq(2, result.num_clauses);
+    if (compare_cnf("p cnf 3 2", "c x 1 2 0 4 5 0 1 0\nc o 1 2 0\n", "1 2 0\n-3 -2 0\n"))
+        fail();
+    assertstreq("1 2 0\nd 1 2 0\n0\n", rat);
+    after_test();
+
+    // Leading whitespace, upper case keywords, and missing final newline
+    SPLIT("  X 7 0 1 0 0\nE  2 -7 0\nc comment\n 0");
+    assert(split_ok);
+    asserteq(7, result.max_var);
+    asserteq(1, result.num_clauses);
+    if (compare_cnf("p cnf 7 1", "c x 7 0 1 0 0\n", "2 -7 0\n")) fail();
+    assertstreq("c comment\n 0", rat);
+    pass();
+}
+
+int
+test_no_clauses() {
+    SPLIT("x 1 0 1 0 0\no 1 0\n0\n");
+    assert(split_ok);
+    asserteq(1, result.max_var);
+    asserteq(0, result.num_clauses);
+    if (compare_cnf("p cnf 1 0", "c x 1 0 1 0 0\nc o 1 0\n", "")) fail();
+    assertstreq("0\n", rat);
+    pass();
+}
+
+int
+test_hints() {
+    SPLIT("l\nx 1 0 1 0 0\ne 1 0\n2 -1 0 1 0\n");
+    assert(split_ok);
+    assert(result.hints);
+    assertn(result.binary);
+    if (compare_cnf("p cnf 1 1", "c x 1 0 1 0 0\n", "1 0\n")) fail();
+    assertstreq("2 -1 0 1 0\n", rat);
+    pass();
+}
+
+int
+test_binary() {
+    SPLIT("l\nx 1 0 1 0 0\ne 1 0\nc dropped\nb\na\x02\x03\x01" "e 1 0\n");
+    assert(split_ok);
+    assert(result.hints);
+    assert(result.binary);
+    if (compare_cnf("p cnf 1 1", "c x 1 0 1 0 0\n", "1 0\n")) fail();
+    // Everything after the marker is copied as is, even if it looks like text
+    assertstreq("a\x02\x03\x01" "e 1 0\n", rat);
+    pass();
+}
+
+int
+test_index() {
+    // Without an index, the RAT proof cannot be skipped
+    TMP_WRITE(ferat_, "x 1 0 1 0 0\ne 1 0\n0\n");
+    cnf_fd = tmpfile();
+    rat_fd = tmpfile();
+    assertn(ferat_split(GZ(ferat_), cnf_fd, NULL, &result));
+    after_test();
+
+    // An index which does not match the proof is rejected
+    FERATIndex index = { .max_var = 2, .num_clauses = 1 };
+    char index_line[FERAT_INDEX_WIDTH + 2] = { 0 };
+    ferat_index_format(&index, index_line);
+    char proof[MAX_SPLIT_OUTPUT_SIZE];
+    snprintf(proof, sizeof(proof), "%sx 1 0 1 0 0\ne 1 0\n0\n", index_line);
+    SPLIT(proof);
+    assertn(split_ok);
+    assert(result.indexed);
+    asserteq(1, result.max_var);
+    pass();
+}
+
+int
+main(void) {
+    addtest(test_text, "Text RAT Proof");
+    addtest(test_no_clauses, "Without Clauses");
+    addtest(test_hints, "Hinted LRAT Proof");
+    addtest(test_binary, "Binary RAT Proof");
+    addtest(test_index, "Index");
+    addafter(after_test);
+    runtests("FERAT Proof Splitting");
+}
@@ -138,11 +138,23 @@ MySolver::MySolver(Prefix& pref, const CNF& cnf, const SolverOptions* options)
 
     for (unsigned i = 1; i <= layer_size_ksi_; i++)
         tuple_base_ksi_.push_back(i);
+
+    // Marcel: The layer sizes let ijtihad-bench check that it replays the
+    //         extensions on the same formula.
+    if (options_.logging_extensions) {
+        extension_log_.open(options_.extension_log, std::ofstream::out);
+        if (extension_log_.good())
+            extension_log_ << "p ijtihad " << layer_size_phi_ << " "
+                           << layer_size_ksi_ << std::endl;
+        else
+            options_.logging_extensions = false;
+    }
 }
 
 MySolver::~MySolver() {
     if (options_.logging_phi) phi_log_.close();
     if (options_.logging_ksi) ksi_log_.close();
+    if (options_.logging_extensions) extension_log_.close();
 
     delete formula_;
     ipasir_release(sat_solver_phi_);
@@ -412,6 +424,15 @@ void MySolver::printStats() {
          << endl;
     cout << "c number of layers in KSI is " << layers_ksi_.size() << endl;
     cout << "c mysolver was running for " << time_ << " seconds." << endl;
+    const std::pair<const char*, const CacheStats*> caches[] = {
+        {"variable cache of PHI", &vars_cache_phi_stats_},
+        {"variable cache of KSI", &vars_cache_ksi_stats_},
+        {"Tseitin cache", &tseitin_cache_stats_},
+        {"witness cache", &witness_cache_stats_},
+        {"counterexample cache", &counterexample_cache_stats_}};
+    for (const auto& cache : caches)
+        cout << "c " << cache.first << " had " << cache.second->hits
+             << " hits in " << cache.second->lookups << " lookups." << endl;
 }
 
 void MySolver::computeExtension(FormulaType type) {
@@ -425,6 +446,8 @@ void MySolver::computeExtension(FormulaType type) {
     vector<LitTuple>& to_add_container =
         (type == PHI) ? cex_to_add_ : wit_to_add_;
     LitTupleSet& cache = (type == PHI) ? counterexample_cache_ : witness_cache_;
+    CacheStats& cache_stats =
+        (type == PHI) ? counterexample_cache_stats_ : witness_cache_stats_;
     vector<Var>* base = (type == PHI) ? &tuple_base_ksi_ : &tuple_base_phi_;
     LitTuple2Uint candidates;
 
@@ -447,8 +470,10 @@ void MySolver::computeExtension(FormulaType type) {
 
         addition.assign(addt);
 
+        cache_stats.lookups++;
         if (cache.find(addition) != cache.end()) {
             debugn("cache worked...");
+            cache_stats.hits++;
             continue;
         }
 
@@ -464,13 +489,6 @@ void MySolver::computeExtension(FormulaType type) {
 void MySolver::extendKSI() {
     debugn("extendKSI: begin");
 
-    vector<bool> ext;
-    ext.reserve(layer_size_phi_);
-
-    LitTuple ext_key(nullptr);
-
-    LitTuple layer_clause(nullptr);
-
     bool trim_branch =
         (options_.trimming_ksi == SolverOptions::TrimmingMode::BRANCH_TRIMMING);
     if (trim_branch && independent_phi_.size() != 0 &&
@@ -500,6 +518,20 @@ void MySolver::extendKSI() {
     // restore wpc
     if (trim_branch) options_.cex_per_call = old_wpc;
 
+    logExtension(KSI);
+    addLayersKSI();
+
+    debugn("extendKSI: end");
+}
+
+void MySolver::addLayersKSI() {
+    vector<bool> ext;
+    ext.reserve(layer_size_phi_);
+
+    LitTuple ext_key(nullptr);
+
+    LitTuple layer_clause(nullptr);
+
     for (auto& wit_it : wit_to_add_) {
         bool cache_possible = true;
         bool skip = false;
@@ -523,9 +555,11 @@ void MySolver::extendKSI() {
                 ext_key.rebase(&(quant_inc.second));
                 if (cache_possible) {
                     ext_key.assign(ext);
+                    vars_cache_ksi_stats_.lookups++;
                     const auto cache_iter = vars_cache_ksi_.find(ext_key);
                     if (cache_iter != vars_cache_ksi_.end()) {
                         debugn("We have a variable cache hit: ");
+                        vars_cache_ksi_stats_.hits++;
 
                         debug({
                             cout << ext_key.getHash();
@@ -616,9 +650,11 @@ void MySolver::extendKSI() {
                 layer_clause.rebase(layer_cl_var);
                 layer_clause.assign(layer_cl_sign);
 
+                tseitin_cache_stats_.lookups++;
                 const auto cache_iter = tseitin_cache_.find(layer_clause);
                 if (cache_iter != tseitin_cache_.end()) {
                     // debugn("cache worked...");
+                    tseitin_cache_stats_.hits++;
                     delete layer_cl_var;
                     global_nand.push_back(cache_iter->second);
                     continue;
@@ -649,12 +685,11 @@ void MySolver::extendKSI() {
     }
 
     wit_to_add_.clear();
-
-    debugn("extendKSI: end");
 }
 
 unsigned long MySolver::trimPHI() {
     debugn("triming formula PHI");
+    if (options_.logging_extensions) extension_log_ << "trim phi" << std::endl;
     ipasir_release(sat_solver_phi_);
     sat_solver_phi_ = ipasir_init();
 
@@ -680,6 +715,7 @@ unsigned long MySolver::trimPHI() {
 
 unsigned long MySolver::trimKSI() {
     debugn("triming formula KSI");
+    if (options_.logging_extensions) extension_log_ << "trim ksi" << std::endl;
     ipasir_release(sat_solver_ksi_);
     sat_solver_ksi_ = ipasir_init();
 
@@ -703,13 +739,6 @@ unsigned long MySolver::trimKSI() {
 void MySolver::extendPHI() {
     debugn("extendPHI: begin");
 
-    vector<bool> uni;
-    uni.reserve(layer_size_ksi_);
-
-    vector<vector<Lit>*> pending_clauses;
-
-    LitTuple uni_key(nullptr);
-
     cout << "c Number of calls is: " << sat_calls_ << endl
          << "c Layers in PHI: " << layers_phi_.size() << endl
          << "c Layers in KSI: " << layers_ksi_.size() << endl;
@@ -765,6 +794,18 @@ void MySolver::extendPHI() {
         options_.cex_per_call = old_cpc;
     }
 
+    logExtension(PHI);
+    addLayersPHI();
+
+    debugn("extendPHI: end");
+}
+
+void MySolver::addLayersPHI() {
+    vector<bool> uni;
+    uni.reserve(layer_size_ksi_);
+
+    LitTuple uni_key(nullptr);
+
     for (auto& cex_it : cex_to_add_) {
         // counterexample_cache_.insert(cex_it.second);
 
@@ -803,8 +844,10 @@ void MySolver::extendPHI() {
                 uni_key.rebase(&(quant_inc.second));
                 if (cache_possible) {
                     uni_key.assign(uni);
+                    vars_cache_phi_stats_.lookups++;
                     const auto cache_iter = vars_cache_phi_.find(uni_key);
                     if (cache_iter != vars_cache_phi_.end()) {
+                        vars_cache_phi_stats_.hits++;
                         deepest_match = quant_index + 1;
                         debugn("We have a variable cache hit: " << quant_index +
                                                                        1);
@@ -899,7 +942,21 @@ void MySolver::extendPHI() {
     }
 
     cex_to_add_.clear();
-    debugn("extendPHI: end");
+}
+
+void MySolver::logExtension(FormulaType type) {
+    if (!options_.logging_extensions) return;
+    const vector<LitTuple>& to_add = (type == PHI) ? cex_to_add_ : wit_to_add_;
+    // One line per layer, with a '1' for each negated variable in it
+    extension_log_ << ((type == PHI) ? "phi " : "ksi ") << to_add.size()
+                   << "\n";
+    for (const LitTuple& t : to_add) {
+        for (unsigned i = 0; i < t.size(); i++)
+            extension_log_ << (sign(t[i]) ? '1' : '0');
+        extension_log_ << "\n";
+    }
+    // ijtihad leaves through exit(), which never closes the log
+    extension_log_.flush();
 }
 
 void MySolver::addClause(void* solver, const vector<Lit>& clause) {
@@ -17,8 +17,20 @@
 
 class QuantifiedFormula;
 class QDPLL;
+class ExtensionBench;
+
+// Marcel: Counts the lookups in, and hits of, one of the caches, so that
+//         changes to their data structures can be measured.
+struct CacheStats {
+    unsigned long lookups = 0;  ///< number of lookups in the cache
+    unsigned long hits = 0;     ///< number of lookups that found an entry
+};
 
 class MySolver {
+    // Marcel: The benchmark in `bench/` replays recorded extensions on the
+    //         private expansion methods, without calling the SAT solvers.
+    friend class ExtensionBench;
+
    public:
     /**
      * Takes the prefix and cnf of the input QBF formula. After adjustments like
@@ -205,6 +217,13 @@ class MySolver {
 
     std::ofstream phi_log_;
     std::ofstream ksi_log_;
+    std::ofstream extension_log_;  ///< records the extensions of PHI and KSI
+
+    CacheStats vars_cache_phi_stats_;
+    CacheStats vars_cache_ksi_stats_;
+    CacheStats tseitin_cache_stats_;
+    CacheStats witness_cache_stats_;
+    CacheStats counterexample_cache_stats_;
 
     double time_phi_;  ///< time consumed while calling the sat solver for PHI
     double time_ksi_;  ///< time consumed while calling the sat solver for KSI
@@ -231,6 +250,26 @@ class MySolver {
      */
     void extendPHI();
 
+    /**
+     * Adds one layer to KSI for each witness in wit_to_add_, and clears it.
+     * This is the part of extendKSI() after the witnesses were computed.
+     */
+    void addLayersKSI();
+
+    /**
+     * Adds one layer to PHI for each counterexample in cex_to_add_, and clears
+     * it. This is the part of extendPHI() after the counterexamples were
+     * computed.
+     */
+    void addLayersPHI();
+
+    /**
+     * Writes the witnesses or counterexamples about to be added to the given
+     * formula to the extension log, if options_.logging_extensions is set.
+     * @param type formula which is about to be extended
+     */
+    void logExtension(FormulaType type);
+
     /**
      * Updates the values MySolver::luby_u_ and MySolver::luby_v_ according to
      * the reluctant doubling production.
@@ -434,6 +473,10 @@ class MySolver {
                             in the verifier should be used first                 \n\
                         -1  indicates that the witness from the newest expansion \n\
                             in the verifier should be used first                 \n\
+\n\
+--log_extensions=<file> Records the counterexamples and witnesses upon which the \n\
+                        formulas are expanded, and when they are trimmed, so that\n\
+                        the expansion can be replayed by ijtihad-bench.          \n\
 \n"
 
 #endif  // MYSOLVER_H
@@ -17,6 +17,7 @@ SolverOptions::SolverOptions() :
     wit_per_call(DEFAULT_WIT_PER_CALL),
     logging_phi(false),
     logging_ksi(false),
+    logging_extensions(false),
     tmp_dir("/tmp/"),
     tseitin_optimisation(DEFAULT_TSEITIN_OPTIMISATION),
     bumping(DEFAULT_BUMPING),
@@ -173,6 +174,11 @@ bool SolverOptions::parse(int argc, char** argv)
         tmp_phi_log.append(std::to_string(::getpid())).append(".txt");
         logging_ksi = true;
       }
+      else if(option == "--log_extensions" && eq != std::string::npos)
+      {
+        extension_log = vals;
+        logging_extensions = true;
+      }
       else if (option == "--trimming_interval"  && eq != std::string::npos)
       {
         if(vall > 5)
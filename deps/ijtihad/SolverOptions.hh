@@ -65,6 +65,9 @@ public:
   std::string ksi_log;
   std::string tmp_ksi_log;
 
+  bool logging_extensions;          ///< Whether extensions are recorded for ijtihad-bench
+  std::string extension_log;
+
   std::string tmp_dir;
 
   bool tseitin_optimisation;
@@ -0,0 +1,401 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+// Replays the extensions of PHI and KSI, as recorded by `--log_extensions`,
+// or random ones, on MySolver with the stub IPASIR backend. This measures the
+// expansion itself, i.e. the layers per second, the allocations per layer, and
+// the hit rates of the caches, without the noise of the SAT solvers.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "../MySolver.hh"
+#include "../ReadException.hh"
+#include "../ReadQ.hh"
+#include "ipasir-stub.hh"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+
+#define USAGE                                                              \
+    " [--repeat=<N>] [--layers=<N>] [--seed=<N>] [--output=<JSON>] <QBF> " \
+    "[<Extensions>]\n"                                                     \
+    "\n"                                                                   \
+    "Replays the extensions recorded by 'ijtihad --log_extensions=<file>'\n" \
+    "on <QBF> <N> times, or <N> random layers for each of PHI and KSI if\n" \
+    "no <Extensions> are given, and writes the median results to <JSON>,\n" \
+    "or standard output.\n"
+
+// ~~~~~~~~~~~~~~~~~~~~ Allocation Counting ~~~~~~~~~~~~~~~~~~~~
+
+static unsigned long num_allocations = 0;
+
+void* operator new(std::size_t size) {
+    num_allocations++;
+    void* const ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// ~~~~~~~~~~~~~~~~~~~~ Extensions ~~~~~~~~~~~~~~~~~~~~
+
+/**
+ * One recorded extension of a formula by some layers, or its trimming.
+ */
+struct Extension {
+    FormulaType type;
+    bool trim;
+    vector<vector<bool>> layers;
+};
+
+/**
+ * What the extensions of one formula cost in total.
+ */
+struct FormulaStats {
+    unsigned long layers = 0;
+    unsigned long allocations = 0;
+    double seconds = 0.0;
+    StubSolver clauses;
+    CacheStats vars_cache;
+    CacheStats tseitin_cache;
+};
+
+static inline double seconds_since(
+    std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+/**
+ * Reads the extensions recorded by MySolver::logExtension().
+ * @return false if the file is not a valid record for the given layer sizes
+ */
+static bool read_extensions(const string& file_name, unsigned layer_size_phi,
+                            unsigned layer_size_ksi,
+                            vector<Extension>& extensions) {
+    std::ifstream file(file_name);
+    string word, bits;
+    unsigned size_phi, size_ksi;
+    if (!(file >> word) || word != "p" || !(file >> word) ||
+        word != "ijtihad" || !(file >> size_phi >> size_ksi)) {
+        cerr << "Expected 'p ijtihad <PHI> <KSI>' in " << file_name << endl;
+        return false;
+    }
+    if (size_phi != layer_size_phi || size_ksi != layer_size_ksi) {
+        cerr << "Extensions of layers of size " << size_phi << " and "
+             << size_ksi << " do not match the QBF's " << layer_size_phi
+             << " and " << layer_size_ksi << endl;
+        return false;
+    }
+    while (file >> word) {
+        Extension ext;
+        if (word == "trim") {
+            file >> word;
+            ext.trim = true;
+        } else {
+            ext.trim = false;
+        }
+        if (word != "phi" && word != "ksi") {
+            cerr << "Unexpected '" << word << "' in " << file_name << endl;
+            return false;
+        }
+        ext.type = (word == "phi") ? PHI : KSI;
+        // PHI is extended by counterexamples, which assign KSI's variables
+        const unsigned size = (ext.type == PHI) ? size_ksi : size_phi;
+        unsigned long num_layers = 0;
+        if (!ext.trim && !(file >> num_layers)) return false;
+        for (unsigned long i = 0; i < num_layers; i++) {
+            if (!(file >> bits) || bits.size() != size) {
+                cerr << "Expected a layer of size " << size << " in "
+                     << file_name << endl;
+                return false;
+            }
+            vector<bool> layer(size);
+            for (unsigned j = 0; j < size; j++) layer[j] = (bits[j] == '1');
+            ext.layers.push_back(layer);
+        }
+        extensions.push_back(ext);
+    }
+    return true;
+}
+
+/**
+ * Alternately extends PHI and KSI by one random layer each.
+ */
+static void random_extensions(unsigned layer_size_phi, unsigned layer_size_ksi,
+                              unsigned long num_layers, unsigned long seed,
+                              vector<Extension>& extensions) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> r(0, 1);
+    for (unsigned long i = 0; i < 2 * num_layers; i++) {
+        const FormulaType type = (i % 2 == 0) ? PHI : KSI;
+        vector<bool> layer((type == PHI) ? layer_size_ksi : layer_size_phi);
+        for (unsigned j = 0; j < layer.size(); j++) layer[j] = bool(r(gen));
+        extensions.push_back(Extension{type, false, {layer}});
+    }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~ Benchmark ~~~~~~~~~~~~~~~~~~~~
+
+class ExtensionBench {
+   public:
+    explicit ExtensionBench(MySolver& solver) : solver_(solver) {}
+
+    inline unsigned layerSizePHI() const { return solver_.layer_size_phi_; }
+    inline unsigned layerSizeKSI() const { return solver_.layer_size_ksi_; }
+
+    /**
+     * Adds the layers of the extension to its formula the way extendPHI() and
+     * extendKSI() would, or trims it, and times only the former.
+     */
+    void replay(const Extension& ext, FormulaStats& stats) {
+        if (ext.trim) {
+            collectClauses(ext.type, stats);
+            if (ext.type == PHI)
+                solver_.options_.cex_per_call = solver_.trimPHI();
+            else
+                solver_.options_.wit_per_call = solver_.trimKSI();
+            return;
+        }
+        vector<LitTuple>& to_add =
+            (ext.type == PHI) ? solver_.cex_to_add_ : solver_.wit_to_add_;
+        vector<Var>* base = (ext.type == PHI) ? &solver_.tuple_base_ksi_
+                                              : &solver_.tuple_base_phi_;
+        LitTuple addition(base);
+        for (const vector<bool>& layer : ext.layers) {
+            addition.assign(layer);
+            to_add.push_back(addition);
+        }
+
+        const unsigned long allocations = num_allocations;
+        const auto start = std::chrono::steady_clock::now();
+        if (ext.type == PHI)
+            solver_.addLayersPHI();
+        else
+            solver_.addLayersKSI();
+        stats.seconds += seconds_since(start);
+        stats.allocations += num_allocations - allocations;
+        stats.layers += ext.layers.size();
+    }
+
+    /**
+     * Adds the clauses and cache statistics of the solver to the totals.
+     */
+    void finish(FormulaStats& phi, FormulaStats& ksi) {
+        collectClauses(PHI, phi);
+        collectClauses(KSI, ksi);
+        phi.vars_cache = solver_.vars_cache_phi_stats_;
+        ksi.vars_cache = solver_.vars_cache_ksi_stats_;
+        ksi.tseitin_cache = solver_.tseitin_cache_stats_;
+    }
+
+   private:
+    MySolver& solver_;
+
+    // Trimming releases the solver, so its clauses are collected before
+    void collectClauses(FormulaType type, FormulaStats& stats) {
+        const StubSolver* const stub = static_cast<const StubSolver*>(
+            (type == PHI) ? solver_.sat_solver_phi_ : solver_.sat_solver_ksi_);
+        stats.clauses.clauses += stub->clauses;
+        stats.clauses.literals += stub->literals;
+        stats.clauses.checksum =
+            (stats.clauses.checksum ^ stub->checksum) * 0x100000001B3u;
+    }
+};
+
+/**
+ * Measures hashing, comparing, and looking up LitTuples of the given size.
+ */
+static void bench_lit_tuples(unsigned size, unsigned long seed,
+                             std::ostream& out) {
+    const unsigned long num_tuples = 1 << 16;
+    vector<Var> base(size);
+    for (unsigned i = 0; i < size; i++) base[i] = i + 1;
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> r(0, 1);
+    vector<vector<bool>> signs(num_tuples, vector<bool>(size));
+    for (auto& s : signs)
+        for (unsigned i = 0; i < size; i++) s[i] = bool(r(gen));
+
+    vector<LitTuple> tuples(num_tuples, LitTuple(&base));
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < num_tuples; i++) tuples[i].assign(signs[i]);
+    const double assign_s = seconds_since(start);
+
+    const vector<LitTuple> copies(tuples);
+    unsigned long equal = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned long i = 0; i < num_tuples; i++)
+        equal += (tuples[i] == copies[num_tuples - 1 - i]);
+    equal += (tuples[0] == copies[0]);
+    const double equal_s = seconds_since(start);
+
+    LitTupleSet set;
+    start = std::chrono::steady_clock::now();
+    for (const LitTuple& t : tuples) set.insert(t);
+    const double insert_s = seconds_since(start);
+    unsigned long found = 0;
+    start = std::chrono::steady_clock::now();
+    for (const LitTuple& t : copies) found += set.count(t);
+    const double find_s = seconds_since(start);
+
+    const double ns = 1e9 / (double)num_tuples;
+    out << "  \"lit_tuple\": {\"size\": " << size
+        << ", \"tuples\": " << num_tuples
+        << ", \"assign_ns\": " << assign_s * ns
+        << ", \"equal_ns\": " << equal_s * ns
+        << ", \"set_insert_ns\": " << insert_s * ns
+        << ", \"set_find_ns\": " << find_s * ns
+        << ", \"distinct\": " << set.size() << ", \"checksum\": " << equal + found
+        << "},\n";
+}
+
+static void print_cache(std::ostream& out, const char* name,
+                        const CacheStats& stats) {
+    out << ", \"" << name << "\": {\"lookups\": " << stats.lookups
+        << ", \"hits\": " << stats.hits << ", \"hit_rate\": "
+        << (stats.lookups ? (double)stats.hits / stats.lookups : 0.0) << "}";
+}
+
+/**
+ * Prints the totals of one formula, with the median time of all runs.
+ */
+static void print_formula(std::ostream& out, const char* name,
+                          const FormulaStats& stats, vector<double>& seconds,
+                          bool tseitin) {
+    std::sort(seconds.begin(), seconds.end());
+    const double median = seconds[seconds.size() / 2];
+    const double layers = stats.layers ? (double)stats.layers : 1.0;
+    out << "  \"" << name << "\": {\"layers\": " << stats.layers
+        << ", \"median_s\": " << median << ", \"min_s\": " << seconds.front()
+        << ", \"max_s\": " << seconds.back()
+        << ", \"layers_per_s\": " << (median > 0 ? stats.layers / median : 0.0)
+        << ", \"allocations_per_layer\": " << stats.allocations / layers
+        << ", \"clauses\": " << stats.clauses.clauses
+        << ", \"literals\": " << stats.clauses.literals
+        << ", \"checksum\": \"" << std::hex << stats.clauses.checksum
+        << std::dec << "\"";
+    print_cache(out, "vars_cache", stats.vars_cache);
+    if (tseitin) print_cache(out, "tseitin_cache", stats.tseitin_cache);
+    out << "}";
+    cerr << "c " << name << ": " << stats.layers << " layers in " << median
+         << " s, " << stats.allocations / layers << " allocations per layer, "
+         << stats.vars_cache.hits << "/" << stats.vars_cache.lookups
+         << " variable cache hits" << endl;
+}
+
+int main(int argc, char** argv) {
+    unsigned long repeat = 5, num_layers = 1000, seed = 0x243F6A88;
+    string output, extensions_file;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        const string arg(argv[i]);
+        const size_t eq = arg.find('=');
+        const string value = (eq == string::npos) ? "" : arg.substr(eq + 1);
+        if (arg.rfind("--repeat=", 0) == 0)
+            repeat = std::stoul(value);
+        else if (arg.rfind("--layers=", 0) == 0)
+            num_layers = std::stoul(value);
+        else if (arg.rfind("--seed=", 0) == 0)
+            seed = std::stoul(value);
+        else if (arg.rfind("--output=", 0) == 0)
+            output = value;
+        else if (arg.rfind("--", 0) == 0 || arg == "-h") {
+            cerr << "Usage: " << argv[0] << USAGE;
+            return (arg == "--help" || arg == "-h") ? 0 : 100;
+        } else
+            files.push_back(arg);
+    }
+    if (files.empty() || files.size() > 2 || repeat == 0) {
+        cerr << "Usage: " << argv[0] << USAGE;
+        return 100;
+    }
+    if (files.size() == 2) extensions_file = files[1];
+
+    gzFile file = gzopen(files[0].c_str(), "rb");
+    if (file == Z_NULL) {
+        cerr << "Unable to open file: " << files[0] << endl;
+        return 100;
+    }
+    Reader file_reader(file);
+    ReadQ qbf_reader(file_reader);
+    try {
+        qbf_reader.read();
+    } catch (ReadException& rex) {
+        cerr << rex.what() << endl;
+        return 100;
+    }
+    if (qbf_reader.get_prefix().empty()) {
+        cerr << "The QBF has no quantifiers to expand" << endl;
+        return 100;
+    }
+
+    vector<Extension> extensions;
+    FormulaStats phi, ksi;
+    vector<double> phi_seconds, ksi_seconds;
+    std::ostringstream lit_tuple_json;
+    for (unsigned long run = 0; run < repeat; run++) {
+        // The solver reports its version and options on standard output
+        std::streambuf* const cout_buf = cout.rdbuf(nullptr);
+        Prefix prefix = qbf_reader.get_prefix();
+        MySolver solver(prefix, qbf_reader.get_clauses());
+        cout.rdbuf(cout_buf);
+        cout.clear();
+
+        ExtensionBench bench(solver);
+        if (run == 0) {
+            if (!extensions_file.empty()) {
+                if (!read_extensions(extensions_file, bench.layerSizePHI(),
+                                     bench.layerSizeKSI(), extensions))
+                    return 100;
+            } else {
+                random_extensions(bench.layerSizePHI(), bench.layerSizeKSI(),
+                                  num_layers, seed, extensions);
+            }
+            bench_lit_tuples(std::max(bench.layerSizeKSI(), 1u), seed,
+                             lit_tuple_json);
+        }
+
+        phi = FormulaStats();
+        ksi = FormulaStats();
+        for (const Extension& ext : extensions)
+            bench.replay(ext, (ext.type == PHI) ? phi : ksi);
+        bench.finish(phi, ksi);
+        phi_seconds.push_back(phi.seconds);
+        ksi_seconds.push_back(ksi.seconds);
+    }
+
+    std::ofstream output_file;
+    if (!output.empty()) {
+        output_file.open(output);
+        if (!output_file.good()) {
+            cerr << "Unable to open output file: " << output << endl;
+            return 100;
+        }
+    }
+    std::ostream& out = output.empty() ? cout : output_file;
+    out << "{\"qbf\": \"" << files[0] << "\", \"extensions\": \""
+        << (extensions_file.empty() ? "random" : extensions_file)
+        << "\", \"repeat\": " << repeat << ",\n"
+        << lit_tuple_json.str();
+    print_formula(out, "phi", phi, phi_seconds, false);
+    out << ",\n";
+    print_formula(out, "ksi", ksi, ksi_seconds, true);
+    out << "\n}" << endl;
+    return 0;
+}
@@ -0,0 +1,62 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#include "ipasir-stub.hh"
+
+#include "../ipasir.hh"
+
+// A no-op IPASIR backend for ijtihad-bench, so that the expansion can be
+// measured without the noise of a real SAT solver.
+
+static const char* sig = "stub";
+
+const char* ipasir_signature() { return sig; }
+
+void* ipasir_init() { return new StubSolver(); }
+
+void ipasir_release(void* solver) { delete static_cast<StubSolver*>(solver); }
+
+void ipasir_add(void* solver, int lit) {
+    StubSolver* const stub = static_cast<StubSolver*>(solver);
+    if (lit == 0)
+        stub->clauses++;
+    else
+        stub->literals++;
+    stub->checksum = (stub->checksum ^ (uint32_t)lit) * 0x100000001B3u;
+}
+
+void ipasir_assume(void* solver, int lit) {
+    (void)solver;
+    (void)lit;
+}
+
+// Never called by the benchmark, but as if interrupted
+int ipasir_solve(void* solver) {
+    (void)solver;
+    return 0;
+}
+
+// All variables are false
+int ipasir_val(void* solver, int lit) {
+    (void)solver;
+    return (lit < 0) ? lit : -lit;
+}
+
+int ipasir_failed(void* solver, int lit) {
+    (void)solver;
+    (void)lit;
+    return 0;
+}
+
+void ipasir_set_terminate(void* solver, void* state,
+                          int (*terminate)(void* state)) {
+    (void)solver;
+    (void)state;
+    (void)terminate;
+}
+
+void ipasir_bump(void* solver, int lit) {
+    (void)solver;
+    (void)lit;
+}
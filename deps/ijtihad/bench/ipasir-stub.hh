@@ -0,0 +1,21 @@
+/* Author: Marcel Simader (marcel.simader@jku.at) */
+/* Date: 17.10.2026 */
+/* (c) Marcel Simader 2026, Johannes Kepler Universität Linz */
+
+#ifndef IPASIR_STUB_H
+#define IPASIR_STUB_H
+
+#include <cstdint>
+
+/**
+ * The state of a stub IPASIR solver, which solves nothing, but records how
+ * many clauses were added to it, and a checksum of them. Two runs that add
+ * the same clauses in the same order have the same checksum.
+ */
+struct StubSolver {
+    unsigned long clauses = 0;   ///< number of clauses added
+    unsigned long literals = 0;  ///< number of literals added, without the 0s
+    uint64_t checksum = 0xCBF29CE484222325u;  ///< FNV-1a hash of all literals and 0s
+};
+
+#endif  // IPASIR_STUB_H
@@ -16,6 +16,7 @@ static const char * usage =
 "  -f | --force    overwrite CNF alike second file with proof\n"
 "  -S | --forward  forward check all added clauses eagerly\n"
 "  -h | --help     print this command line option summary\n"
+"  -j <threads>    backward check trimmed clauses with multiple threads\n"
 #ifdef LOGGING
 "  -l | --log      print all messages including logging messages\n"
 #endif
@@ -69,6 +70,12 @@ static const char * usage =
 "allows to delete clauses eagerly and gives the chance to reduce memory\n"
 "usage substantially.\n"
 "\n"
+"Backward checking can be distributed over '<threads>' threads with '-j'.\n"
+"Each added clause is checked independently against its antecedents,\n"
+"which are only read, while deletions are already checked during parsing.\n"
+"If several clauses fail to check, the reported one may differ from the\n"
+"one reported by sequential checking.\n"
+"\n"
 "At most one of the input path names can be '-' which leads to reading\n"
 "the corresponding input from '<stdin>'.  Similarly using '-' for one\n"
 "of the output files writes to '<stdout>'.  When exactly two files are\n"
@@ -87,7 +94,9 @@ static const char * usage =
 #include <assert.h>
 #include <ctype.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -148,6 +157,10 @@ struct bool_stack {
   bool *begin, *end, *allocated;
 };
 
+struct char_stack {
+  char *begin, *end, *allocated;
+};
+
 struct int_stack {
   int *begin, *end, *allocated;
 };
@@ -216,6 +229,7 @@ static const char *notrim;
 static const char *strict;
 static const char *track;
 static int verbosity;
+static int threads = 1;
 
 static bool checking;
 static bool trimming;
@@ -226,12 +240,25 @@ static int last_clause_added_in_cnf;
 static int first_clause_added_in_proof;
 
 static struct {
-  struct char_map marks;
-  struct char_map values;
   int original;
 } variables;
 
-static struct int_stack trail;
+// The state needed to check clauses, i.e., the variable marks or values, the
+// trail and the checking statistics. It is thread local, so that parallel
+// backward checking can run one checker per thread while sharing the
+// read-only clauses, and is merged into 'statistics' when checking is done.
+
+struct checker {
+  struct char_map marks;
+  struct char_map values;
+  struct int_stack trail;
+  size_t checked, empty, resolved, assigned;
+};
+
+static _Thread_local struct checker checker;
+
+static pthread_mutex_t statistics_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t error_lock = PTHREAD_MUTEX_INITIALIZER;
 
 static struct {
   struct char_map status;
@@ -245,6 +272,7 @@ static struct {
   struct int_map used;
   struct int_map map;
   struct int_stack origins;
+  struct char_stack mappings;
 } clauses;
 
 static void die (const char *, ...) __attribute__ ((format (printf, 1, 2)));
@@ -916,11 +944,11 @@ static inline void assign_literal (int lit) {
   dbg ("assigning literal %d", lit);
   int idx = abs (lit);
   signed char value = lit < 0 ? -1 : 1;
-  signed char *v = &ACCESS (variables.values, idx);
+  signed char *v = &ACCESS (checker.values, idx);
   assert (!*v);
   *v = value;
-  PUSH (trail, lit);
-  statistics.literals.assigned++;
+  PUSH (checker.trail, lit);
+  checker.assigned++;
 }
 
 static inline void unassign_literal (int lit) {
@@ -928,7 +956,7 @@ static inline void unassign_literal (int lit) {
   assert (lit != INT_MIN);
   dbg ("unassigning literal %d", lit);
   int idx = abs (lit);
-  signed char *v = &ACCESS (variables.values, idx);
+  signed char *v = &ACCESS (checker.values, idx);
 #ifndef NDEBUG
   signed char value = lit < 0 ? -1 : 1;
   assert (*v == value);
@@ -937,9 +965,9 @@ static inline void unassign_literal (int lit) {
 }
 
 static void backtrack () {
-  for (int *t = trail.begin; t != trail.end; t++)
+  for (int *t = checker.trail.begin; t != checker.trail.end; t++)
     unassign_literal (*t);
-  CLEAR (trail);
+  CLEAR (checker.trail);
 }
 
 static inline signed char assigned_literal (int)
@@ -949,7 +977,7 @@ static inline signed char assigned_literal (int lit) {
   assert (lit);
   assert (lit != INT_MIN);
   int idx = abs (lit);
-  signed char res = ACCESS (variables.values, idx);
+  signed char res = ACCESS (checker.values, idx);
   if (lit < 0)
     res = -res;
   return res;
@@ -959,6 +987,9 @@ static void crr (int, const char *, ...)
     __attribute__ ((format (printf, 2, 3)));
 
 static void crr (int id, const char *fmt, ...) {
+  // Only the first failing thread reports its error, the lock is never
+  // released since we exit below.
+  pthread_mutex_lock (&error_lock);
   fputs ("lrat-trim: ", stderr);
   va_list ap;
   va_start (ap, fmt);
@@ -993,9 +1024,9 @@ static void crr (int id, const char *fmt, ...) {
 static void check_clause_non_strictly_by_propagation (int id, int *literals,
                                                       int *antecedents) {
   assert (!strict);
-  assert (EMPTY (trail));
+  assert (EMPTY (checker.trail));
 
-  statistics.clauses.resolved++;
+  checker.resolved++;
   for (int *l = literals, lit; (lit = *l); l++) {
     signed char value = assigned_literal (lit);
     if (value < 0) {
@@ -1018,7 +1049,7 @@ static void check_clause_non_strictly_by_propagation (int id, int *literals,
       crr (id, "checking negative RAT antecedent '%d' not supported", aid);
     int *als = ACCESS (clauses.literals, aid);
     dbgs (als, "resolving antecedent %d clause", aid);
-    statistics.clauses.resolved++;
+    checker.resolved++;
     int unit = 0;
     for (int *l = als, lit; (lit = *l); l++) {
       signed char value = assigned_literal (lit);
@@ -1044,7 +1075,7 @@ static void check_clause_non_strictly_by_propagation (int id, int *literals,
 static void check_clause_strictly_by_resolution (int id, int *literals,
                                                  int *antecedents) {
   assert (strict);
-  assert (EMPTY (trail));
+  assert (EMPTY (checker.trail));
 
   int *a = antecedents, aid;
   while ((aid = *a))
@@ -1059,12 +1090,12 @@ static void check_clause_strictly_by_resolution (int id, int *literals,
     aid = *--a;
     int *als = ACCESS (clauses.literals, aid);
     dbgs (als, "resolving antecedent %d clause", aid);
-    statistics.clauses.resolved++;
+    checker.resolved++;
     int unit = 0;
     for (int *l = als, lit; (lit = *l); l++) {
       assert (lit != INT_MIN);
       int idx = abs (lit);
-      signed char *m = &ACCESS (variables.marks, idx);
+      signed char *m = &ACCESS (checker.marks, idx);
       signed char mark = *m;
       if (!mark) {
         dbg ("marking antecedent literal '%d'", lit);
@@ -1095,7 +1126,7 @@ static void check_clause_strictly_by_resolution (int id, int *literals,
       resolvent_size--;
       assert (unit != INT_MIN);
       int idx = abs (unit);
-      signed char *m = &ACCESS (variables.marks, idx);
+      signed char *m = &ACCESS (checker.marks, idx);
       *m = 0;
     }
   }
@@ -1103,7 +1134,7 @@ static void check_clause_strictly_by_resolution (int id, int *literals,
   for (int *l = literals, lit; (lit = *l); l++) {
     assert (lit != INT_MIN);
     int idx = abs (lit);
-    signed char *m = &ACCESS (variables.marks, idx);
+    signed char *m = &ACCESS (checker.marks, idx);
     signed char mark = *m;
     if (!mark)
       crr (id, "literal '%d' not in resolvent", lit);
@@ -1123,9 +1154,9 @@ static void check_clause_strictly_by_resolution (int id, int *literals,
 }
 
 static void check_clause (int id, int *literals, int *antecedents) {
-  statistics.clauses.checked.total++;
+  checker.checked++;
   if (!*literals)
-    statistics.clauses.checked.empty++;
+    checker.empty++;
   if (strict)
     check_clause_strictly_by_resolution (id, literals, antecedents);
   else
@@ -1210,7 +1241,19 @@ static void parse_cnf () {
         ;
       if (ch == EOF)
         prr ("end-of-file in header comment");
-      else if (ch == 'o') {
+      else if (ch == 'x' && cnf.output) {
+        // Marcel: Keep the 'c x ...' expansion mapping comments, which are
+        //         copied into the trimmed CNF as they are
+        PUSH (clauses.mappings, 'c');
+        PUSH (clauses.mappings, ' ');
+        PUSH (clauses.mappings, 'x');
+        while ((ch = read_ascii ()) != '\n') {
+          if (ch == EOF)
+            prr ("end-of-file in FERAT expansion mapping comment in header");
+          PUSH (clauses.mappings, ch);
+        }
+        PUSH (clauses.mappings, '\n');
+      } else if (ch == 'o') {
         // Marcel: Make sure we never see more than one origin mapping
         //         comment
         if (found_origin)
@@ -1320,9 +1363,9 @@ static void parse_cnf () {
     prr ("not every clause has a FERAT origin mapping, got %d",
          num_clause_origins);
   if (strict)
-    ADJUST (variables.marks, header_variables);
+    ADJUST (checker.marks, header_variables);
   else
-    ADJUST (variables.values, header_variables);
+    ADJUST (checker.values, header_variables);
   ADJUST (clauses.literals, header_clauses);
   ADJUST (clauses.status, header_clauses);
   int lit = 0, parsed_clauses = 0;
@@ -2135,6 +2178,99 @@ static void trim_proof () {
   msg ("trimming proof took %.2f seconds", duration);
 }
 
+static void merge_checker_statistics () {
+  pthread_mutex_lock (&statistics_lock);
+  statistics.clauses.checked.total += checker.checked;
+  statistics.clauses.checked.empty += checker.empty;
+  statistics.clauses.resolved += checker.resolved;
+  statistics.literals.assigned += checker.assigned;
+  checker.checked = checker.empty = 0;
+  checker.resolved = checker.assigned = 0;
+  pthread_mutex_unlock (&statistics_lock);
+}
+
+static double wall_clock_time () {
+  struct timeval tv;
+  (void)gettimeofday (&tv, 0);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+// Clauses to be checked in parallel are handed out to the threads in chunks
+// of this many clauses through an atomic counter.
+
+#define size_check_chunk 1024
+
+static struct {
+  struct int_stack ids;
+  atomic_size_t next;
+  int variables;
+} parallel;
+
+static void *check_chunks (void *dummy) {
+  (void)dummy;
+  if (strict)
+    ADJUST (checker.marks, parallel.variables);
+  else
+    ADJUST (checker.values, parallel.variables);
+  const size_t size = SIZE (parallel.ids);
+  for (;;) {
+    size_t begin = atomic_fetch_add (&parallel.next, size_check_chunk);
+    if (begin >= size)
+      break;
+    size_t end = begin + size_check_chunk;
+    if (end > size)
+      end = size;
+    for (size_t i = begin; i != end; i++) {
+      int id = parallel.ids.begin[i];
+      int *l = ACCESS (clauses.literals, id);
+      int *a = ACCESS (clauses.antecedents, id);
+      check_clause (id, l, a);
+    }
+  }
+  merge_checker_statistics ();
+  if (strict)
+    RELEASE (checker.marks);
+  else
+    RELEASE (checker.values);
+  RELEASE (checker.trail);
+  return 0;
+}
+
+static void check_proof_in_parallel () {
+  double start = wall_clock_time ();
+  vrb ("starting parallel backward checking with %d threads", threads);
+
+  ZERO (parallel);
+  if (strict)
+    parallel.variables = SIZE (checker.marks) - 1;
+  else
+    parallel.variables = SIZE (checker.values) - 1;
+  atomic_init (&parallel.next, 0);
+
+  int id = first_clause_added_in_proof;
+  for (;;) {
+    if (!trimming || ACCESS (clauses.used, id))
+      PUSH (parallel.ids, id);
+    if (id++ == empty_clause)
+      break;
+  }
+
+  pthread_t *workers = malloc (threads * sizeof *workers);
+  if (!workers)
+    die ("out-of-memory allocating %d threads", threads);
+  for (int i = 0; i != threads; i++)
+    if (pthread_create (workers + i, 0, check_chunks, 0))
+      die ("could not create checking thread %d", i);
+  for (int i = 0; i != threads; i++)
+    pthread_join (workers[i], 0);
+  free (workers);
+  RELEASE (parallel.ids);
+
+  double duration = wall_clock_time () - start;
+  msg ("parallel backward checking proof took %.2f wall-clock seconds",
+       duration);
+}
+
 static void check_proof () {
 
   if (!checking || forward || !empty_clause)
@@ -2144,6 +2280,11 @@ static void check_proof () {
                        empty_clause < first_clause_added_in_proof))
     return;
 
+  if (threads > 1) {
+    check_proof_in_parallel ();
+    return;
+  }
+
   double start = process_time ();
   vrb ("starting backward checking after %.2f seconds", start);
 
@@ -2378,6 +2519,11 @@ static void write_cnf () {
   output = *write_file (cnf.output);
   msg ("writing CNF to '%s'", output.path);
 
+  // Marcel: The expansion mapping comments go first, followed by the origin
+  //         mapping comment, as expected by FERAT-tools.
+  for (const char *p = clauses.mappings.begin; p != clauses.mappings.end; p++)
+    write_ascii (*p);
+
   int id;
   // Marcel: Write the origin mapping comment, omitting those clauses that
   //         were not used, just like the code below.
@@ -2433,11 +2579,12 @@ static void release () {
   RELEASE (clauses.map);
   RELEASE (clauses.used);
   RELEASE (clauses.origins);
+  RELEASE (clauses.mappings);
   if (strict)
-    RELEASE (variables.marks);
+    RELEASE (checker.marks);
   else
-    RELEASE (variables.values);
-  RELEASE (trail);
+    RELEASE (checker.values);
+  RELEASE (checker.trail);
   release_ints_map (&clauses.literals);
   release_ints_map (&clauses.antecedents);
 #endif
@@ -2480,6 +2627,13 @@ static void options (int argc, char **argv) {
       strict = arg;
     else if (!strcmp (arg, "-t") || !strcmp (arg, "--track"))
       track = arg;
+    else if (!strcmp (arg, "-j")) {
+      if (++i == argc)
+        die ("argument to '-j' missing (try '-h')");
+      threads = atoi (argv[i]);
+      if (threads < 1)
+        die ("invalid number of threads in '-j %s'", argv[i]);
+    }
     else if (!strcmp (arg, "-v") || !strcmp (arg, "--verbose")) {
       if (verbosity <= 0)
         verbosity = 1;
@@ -2506,6 +2660,9 @@ static void options (int argc, char **argv) {
   if (size_files > 2 && notrim)
     die ("can not write to '%s' with '%s'", files[2].path, notrim);
 
+  if (threads > 1 && forward)
+    die ("can not combine '-j %d' with '%s'", threads, forward);
+
   for (size_t i = 0; i + 1 != size_files; i++)
     if (strcmp (files[i].path, "-") && strcmp (files[i].path, "/dev/null"))
       for (size_t j = i + 1; j != size_files; j++)
@@ -2777,6 +2934,7 @@ int main (int argc, char **argv) {
   parse_proof ();
   trim_proof ();
   check_proof ();
+  merge_checker_statistics ();
   write_proof ();
   write_cnf ();
   int res = 0;
@@ -0,0 +1,190 @@
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import os
+import signal
+import subprocess
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from dataclasses import dataclass
+from pathlib import Path
+from time import perf_counter_ns
+from typing import Callable, Sequence
+
+from ferat.codes import ExitCode
+from ferat.utils import (
+    BAD,
+    ENCODING,
+    GOOD,
+    IMPORTANT,
+    status,
+    style,
+)
+
+#  Host Resources {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Host Resources ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def available_cpus() -> int:
+    """
+    Returns the number of CPUs this process may run on.
+    """
+    try:
+        return len(os.sched_getaffinity(0))
+    except AttributeError:
+        return os.cpu_count() or 1
+
+def available_memory() -> int | None:
+    """
+    Returns the physical memory of the host in bytes, or None if unknown.
+    """
+    try:
+        return os.sysconf("SC_PAGE_SIZE") * os.sysconf("SC_PHYS_PAGES")
+    except (ValueError, OSError):
+        return None
+
+#  }}}
+
+#  Batch Scheduling {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Batch Scheduling ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@dataclass
+class Job:
+    """
+    One input of a batch, which is processed by its own pipeline process in
+    its own temporary directory.
+    """
+    qbf: Path
+    output: Path
+    tmp_dir: Path
+    returncode: int | None = None
+    time_s: float = 0.0
+    message: str = ""
+
+    @property
+    def cost(self) -> int:
+        # The input size is a cheap, if rough, estimate of the work involved
+        try:
+            return self.qbf.stat().st_size
+        except OSError:
+            return 0
+
+def exit_code_name(returncode: int) -> str:
+    if returncode < 0:
+        try:
+            return signal.Signals(-returncode).name
+        except ValueError:
+            return f"signal {-returncode!s}"
+    for name, value in vars(ExitCode).items():
+        if (not name.startswith("_")) and (value == returncode): return name
+    return f"exit {returncode!s}"
+
+def job_limit_args(
+    memory: int | None, cpu_time: int | None
+) -> tuple[str, ...]:
+    """
+    Returns the arguments which, put before a command, run it with its
+    address space and CPU time limited by 'prlimit', or nothing if there are
+    no limits. The limits are set before the command executes, and are
+    inherited by the QBF solver, SAT solver, and checkers it starts, each of
+    which they limit on its own.
+    """
+    limits = tuple(
+        f"--{kind}={value!s}" for kind, value in (
+            ("as", memory),
+            ("cpu", cpu_time),
+        ) if value is not None
+    )
+    if not limits: return ()
+    return ("prlimit", *limits, "--")
+
+def run_job(
+    job: Job,
+    args: Sequence[str],
+    memory: int | None,
+    cpu_time: int | None,
+) -> Job:
+    start_time_ns = perf_counter_ns()
+    try:
+        proc = subprocess.Popen(
+            args=(*job_limit_args(memory, cpu_time), *args),
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.PIPE,
+            close_fds=True,
+        )
+    except (OSError, subprocess.SubprocessError) as err:
+        job.returncode = ExitCode.PROCESS_OS_ERROR
+        job.message = str(err)
+        return job
+    _, stderr = proc.communicate()
+    job.time_s = 1e-9 * (perf_counter_ns() - start_time_ns)
+    job.returncode = proc.returncode
+    # Keep the reason of fatal errors, which are printed last
+    lines = stderr.decode(**ENCODING).strip().splitlines()
+    fatal_lines = [line for line in lines if "FATAL:" in line]
+    if fatal_lines:
+        job.message = fatal_lines[-1].split("FATAL:", 1)[1].strip()
+    return job
+
+def print_summary(jobs: Sequence[Job]) -> None:
+    header = ("Input", "Result", "Time [s]", "Output")
+    rows = [
+        (
+            str(job.qbf),
+            "OK" if job.returncode == 0
+            else exit_code_name(job.returncode or 0),
+            f"{job.time_s:.2f}",
+            str(job.output) if job.returncode == 0 else job.message,
+        )
+        for job in jobs
+    ]
+    widths = [
+        max(len(row[i]) for row in (header, *rows)) for i in range(3)
+    ]
+    status("")
+    for i, (qbf, result, time_s, output) in enumerate((header, *rows)):
+        styled_result = result.ljust(widths[1])
+        if i > 0:
+            styled_result = style(
+                GOOD if result == "OK" else BAD, styled_result
+            )
+        status(
+            f"{qbf.ljust(widths[0])}  {styled_result}"
+            f"  {time_s.rjust(widths[2])}  {output}"
+        )
+
+def run_batch(
+    jobs: Sequence[Job],
+    job_args: Callable[[Job], Sequence[str]],
+    num_workers: int,
+    memory: int | None = None,
+    cpu_time: int | None = None,
+) -> int:
+    """
+    Runs all jobs with at most 'num_workers' at a time, starting with the most
+    expensive ones, so that a long job does not end up running alone at the
+    end. A failing job does not stop the others. Returns the number of failed
+    jobs.
+    """
+    ordered = sorted(jobs, key=lambda job: job.cost, reverse=True)
+    with ThreadPoolExecutor(max_workers=num_workers) as executor:
+        futures = [
+            executor.submit(run_job, job, job_args(job), memory, cpu_time)
+            for job in ordered
+        ]
+        for future in as_completed(futures):
+            job = future.result()
+            result = style(GOOD, "OK") if job.returncode == 0 \
+                else style(BAD, exit_code_name(job.returncode or 0))
+            status(
+                f"Finished '{style(IMPORTANT, job.qbf)}' ({result})"
+                f" in {job.time_s:.2f} s"
+            )
+    print_summary(jobs)
+    return sum(1 for job in jobs if job.returncode != 0)
+
+#  }}}
+# vim: foldmethod=marker
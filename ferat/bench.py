@@ -0,0 +1,1076 @@
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import json
+import math
+import os
+import signal
+import sqlite3
+import subprocess
+import sys
+from argparse import (
+    ArgumentError,
+    ArgumentParser,
+    ArgumentTypeError,
+    BooleanOptionalAction,
+    Namespace,
+)
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from dataclasses import asdict, dataclass, field
+from functools import lru_cache
+from pathlib import Path
+from statistics import median
+from tempfile import TemporaryDirectory
+from time import monotonic, perf_counter_ns, sleep
+from typing import Any, Final, NoReturn, Sequence, final
+
+from ferat.batch import (
+    available_cpus,
+    available_memory,
+    exit_code_name,
+    job_limit_args,
+)
+from ferat.codes import ExitCode
+from ferat.proc import ResourceUsage, wait_with_usage
+from ferat.report import read_report
+from ferat.utils import (
+    BAD,
+    GOOD,
+    IMPORTANT,
+    FERATFatalError,
+    fatal,
+    set_show_color,
+    status,
+    style,
+    warn,
+)
+
+#  Experiments {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Experiments ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@final
+class Experiments:
+    FERAT: Final[str] = "ferat"
+    FERP: Final[str] = "ferp"
+    SOLVERS: Final[str] = "solvers"
+    COMPARE: Final[str] = "compare"
+
+# The columns of the 'benchmark' table of FERAT runs, and the pipeline steps
+# whose wall time they hold
+FERAT_STAGES: Final[tuple[tuple[str, str], ...]] = (
+    ("qbf_solve_us", "solve_qbf"),
+    ("gen_rat_proof_us", "gen_rat_proof"),
+    ("check_rat_proof_us", "check_rat_proof"),
+    ("check_expansion_us", "check_expansion"),
+    ("gen_ferat_proof_us", "gen_ferat_proof"),
+)
+
+# The tables of each experiment, as written by the old SLURM scripts
+SCHEMAS: Final[dict[str, tuple[str, ...]]] = {
+    Experiments.FERAT: (
+        """CREATE TABLE IF NOT EXISTS benchmark(
+            fname TEXT NOT NULL,
+            qbf_solve_us INT NOT NULL,
+            gen_rat_proof_us INT NOT NULL,
+            check_rat_proof_us INT NOT NULL,
+            check_expansion_us INT NOT NULL,
+            gen_ferat_proof_us INT NOT NULL,
+            total_us INT NOT NULL
+        )""",
+        """CREATE TABLE IF NOT EXISTS errors(
+            fname TEXT,
+            reason TEXT NOT NULL
+        )""",
+    ),
+    Experiments.FERP: (
+        """CREATE TABLE IF NOT EXISTS benchmark(
+            fname TEXT NOT NULL,
+            total_s REAL NOT NULL
+        )""",
+        """CREATE TABLE IF NOT EXISTS errors(
+            fname TEXT,
+            reason TEXT NOT NULL
+        )""",
+    ),
+    Experiments.SOLVERS: (
+        """CREATE TABLE IF NOT EXISTS benchmark(
+            solver TEXT NOT NULL,
+            proof_type TEXT NOT NULL,
+            fname TEXT NOT NULL,
+            sat INT NOT NULL,
+            tottime_s REAL NOT NULL
+        )""",
+        """CREATE TABLE IF NOT EXISTS errors(
+            solver TEXT NOT NULL,
+            fname TEXT,
+            reason TEXT NOT NULL
+        )""",
+    ),
+}
+
+# The resources of each run and each of its stages, for all experiments
+USAGE_SCHEMA: Final[str] = """CREATE TABLE IF NOT EXISTS usage(
+    name TEXT NOT NULL,
+    fname TEXT NOT NULL,
+    run INT NOT NULL,
+    stage TEXT NOT NULL,
+    wall_s REAL NOT NULL,
+    user_s REAL NOT NULL,
+    sys_s REAL NOT NULL,
+    max_rss_kib INT NOT NULL
+)"""
+
+@dataclass
+class Run:
+    """
+    One run of a command on one CNF expansion. The name is 'ferat', 'ferp',
+    or the solver, and together with the expansion identifies the samples
+    that are compared against a baseline.
+    """
+    name: str
+    fname: Path
+    run: int
+    args: Sequence[str]
+    proof_type: str = ""
+    report: Path | None = None
+    ok_codes: tuple[int, ...] = (0, )
+    returncode: int | None = None
+    reason: str = ""
+    total: ResourceUsage = field(default_factory=ResourceUsage)
+    stages: dict[str, ResourceUsage] = field(default_factory=dict)
+
+    @property
+    def ok(self) -> bool:
+        return self.returncode in self.ok_codes
+
+    def to_json(self) -> dict[str, Any]:
+        return {
+            "name": self.name,
+            "fname": str(self.fname),
+            "run": self.run,
+            "proof_type": self.proof_type,
+            "returncode": self.returncode,
+            "reason": self.reason,
+            "total": asdict(self.total),
+            "stages": {
+                stage: asdict(usage) for stage, usage in self.stages.items()
+            },
+        }
+
+def find_expansions(exp_dir: Path, pattern: str) -> list[Path]:
+    return sorted(path for path in exp_dir.rglob(pattern) if path.is_file())
+
+def find_qbf(qbf_dir: Path, expansion: Path) -> tuple[str, Path]:
+    """
+    Returns the base name of 'expansion', and the QBF it is an expansion of,
+    which has the same base name in 'qbf_dir'.
+    """
+    base = expansion.name
+    for suffix in (".gz", ".cnf", ".qdimacs.gz.unsat", ".qdimacs.gz.sat"):
+        base = base.removesuffix(suffix)
+    for suffix in (".qdimacs.gz", ".qdimacs"):
+        qbf = qbf_dir / f"{base}{suffix}"
+        if qbf.is_file(): return base, qbf
+    fatal(
+        ExitCode.CLI_ERR,
+        f"Unable to find QBF file for '{expansion!s}' in '{qbf_dir!s}'",
+    )
+
+def ferat_runs(
+    expansions: Sequence[Path],
+    qbf_dir: Path,
+    output_dir: Path,
+    tmp_dir: Path,
+    num_runs: int,
+    lrat: bool,
+) -> list[Run]:
+    runs = []
+    for expansion in expansions:
+        base, qbf = find_qbf(qbf_dir, expansion)
+        for i in range(num_runs):
+            name = base if (num_runs == 1) else f"{base}.{i!s}"
+            report = tmp_dir / f"{name}.json"
+            runs.append(Run(
+                Experiments.FERAT,
+                expansion,
+                i,
+                (
+                    sys.executable,
+                    "-m",
+                    "ferat",
+                    "--lrat" if lrat else "--no-lrat",
+                    "--quiet",
+                    "--color",
+                    "never",
+                    "--report",
+                    str(report),
+                    "--tmp",
+                    str(tmp_dir / name),
+                    "generate",
+                    "--expansion",
+                    str(expansion),
+                    str(qbf),
+                    str(output_dir / f"{name}.ferat"),
+                ),
+                report=report,
+            ))
+    return runs
+
+def ferp_runs(
+    expansions: Sequence[Path],
+    qbf_dir: Path,
+    output_dir: Path,
+    num_runs: int,
+    python: str,
+    ferp: Path,
+) -> list[Run]:
+    runs = []
+    for expansion in expansions:
+        base, qbf = find_qbf(qbf_dir, expansion)
+        for i in range(num_runs):
+            name = base if (num_runs == 1) else f"{base}.{i!s}"
+            runs.append(Run(
+                Experiments.FERP,
+                expansion,
+                i,
+                (
+                    python,
+                    str(ferp),
+                    str(expansion),
+                    str(qbf),
+                    str(output_dir / f"{name}.ferp"),
+                ),
+            ))
+    return runs
+
+def solver_runs(
+    expansions: Sequence[Path],
+    exp_dir: Path,
+    solvers: Sequence[tuple[str, str, str]],
+    num_runs: int,
+) -> list[Run]:
+    """
+    Creates the runs of each solver, whose arguments are split at spaces, with
+    '{s}' replaced by the solver, '{f}' by the name of the expansion, '{e}' by
+    its path, and '{d}' by the directory of expansions.
+    """
+    runs = []
+    for expansion in expansions:
+        for solver, proof_type, args in solvers:
+            for i in range(num_runs):
+                runs.append(Run(
+                    solver,
+                    expansion,
+                    i,
+                    (
+                        solver,
+                        *(
+                            arg.replace("{s}", solver)
+                            .replace("{f}", expansion.name)
+                            .replace("{e}", str(expansion))
+                            .replace("{d}", str(exp_dir))
+                            for arg in args.split()
+                        ),
+                    ),
+                    proof_type=proof_type,
+                    ok_codes=(10, 20),
+                ))
+    return runs
+
+#  }}}
+
+#  Running {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Running ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@dataclass
+class Limits:
+    """
+    The limits of each run. Memory is limited by a cgroup, if one is given,
+    and by the address space of each process otherwise.
+    """
+    memory: int | None
+    cpu_time: int | None
+    wall_time: float | None
+    cgroup: Path | None
+
+def make_cgroup(parent: Path, name: str, memory: int | None) -> Path:
+    cgroup = parent / name
+    cgroup.mkdir()
+    if memory is not None:
+        (cgroup / "memory.max").write_text(str(memory))
+        swap_max = cgroup / "memory.swap.max"
+        if swap_max.exists(): swap_max.write_text("0")
+    return cgroup
+
+def close_cgroup(cgroup: Path) -> tuple[int | None, bool]:
+    """
+    Kills what is left in 'cgroup', and removes it. Returns its peak memory
+    in bytes, if known, and whether a process in it ran out of memory.
+    """
+    peak = None
+    out_of_memory = False
+    try:
+        peak = int((cgroup / "memory.peak").read_text())
+    except (OSError, ValueError):
+        pass
+    try:
+        for line in (cgroup / "memory.events").read_text().splitlines():
+            key, value = line.split()
+            if key == "oom_kill": out_of_memory = int(value) > 0
+    except (OSError, ValueError):
+        pass
+    try:
+        (cgroup / "cgroup.kill").write_text("1")
+    except OSError:
+        pass
+    deadline = monotonic() + 5.0
+    while True:
+        try:
+            cgroup.rmdir()
+            break
+        except OSError as err:
+            # Killed processes take a moment to leave the cgroup
+            if monotonic() > deadline:
+                warn(f"Unable to remove cgroup '{cgroup!s}': {err!s}")
+                break
+            sleep(0.01)
+    return peak, out_of_memory
+
+def execute(run: Run, limits: Limits, job_id: int) -> Run:
+    """
+    Executes 'run' in a session of its own, so that everything it starts is
+    killed with it once it exceeds its wall time.
+    """
+    # The memory is limited by the cgroup instead, if there is one
+    args = (
+        *job_limit_args(
+            limits.memory if (limits.cgroup is None) else None,
+            limits.cpu_time,
+        ),
+        *run.args,
+    )
+    cgroup = None
+    if limits.cgroup is not None:
+        try:
+            cgroup = make_cgroup(
+                limits.cgroup, f"ferat-bench-{job_id!s}", limits.memory
+            )
+        except OSError as err:
+            run.returncode = ExitCode.PROCESS_OS_ERROR
+            run.reason = f"MISC({run.returncode!s}): {err!s}"
+            return run
+        # The shell moves itself into the cgroup before it becomes the run
+        args = (
+            "sh",
+            "-c",
+            'echo $$ > "$0/cgroup.procs" && exec "$@"',
+            str(cgroup),
+            *args,
+        )
+    start_time_ns = perf_counter_ns()
+    try:
+        proc = subprocess.Popen(
+            args=args,
+            stdin=subprocess.DEVNULL,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+            close_fds=True,
+            start_new_session=True,
+        )
+    except (OSError, subprocess.SubprocessError) as err:
+        run.returncode = ExitCode.PROCESS_OS_ERROR
+        run.reason = f"MISC({run.returncode!s}): {err!s}"
+        if cgroup is not None: close_cgroup(cgroup)
+        return run
+    timed_out = False
+    deadline = None if (limits.wall_time is None) \
+        else monotonic() + limits.wall_time
+    try:
+        rusage = wait_with_usage(proc, deadline)
+    except subprocess.TimeoutExpired:
+        timed_out = True
+        os.killpg(proc.pid, signal.SIGKILL)
+        rusage = wait_with_usage(proc, None)
+    wall_s = 1e-9 * (perf_counter_ns() - start_time_ns)
+    try:
+        os.killpg(proc.pid, signal.SIGKILL)
+    except (ProcessLookupError, PermissionError):
+        pass
+    run.returncode = proc.returncode
+    run.total = ResourceUsage(wall_s=wall_s) if (rusage is None) \
+        else ResourceUsage.from_rusage(wall_s, rusage)
+    out_of_memory = False
+    if cgroup is not None:
+        peak, out_of_memory = close_cgroup(cgroup)
+        if peak is not None:
+            run.total.max_rss_kib = max(run.total.max_rss_kib, peak // 1024)
+    if run.report is not None:
+        read_stages(run)
+    if timed_out or (run.returncode == -signal.SIGXCPU):
+        run.reason = f"LIMIT({run.returncode!s}): out of time"
+    elif out_of_memory:
+        run.reason = f"LIMIT({run.returncode!s}): out of memory"
+    elif run.returncode == 0 and not run.ok:
+        run.reason = f"CLI({run.returncode!s})"
+    elif not run.ok:
+        run.reason = \
+            f"MISC({run.returncode!s}): {exit_code_name(run.returncode)}"
+    return run
+
+def read_stages(run: Run) -> None:
+    """
+    Reads the resources of each pipeline step from the report of a FERAT run,
+    which only exists if the pipeline got far enough.
+    """
+    assert run.report is not None
+    try:
+        steps = read_report(run.report)[0]["steps"]
+    except (OSError, ValueError, KeyError, IndexError):
+        return
+    for step in steps:
+        usage = ResourceUsage(**{
+            key: step[key] for key in asdict(ResourceUsage())
+        })
+        name = step["step"]
+        run.stages[name] = usage if (name not in run.stages) \
+            else run.stages[name] + usage
+
+def run_all(
+    runs: Sequence[Run],
+    limits: Limits,
+    num_workers: int,
+    db: sqlite3.Connection,
+) -> None:
+    """
+    Executes all runs with at most 'num_workers' at a time, in the order they
+    are given, and records each one as soon as it finishes.
+    """
+    with ThreadPoolExecutor(max_workers=num_workers) as executor:
+        futures = [
+            executor.submit(execute, run, limits, i)
+            for i, run in enumerate(runs)
+        ]
+        for future in as_completed(futures):
+            run = future.result()
+            record(db, run)
+            result = style(GOOD, "OK") if run.ok \
+                else style(BAD, run.reason)
+            status(
+                f"Finished '{style(IMPORTANT, run.name)}' on"
+                f" '{style(IMPORTANT, run.fname)}' ({result})"
+                f" in {run.total.wall_s:.2f} s"
+            )
+
+#  }}}
+
+#  Recording {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Recording ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def open_db(path: Path, experiment: str) -> sqlite3.Connection:
+    db = sqlite3.connect(path, timeout=30.0)
+    with db:
+        for schema in (*SCHEMAS[experiment], USAGE_SCHEMA):
+            db.execute(schema)
+    return db
+
+def record(db: sqlite3.Connection, run: Run) -> None:
+    fname = str(run.fname)
+    with db:
+        for stage, usage in (*run.stages.items(), ("total", run.total)):
+            db.execute(
+                "INSERT INTO usage VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+                (
+                    run.name,
+                    fname,
+                    run.run,
+                    stage,
+                    usage.wall_s,
+                    usage.user_s,
+                    usage.sys_s,
+                    usage.max_rss_kib,
+                ),
+            )
+        if run.name == Experiments.FERAT:
+            if not run.ok:
+                db.execute(
+                    "INSERT INTO errors VALUES (?, ?)", (fname, run.reason)
+                )
+                return
+            db.execute(
+                "INSERT INTO benchmark VALUES (?, ?, ?, ?, ?, ?, ?)",
+                (
+                    fname,
+                    *(
+                        int(1e6 * run.stages.get(step, ResourceUsage()).wall_s)
+                        for _, step in FERAT_STAGES
+                    ),
+                    int(1e6 * run.total.wall_s),
+                ),
+            )
+        elif run.name == Experiments.FERP:
+            if not run.ok:
+                db.execute(
+                    "INSERT INTO errors VALUES (?, ?)", (fname, run.reason)
+                )
+                return
+            # Like 'runlim', which reports the CPU time
+            db.execute(
+                "INSERT INTO benchmark VALUES (?, ?)",
+                (fname, run.total.user_s + run.total.sys_s),
+            )
+        else:
+            if not run.ok:
+                db.execute(
+                    "INSERT INTO errors VALUES (?, ?, ?)",
+                    (run.name, fname, run.reason),
+                )
+                return
+            db.execute(
+                "INSERT INTO benchmark VALUES (?, ?, ?, ?, ?)",
+                (
+                    run.name,
+                    run.proof_type,
+                    fname,
+                    1 if (run.returncode == 10) else 0,
+                    run.total.user_s + run.total.sys_s,
+                ),
+            )
+
+def write_results(path: Path, experiment: str, runs: Sequence[Run]) -> None:
+    path.write_text(
+        json.dumps(
+            {
+                "experiment": experiment,
+                "runs": [run.to_json() for run in runs],
+            },
+            indent=2,
+        )
+    )
+
+def read_results(path: Path) -> list[dict[str, Any]]:
+    return json.loads(path.read_text())["runs"]
+
+#  }}}
+
+#  Comparison {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Comparison ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+# Samples up to this size are tested exactly, if they have no ties
+EXACT_TEST_SIZE: Final[int] = 40
+
+@lru_cache(maxsize=None)
+def _num_orderings(m: int, n: int, u: int) -> int:
+    """
+    Returns the number of orderings of 'm' and 'n' distinct values from two
+    samples, in which values of the first exceed values of the second 'u'
+    times in total.
+    """
+    if u < 0: return 0
+    if (m == 0) or (n == 0): return 1 if (u == 0) else 0
+    # The largest value either exceeds all of the second sample, or none
+    return _num_orderings(m - 1, n, u - n) + _num_orderings(m, n - 1, u)
+
+def mann_whitney_u(xs: Sequence[float], ys: Sequence[float]) -> float:
+    """
+    Returns the two-sided p-value of the Mann-Whitney U test of whether 'xs'
+    and 'ys' come from the same distribution. Small samples without ties are
+    tested exactly, and all others by the normal approximation with tie
+    correction.
+    """
+    m, n = len(xs), len(ys)
+    if (m == 0) or (n == 0): return 1.0
+    pooled = sorted([(x, 0) for x in xs] + [(y, 1) for y in ys])
+    rank_sum = 0.0
+    ties = 0
+    i = 0
+    while i < len(pooled):
+        j = i
+        while (j + 1 < len(pooled)) and (pooled[j + 1][0] == pooled[i][0]):
+            j += 1
+        rank = 0.5 * (i + j) + 1.0
+        rank_sum += rank * sum(1 for k in range(i, j + 1) if pooled[k][1] == 0)
+        ties += (j - i + 1)**3 - (j - i + 1)
+        i = j + 1
+    u = rank_sum - 0.5 * m * (m + 1)
+    if (ties == 0) and (m + n <= EXACT_TEST_SIZE):
+        extreme = int(min(u, m * n - u))
+        count = sum(_num_orderings(m, n, k) for k in range(extreme + 1))
+        return min(1.0, 2.0 * count / math.comb(m + n, m))
+    variance = m * n / 12.0 * ((m + n + 1) - ties / ((m + n) * (m + n - 1)))
+    if variance <= 0.0: return 1.0
+    z = max(0.0, abs(u - 0.5 * m * n) - 0.5) / math.sqrt(variance)
+    return min(1.0, math.erfc(z / math.sqrt(2.0)))
+
+def samples(runs: Sequence[dict[str, Any]]) -> dict[tuple[str, ...], list]:
+    """
+    Groups the wall time of each stage and in total, and the peak memory of
+    the successful runs by name, expansion, and metric.
+    """
+    grouped: dict[tuple[str, ...], list] = {}
+    for run in runs:
+        if run["reason"]: continue
+        key = (run["name"], run["fname"])
+        metrics = {
+            **{
+                f"{stage}_s": usage["wall_s"]
+                for stage, usage in run["stages"].items()
+            },
+            "total_s": run["total"]["wall_s"],
+            "max_rss_kib": run["total"]["max_rss_kib"],
+        }
+        for metric, value in metrics.items():
+            grouped.setdefault((*key, metric), []).append(value)
+    return grouped
+
+def holm_bonferroni(p_values: Sequence[float], alpha: float) -> list[bool]:
+    """
+    Returns which of the hypotheses with 'p_values' are rejected by the
+    Holm-Bonferroni method, which keeps the chance of any false rejection
+    among all of them below 'alpha'.
+    """
+    rejected = [False] * len(p_values)
+    order = sorted(range(len(p_values)), key=lambda i: p_values[i])
+    for rank, i in enumerate(order):
+        if p_values[i] > alpha / (len(p_values) - rank): break
+        rejected[i] = True
+    return rejected
+
+def compare(
+    baseline: Sequence[dict[str, Any]],
+    current: Sequence[dict[str, Any]],
+    alpha: float,
+    threshold: float,
+) -> int:
+    """
+    Compares the median of each metric of the current runs to the baseline,
+    and flags those that differ significantly, and by more than 'threshold'.
+    The significance of all comparisons is corrected together, see
+    'holm_bonferroni'. Metrics with a median of zero are not comparable.
+    Returns the number of regressions.
+    """
+    base_samples = samples(baseline)
+    current_samples = samples(current)
+    tests = []
+    not_comparable = []
+    ratios = []
+    min_size = 0
+    for key, values in sorted(current_samples.items()):
+        base_values = base_samples.get(key)
+        if not base_values: continue
+        base_median, current_median = median(base_values), median(values)
+        if (base_median <= 0) or (current_median <= 0):
+            not_comparable.append(key)
+            continue
+        ratio = current_median / base_median
+        if key[2] == "total_s": ratios.append(ratio)
+        min_size = min(len(values), len(base_values)) if (min_size == 0) \
+            else min(min_size, len(values), len(base_values))
+        tests.append((*key, ratio, mann_whitney_u(base_values, values)))
+    if len(tests) + len(not_comparable) == 0:
+        fatal(ExitCode.CLI_ERR, "No runs in common with the baseline")
+    if min_size < 4:
+        warn(
+            f"Only {min_size!s} runs per sample, too few for any difference"
+            " to be significant"
+        )
+    if len(not_comparable) > 0:
+        warn(
+            f"{len(not_comparable)!s} metric(s) have a median of zero, and"
+            " are not comparable: "
+            + ", ".join(" ".join(key) for key in not_comparable)
+        )
+
+    rejected = holm_bonferroni([row[4] for row in tests], alpha)
+    rows = [
+        row for row, significant in zip(tests, rejected)
+        if significant and (abs(math.log(row[3])) > math.log1p(threshold))
+    ]
+    regressions = [row for row in rows if row[3] > 1.0]
+    improvements = [row for row in rows if row[3] < 1.0]
+    for title, color, flagged in (
+        ("Regressions", BAD, regressions),
+        ("Improvements", GOOD, improvements),
+    ):
+        if len(flagged) == 0: continue
+        status(f"{title}:")
+        for name, fname, metric, ratio, p in flagged:
+            status(
+                f"  {name} {fname} {metric}:"
+                f" {style(color, f'{ratio:.3f}x')} (p = {p:.4f})"
+            )
+    summary = f"{len(regressions)!s} regressions and" \
+        f" {len(improvements)!s} improvements over {len(ratios)!s} instances"
+    if len(ratios) > 0:
+        geo_mean = math.exp(sum(map(math.log, ratios)) / len(ratios))
+        summary += f", with a total time of {geo_mean:.3f}x the baseline" \
+            " (geometric mean)"
+    status(summary)
+    return len(regressions)
+
+#  }}}
+
+#  Command Line {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Command Line ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def cli(parser: ArgumentParser) -> Namespace:
+    #  General Options {{{
+    #  ~~~~~~~~~~~~~~~~~~~~ General Options ~~~~~~~~~~~~~~~~~~~~
+    # Limits group {{{
+    limits_group = parser.add_argument_group(title="limits")
+    limits_group.add_argument(
+        "-j",
+        "--jobs",
+        help="sets the number of runs at a time (default = number of CPUs)",
+        default=None,
+        type=int,
+        dest="jobs",
+    )
+    limits_group.add_argument(
+        "--memory",
+        help="limits the memory in MiB of each run, or no limit if set to 0." \
+             " Without '--cgroup', this limits the address space of each of" \
+             " its processes, which multi-threaded tools may exceed long" \
+             " before their resident memory does (default = 8192)",
+        default=8192,
+        type=int,
+        dest="memory",
+    )
+    limits_group.add_argument(
+        "--time-limit",
+        help="limits the wall time in seconds of each run, or no limit if" \
+             " set to 0 (default = 900)",
+        default=900.0,
+        type=float,
+        dest="time_limit",
+    )
+    limits_group.add_argument(
+        "--cpu-time",
+        help="limits the CPU time in seconds of each process of a run, or no" \
+             " limit if set to 0 (default = 0)",
+        default=0,
+        type=int,
+        dest="cpu_time",
+    )
+    limits_group.add_argument(
+        "--cgroup",
+        help="runs each run in a cgroup below this delegated cgroup (v2)" \
+             " directory, which limits the memory of all its processes" \
+             " together, and measures their peak memory (default = limit" \
+             " each process with rlimits instead)",
+        default=None,
+        type=Path,
+        dest="cgroup",
+    )
+    # }}}
+    # Results group {{{
+    results_group = parser.add_argument_group(title="results")
+    results_group.add_argument(
+        "--runs",
+        help="sets the number of runs per instance, of which at least four" \
+             " are needed to compare against a baseline (default = 1)",
+        default=1,
+        type=int,
+        dest="runs",
+    )
+    results_group.add_argument(
+        "--db",
+        help="appends the results to this sqlite database, in the tables of" \
+             " the experiment (default = 'benchmark-<experiment>.sql')",
+        default=None,
+        type=Path,
+        dest="db",
+    )
+    results_group.add_argument(
+        "--json",
+        help="writes every run, with the resources of each of its stages, to" \
+             " this JSON file, which can serve as a baseline later" \
+             " (default = no JSON)",
+        default=None,
+        type=Path,
+        dest="json",
+    )
+    results_group.add_argument(
+        "--baseline",
+        help="compares the runs to the runs in this JSON file, and exits" \
+             f" with {ExitCode.PERFORMANCE_REGRESSION!s} on any regression" \
+             " (default = no comparison)",
+        default=None,
+        type=Path,
+        dest="baseline",
+    )
+    results_group.add_argument(
+        "--alpha",
+        help="sets the significance level of all comparisons together," \
+             " corrected by the Holm-Bonferroni method (default = 0.05)",
+        default=0.05,
+        type=float,
+        dest="alpha",
+    )
+    results_group.add_argument(
+        "--threshold",
+        help="ignores changes of the median below this fraction, even if" \
+             " significant (default = 0.05)",
+        default=0.05,
+        type=float,
+        dest="threshold",
+    )
+    results_group.add_argument(
+        "--color",
+        help="sets the color mode (default = auto)",
+        choices=["auto", "always", "never"],
+        default="auto",
+        dest="color",
+    )
+    # }}}
+    #  }}}
+
+    subparsers = parser.add_subparsers(
+        title="experiments", required=True, dest="experiment"
+    )
+
+    #  Experiment Subparsers {{{
+    #  ~~~~~~~~~~~~~~~~~~~~ Experiment Subparsers ~~~~~~~~~~~~~~~~~~~~
+    ferat_parser = subparsers.add_parser(
+        Experiments.FERAT,
+        help="Generate FERAT proofs from existing CNF expansions",
+    )
+    ferp_parser = subparsers.add_parser(
+        Experiments.FERP,
+        help="Generate FERP proofs from existing CNF expansions",
+    )
+    for sub_parser in (ferat_parser, ferp_parser):
+        sub_parser.add_argument(
+            "exp_dir",
+            help="sets the directory of CNF expansions, which is searched" \
+                 " recursively",
+            type=Path,
+        )
+        sub_parser.add_argument(
+            "qbf_dir",
+            help="sets the directory of the QBFs, which have the same base" \
+                 " name as their expansions, and end in '.qdimacs(.gz)'",
+            type=Path,
+        )
+        sub_parser.add_argument(
+            "output_dir",
+            help="sets the directory of the generated proofs",
+            type=Path,
+        )
+    ferat_parser.add_argument(
+        "-l",
+        "--lrat",
+        help="use LRAT instead of (D)RAT in the pipeline (default = False)",
+        action=BooleanOptionalAction,
+        default=False,
+        dest="lrat",
+    )
+    ferp_parser.add_argument(
+        "--ferp",
+        help="sets the path to the FERP pipeline script" \
+             " (default = ../ferp-models/pipeline.py)",
+        default=Path(__file__).parents[2] / "ferp-models" / "pipeline.py",
+        type=Path,
+        dest="ferp",
+    )
+    ferp_parser.add_argument(
+        "--python",
+        help="sets the Python interpreter of the FERP pipeline script" \
+             " (default = python2)",
+        default="python2",
+        dest="python",
+    )
+    solvers_parser = subparsers.add_parser(
+        Experiments.SOLVERS,
+        help="Solve existing CNF expansions with SAT solvers",
+    )
+    solvers_parser.add_argument(
+        "exp_dir",
+        help="sets the directory of CNF expansions, which is searched" \
+             " recursively",
+        type=Path,
+    )
+    solvers_parser.add_argument(
+        "-s",
+        "--solver",
+        help="adds a solver with its proof type, like 'RAT' or 'RUP', and" \
+             " its arguments, in which '{s}' is replaced by the solver," \
+             " '{f}' by the name of the expansion, '{e}' by its path, and" \
+             " '{d}' by the directory of expansions",
+        action="append",
+        nargs=3,
+        metavar=("SOLVER", "PROOF_TYPE", "ARGS"),
+        required=True,
+        dest="solvers",
+    )
+    for sub_parser in (ferat_parser, ferp_parser, solvers_parser):
+        sub_parser.add_argument(
+            "-p",
+            "--pattern",
+            help="only uses the CNF expansions whose name matches this glob" \
+                 " (default = *)",
+            default="*",
+            dest="pattern",
+        )
+    #  }}}
+
+    #  Compare Subparser {{{
+    #  ~~~~~~~~~~~~~~~~~~~~ Compare Subparser ~~~~~~~~~~~~~~~~~~~~
+    compare_parser = subparsers.add_parser(
+        Experiments.COMPARE,
+        help="Compare the runs of two JSON files, without running anything",
+    )
+    compare_parser.add_argument(
+        "baseline_json",
+        help="sets the path to the JSON file of the baseline",
+        type=Path,
+    )
+    compare_parser.add_argument(
+        "current_json",
+        help="sets the path to the JSON file to compare",
+        type=Path,
+    )
+    #  }}}
+
+    try:
+        return parser.parse_args(sys.argv[1:])
+    except (ArgumentError, ArgumentTypeError) as args_err:
+        fatal(ExitCode.CLI_ERR, args_err)
+
+#  }}}
+
+#  Main Entrypoint {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Main Entrypoint ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def main() -> NoReturn:
+    parser = ArgumentParser(
+        description="The FERAT benchmark runner. Runs the FERAT, FERP, or" \
+                    " solver experiments on this machine, records the" \
+                    " resources of each run, and compares them to a baseline.",
+        allow_abbrev=True,
+    )
+    try:
+        args = cli(parser)
+        if args.color == "never": set_show_color(False)
+        elif args.color == "auto": set_show_color(sys.stdout.isatty())
+        else: set_show_color(True)
+
+        experiment: str = args.experiment
+        alpha: float = args.alpha
+        threshold: float = args.threshold
+        if experiment == Experiments.COMPARE:
+            num_regressions = compare(
+                read_results(args.baseline_json),
+                read_results(args.current_json),
+                alpha,
+                threshold,
+            )
+            sys.exit(
+                ExitCode.PERFORMANCE_REGRESSION if (num_regressions > 0)
+                else 0
+            )
+
+        num_runs: int = args.runs
+        if num_runs < 1: fatal(ExitCode.CLI_ERR, "--runs must be positive")
+        num_jobs: int = args.jobs or available_cpus()
+        memory: int | None = None if (args.memory == 0) \
+            else args.memory * 1024 * 1024
+        host_memory = available_memory()
+        if (memory is not None) and (host_memory is not None) \
+            and (memory * num_jobs > host_memory):
+            warn(
+                f"{num_jobs!s} job(s) of {args.memory!s} MiB each exceed the"
+                " memory of this host"
+            )
+        cgroup: Path | None = args.cgroup
+        if (cgroup is not None) and not (cgroup / "cgroup.procs").is_file():
+            fatal(ExitCode.CLI_ERR, f"'{cgroup!s}' is not a cgroup (v2)")
+        limits = Limits(
+            memory,
+            args.cpu_time or None,
+            args.time_limit or None,
+            cgroup,
+        )
+        exp_dir: Path = args.exp_dir
+        expansions = find_expansions(exp_dir, args.pattern)
+        if len(expansions) == 0:
+            fatal(ExitCode.CLI_ERR, f"No CNF expansions in '{exp_dir!s}'")
+        db_path: Path = args.db or Path(f"benchmark-{experiment!s}.sql")
+        baseline = None if (args.baseline is None) \
+            else read_results(args.baseline)
+
+        with TemporaryDirectory(prefix="ferat-bench-") as tmp_name:
+            tmp_dir = Path(tmp_name)
+            if experiment == Experiments.FERAT:
+                args.output_dir.mkdir(parents=True, exist_ok=True)
+                runs = ferat_runs(
+                    expansions,
+                    args.qbf_dir,
+                    args.output_dir,
+                    tmp_dir,
+                    num_runs,
+                    args.lrat,
+                )
+            elif experiment == Experiments.FERP:
+                args.output_dir.mkdir(parents=True, exist_ok=True)
+                runs = ferp_runs(
+                    expansions,
+                    args.qbf_dir,
+                    args.output_dir,
+                    num_runs,
+                    args.python,
+                    args.ferp,
+                )
+            else:
+                runs = solver_runs(
+                    expansions, exp_dir, args.solvers, num_runs
+                )
+            status(
+                f"Running {len(runs)!s} runs with {num_jobs!s} job(s),"
+                f" writing to '{db_path!s}'"
+            )
+            db = open_db(db_path, experiment)
+            try:
+                run_all(runs, limits, num_jobs, db)
+            finally:
+                db.close()
+
+        if args.json is not None: write_results(args.json, experiment, runs)
+        num_failed = sum(1 for run in runs if not run.ok)
+        if num_failed > 0:
+            warn(f"{num_failed!s} of {len(runs)!s} runs failed")
+        if baseline is not None:
+            num_regressions = compare(
+                baseline,
+                [run.to_json() for run in runs],
+                alpha,
+                threshold,
+            )
+            if num_regressions > 0:
+                sys.exit(ExitCode.PERFORMANCE_REGRESSION)
+    except FERATFatalError as ferr:
+        ferr.exit()
+    except (OSError, sqlite3.Error, ValueError, KeyError) as err:
+        try:
+            fatal(ExitCode.FAIL, err)
+        except FERATFatalError as ferr:
+            ferr.exit()
+    sys.exit(0)
+
+if __name__ == "__main__":
+    main()
+
+#  }}}
+# vim: foldmethod=marker
@@ -0,0 +1,245 @@
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import hashlib
+import json
+import os
+import re
+import shutil
+from functools import lru_cache
+from pathlib import Path
+from tempfile import mkdtemp
+from typing import Any, Callable, Final, Mapping
+
+from ferat.utils import FERATFatalError, SomePath, fatal, status, warn
+
+#  Globals {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Globals ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+# Bump this whenever the layout of cache entries, or the meaning of what is
+# stored in them changes
+CACHE_FORMAT: Final[str] = "1"
+HASH_CHUNK_SIZE: Final[int] = 1 << 20
+VERDICT_FILE: Final[str] = "verdict.json"
+# Snapshots of parsed QBFs, which 'ferat-tools' keeps on its own
+SNAPSHOT_DIR: Final[str] = "snapshots"
+
+RE_ESCAPE_SEQUENCE: Final[re.Pattern] = re.compile(r"\x1B\[[0-9;]*m")
+
+#  }}}
+
+#  Hashing {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Hashing ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@lru_cache
+def _file_digest(path: Path, size: int, mtime_ns: int) -> str:
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        while len(chunk := file.read(HASH_CHUNK_SIZE)) > 0:
+            digest.update(chunk)
+    return digest.hexdigest()
+
+def file_digest(path: SomePath) -> str:
+    """
+    Returns the SHA-256 hash of the content of a file. Hashes are remembered
+    for as long as the size and modification time of the file do not change,
+    so that the tool binaries are only hashed once per run.
+    """
+    path = Path(path).resolve()
+    stat = path.stat()
+    return _file_digest(path, stat.st_size, stat.st_mtime_ns)
+
+def cache_key(*parts: Any) -> str:
+    """
+    Combines the given parts, which are hashes and options, into a key.
+    """
+    digest = hashlib.sha256(CACHE_FORMAT.encode())
+    for part in parts:
+        digest.update(b"\0")
+        digest.update(str(part).encode())
+    return digest.hexdigest()
+
+#  }}}
+
+#  Cache {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Cache ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def _clone_file(src: Path, dst: Path, *, link: bool) -> None:
+    """
+    Makes 'dst' a copy of 'src', as a hardlink if 'link' is set and 'src' and
+    'dst' are on the same file system, and as an in-kernel copy otherwise,
+    which shares the data blocks on copy-on-write file systems.
+    """
+    dst.unlink(missing_ok=True)
+    if link:
+        try:
+            os.link(src, dst)
+            return
+        except OSError:
+            pass
+    with open(src, "rb") as src_file, open(dst, "wb") as dst_file:
+        try:
+            while os.copy_file_range(
+                src_file.fileno(), dst_file.fileno(), HASH_CHUNK_SIZE
+            ) > 0:
+                pass
+        except (AttributeError, OSError):
+            src_file.seek(0)
+            dst_file.seek(0)
+            dst_file.truncate()
+            shutil.copyfileobj(src_file, dst_file, HASH_CHUNK_SIZE)
+
+class ArtifactCache:
+    """
+    A directory of pipeline stage results, keyed by a hash of everything
+    which determines them. Each entry holds the output files of a stage, and
+    its verdict, i.e. its return value or the fatal error it ended with. The
+    least recently used entries are evicted once the cache grows larger than
+    'max_size' bytes.
+    """
+
+    root: Path
+    max_size: int | None
+
+    def __init__(self, root: SomePath, max_size: int | None = None):
+        self.root = Path(root)
+        self.max_size = max_size
+        os.makedirs(self.root, mode=0o755, exist_ok=True)
+
+    def entry(self, key: str) -> Path:
+        return self.root / key[:2] / key
+
+    @property
+    def snapshot_dir(self) -> Path:
+        return self.root / SNAPSHOT_DIR
+
+    def run(
+        self,
+        name: str,
+        key: str,
+        outputs: Mapping[str, Path],
+        stage: Callable[[], Any],
+        failures: set[int] = set(),
+        inputs: Mapping[str, Path] = {},
+    ) -> Any:
+        """
+        Runs 'stage', or restores its outputs and verdict from the cache.
+        Fatal errors with an exit code in 'failures' are verdicts as well, and
+        are cached. The return value of 'stage' may contain paths of 'inputs'
+        and 'outputs', and otherwise has to be JSON-serializable.
+        """
+        paths = {**{f"input:{k}": v for k, v in inputs.items()}, **outputs}
+        entry = self.entry(key)
+        verdict_file = entry / VERDICT_FILE
+        if verdict_file.is_file():
+            try:
+                verdict = json.loads(verdict_file.read_text())
+                for output_name, path in outputs.items():
+                    if (entry / output_name).is_file():
+                        _clone_file(entry / output_name, path, link=True)
+                    else:
+                        path.unlink(missing_ok=True)
+                os.utime(entry)
+                status(f"Using cached result of {name}")
+                if "exit_code" in verdict:
+                    fatal(verdict["exit_code"], verdict["message"])
+                return self._decode(verdict["result"], paths)
+            except (OSError, ValueError, KeyError) as err:
+                warn(f"Ignoring broken cache entry '{entry!s}': {err!s}")
+
+        # Stage outputs may be hardlinks into the cache from an earlier run,
+        # which must not be written through
+        for path in outputs.values(): path.unlink(missing_ok=True)
+        try:
+            result = stage()
+        except FERATFatalError as ferr:
+            if ferr.exit_code in failures:
+                message = RE_ESCAPE_SEQUENCE.sub("", str(ferr.o))
+                self._store(
+                    entry,
+                    {"exit_code": ferr.exit_code, "message": message},
+                    {},
+                )
+            raise ferr
+        try:
+            encoded = self._encode(result, paths)
+        except ValueError as err:
+            warn(f"Not caching result of {name}: {err!s}")
+            return result
+        self._store(entry, {"result": encoded}, outputs)
+        return result
+
+    def _encode(self, result: Any, paths: Mapping[str, Path]) -> Any:
+        if isinstance(result, Path):
+            for name, path in paths.items():
+                if path == result: return {"path": name}
+            raise ValueError(f"Unable to cache path '{result!s}'")
+        if isinstance(result, (tuple, list)):
+            return [self._encode(item, paths) for item in result]
+        return result
+
+    def _decode(self, result: Any, paths: Mapping[str, Path]) -> Any:
+        if isinstance(result, dict): return paths[result["path"]]
+        if isinstance(result, list):
+            return tuple(self._decode(item, paths) for item in result)
+        return result
+
+    def _store(
+        self,
+        entry: Path,
+        verdict: dict[str, Any],
+        outputs: Mapping[str, Path],
+    ) -> None:
+        # Entries are put together next to their final place, and renamed
+        # into it, so that concurrent runs never see half an entry
+        try:
+            entry.parent.mkdir(mode=0o755, parents=True, exist_ok=True)
+            staging = Path(mkdtemp(prefix=".staging-", dir=entry.parent))
+            for output_name, path in outputs.items():
+                if path.is_file():
+                    _clone_file(path, staging / output_name, link=False)
+            (staging / VERDICT_FILE).write_text(json.dumps(verdict))
+            try:
+                staging.rename(entry)
+            except OSError:
+                # Another run stored the same entry first
+                shutil.rmtree(staging, ignore_errors=True)
+            self.evict()
+        except OSError as err:
+            warn(f"Unable to store cache entry '{entry!s}': {err!s}")
+
+    def evict(self) -> None:
+        """
+        Removes the least recently used entries and QBF snapshots until the
+        cache fits into its size limit.
+        """
+        if self.max_size is None: return
+        entries: list[tuple[int, int, Path]] = []
+        for entry in self.root.glob("*/*"):
+            if entry.name.startswith("."): continue
+            try:
+                if entry.is_dir():
+                    size = sum(f.stat().st_size for f in entry.iterdir())
+                else:
+                    size = entry.stat().st_size
+                entries.append((entry.stat().st_mtime_ns, size, entry))
+            except OSError:
+                continue
+        total_size = sum(size for _, size, _ in entries)
+        for _, size, entry in sorted(entries):
+            if total_size <= self.max_size: break
+            if entry.is_dir():
+                shutil.rmtree(entry, ignore_errors=True)
+            else:
+                entry.unlink(missing_ok=True)
+            total_size -= size
+
+#  }}}
+# vim: foldmethod=marker
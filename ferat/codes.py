@@ -17,6 +17,8 @@ class ExitCode:
     INVALID_RAT_PROOF: Final[int] = 74
     INVALID_EXPANSION_MAPPING: Final[int] = 75
     INVALID_FERAT_PROOF: Final[int] = 76
+    BATCH_FAILED: Final[int] = 77
+    PERFORMANCE_REGRESSION: Final[int] = 78
     # process runner
     PROCESS_FAILED: Final[int] = 90
     PROCESS_TIMED_OUT: Final[int] = 91
@@ -0,0 +1,695 @@
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+from argparse import (
+    ArgumentError,
+    ArgumentParser,
+    ArgumentTypeError,
+    Namespace,
+)
+from dataclasses import dataclass
+from pathlib import Path
+from tempfile import TemporaryDirectory
+from typing import Final, NoReturn, final
+
+from ferat.codes import ExitCode
+from ferat.pgo import Instance, run_pipeline
+from ferat.proc import ResourceUsage
+from ferat.utils import (
+    BAD,
+    GOOD,
+    IMPORTANT,
+    FERATFatalError,
+    fatal,
+    set_show_color,
+    status,
+    style,
+    warn,
+)
+
+#  Scores {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Scores ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@final
+class Commands:
+    SEARCH: Final[str] = "search"
+    ORACLE: Final[str] = "oracle"
+    REPLAY: Final[str] = "replay"
+
+@final
+class Metrics:
+    TIME: Final[str] = "time"
+    MEMORY: Final[str] = "memory"
+
+METRICS: Final[tuple[str, ...]] = (Metrics.TIME, Metrics.MEMORY)
+
+# The least seconds, or bytes, beyond the overhead that count as a blow-up,
+# since starting a backend varies by a few milliseconds, and pages of memory
+NOISE: Final[dict[str, float]] = {
+    Metrics.TIME: 0.05,
+    Metrics.MEMORY: 4.0 * 1024 * 1024,
+}
+
+# The smallest UNSAT QBF that all steps of the pipeline run on, whose
+# resources are those of starting the backends, and not of their inputs
+TRIVIAL_QBF: Final[str] = "p cnf 1 2\ne 1 0\n1 0\n-1 0\n"
+
+# The first line of each instance in the corpus
+CORPUS_HEADER: Final[re.Pattern] = re.compile(
+    r"^c perffuzz stage=(\S+) metric=(\S+) score=(\S+)"
+)
+
+_SCRIPTS_DIR: Final[Path] = Path(__file__).parents[1] / "tests" / "deps"
+
+def metric_value(usage: ResourceUsage, metric: str) -> float:
+    if metric == Metrics.TIME: return usage.wall_s
+    return 1024.0 * usage.max_rss_kib
+
+def score(
+    value: float,
+    base: float,
+    metric: str,
+    num_bytes: int,
+    floor: float,
+) -> float:
+    """
+    Returns the seconds, or bytes of memory, that a step used per byte of its
+    QBF, beyond the 'base' overhead of starting its backend. Steps that use
+    less than 'floor' times that overhead, or too little more than it to tell
+    apart from noise, are not pathological, and score 0.
+    """
+    if (value < floor * base) or (value - base < NOISE[metric]): return 0.0
+    return (value - base) / max(num_bytes, 1)
+
+def measure(
+    deps_dir: Path,
+    qbf: Path,
+    tmp_dir: Path,
+    repeat: int,
+    timeout: float,
+) -> dict[str, ResourceUsage]:
+    """
+    Runs the pipeline 'repeat' times on 'qbf', and returns the least time and
+    memory of each step, which are the least affected by noise.
+    """
+    least: dict[str, ResourceUsage] = {}
+    for _ in range(repeat):
+        stages = run_pipeline(deps_dir, Instance(qbf, None), tmp_dir, timeout)
+        for name, usage in stages.items():
+            if name not in least:
+                least[name] = usage
+                continue
+            least[name].wall_s = min(least[name].wall_s, usage.wall_s)
+            least[name].max_rss_kib = \
+                min(least[name].max_rss_kib, usage.max_rss_kib)
+    return least
+
+def measure_overhead(
+    deps_dir: Path,
+    tmp_dir: Path,
+    repeat: int,
+    timeout: float,
+) -> dict[str, ResourceUsage]:
+    qbf = tmp_dir / "trivial.qdimacs"
+    qbf.write_text(TRIVIAL_QBF)
+    overhead = measure(deps_dir, qbf, tmp_dir, repeat, timeout)
+    if len(overhead) == 0:
+        fatal(ExitCode.FAIL, "The pipeline failed on a trivial QBF")
+    return overhead
+
+#  }}}
+
+#  Fuzzing {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Fuzzing ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@dataclass
+class Candidate:
+    """
+    The QBF with the highest score of one step and metric so far.
+    """
+    stage: str
+    metric: str
+    qbf: Path
+    score: float
+
+def generate(
+    qbfuzz: Path,
+    qbf: Path,
+    seed: int,
+    max_vars: int,
+    max_clauses: int,
+    max_qsets: int,
+) -> None:
+    """
+    Generates a QBF with qbfuzz, whose size is drawn from 'seed', and whose
+    remaining parameters qbfuzz draws from it.
+    """
+    rng = random.Random(seed)
+    num_vars = rng.randint(4, max_vars)
+    subprocess.run(
+        (
+            sys.executable,
+            str(qbfuzz),
+            f"--seed={seed!s}",
+            "-v",
+            str(num_vars),
+            "-c",
+            str(rng.randint(num_vars, max(num_vars, max_clauses))),
+            "-s",
+            str(rng.randint(1, max_qsets)),
+            "-o",
+            str(qbf),
+        ),
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.DEVNULL,
+        check=True,
+    )
+
+def minimize(
+    args: Namespace,
+    candidate: Candidate,
+    overhead: float,
+    tmp_dir: Path,
+) -> Path:
+    """
+    Minimizes the QBF of 'candidate' with qbfdd, keeping each reduction that
+    still scores at least 'args.keep' times as high, which the oracle command
+    reports as a failure. Returns the minimized QBF, or the original one, if
+    nothing could be removed.
+    """
+    reduced = tmp_dir / f"{candidate.qbf.stem}.min.qdimacs"
+    oracle = (
+        sys.executable,
+        "-m",
+        "ferat.perffuzz",
+        "--color",
+        "never",
+        "--deps",
+        str(args.deps_dir),
+        "--timeout",
+        str(args.timeout),
+        "--repeat",
+        str(args.repeat),
+        Commands.ORACLE,
+        "--stage",
+        candidate.stage,
+        "--metric",
+        candidate.metric,
+        "--score",
+        repr(args.keep * candidate.score),
+        "--overhead",
+        repr(overhead),
+        "--floor",
+        repr(args.floor),
+        "%",
+    )
+    if any(re.search(r"\s", part) for part in oracle):
+        fatal(ExitCode.CLI_ERR, "qbfdd cannot run paths with whitespace")
+    package_dir = str(Path(__file__).parents[1])
+    python_path = os.environ.get("PYTHONPATH")
+    result = subprocess.run(
+        (
+            sys.executable,
+            str(args.qbfdd),
+            "--failed",
+            "1",
+            "--skip-output",
+            "--no-color",
+            "--mode",
+            args.dd_mode,
+            "--gran",
+            args.dd_gran,
+            "--tmp",
+            str(tmp_dir / "qbfdd.qdimacs"),
+            "--out",
+            str(reduced),
+            str(candidate.qbf),
+            " ".join(oracle),
+        ),
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.PIPE,
+        text=True,
+        env={
+            **os.environ,
+            "PYTHONPATH": package_dir if (python_path is None)
+            else f"{package_dir}{os.pathsep}{python_path}",
+        },
+    )
+    if result.returncode != 0:
+        warn(
+            f"qbfdd failed on '{candidate.qbf.name}', keeping it as it is:"
+            f" {result.stderr.strip()}"
+        )
+        return candidate.qbf
+    return reduced if reduced.is_file() else candidate.qbf
+
+def add_to_corpus(
+    corpus_dir: Path,
+    candidate: Candidate,
+    qbf: Path,
+    score: float,
+) -> Path:
+    """
+    Copies 'qbf' into the corpus, with a header of its step, metric, and
+    score, which 'replay' compares to.
+    """
+    corpus_dir.mkdir(parents=True, exist_ok=True)
+    path = corpus_dir / f"{candidate.stage}.{candidate.metric}" \
+                        f".{candidate.qbf.stem}.qdimacs"
+    with open(qbf) as file:
+        content = file.read()
+    path.write_text(
+        f"c perffuzz stage={candidate.stage} metric={candidate.metric}"
+        f" score={score!r}\n{content}"
+    )
+    return path
+
+def search(args: Namespace) -> None:
+    stages: set[str] | None = None if (len(args.stages) == 0) \
+        else set(args.stages)
+    with TemporaryDirectory(prefix="ferat-perffuzz-") as tmp_name:
+        tmp_dir = Path(tmp_name)
+        overhead = measure_overhead(
+            args.deps_dir, tmp_dir, args.repeat, args.timeout
+        )
+        best: dict[tuple[str, str], Candidate] = {}
+        for i in range(args.iterations):
+            seed = args.seed + i
+            qbf = tmp_dir / f"fuzz-{seed!s}.qdimacs"
+            generate(
+                args.qbfuzz,
+                qbf,
+                seed,
+                args.max_vars,
+                args.max_clauses,
+                args.max_qsets,
+            )
+            num_bytes = qbf.stat().st_size
+            found = run_pipeline(
+                args.deps_dir, Instance(qbf, None), tmp_dir, args.timeout
+            )
+            for stage, usage in found.items():
+                if (stage not in overhead) \
+                    or ((stages is not None) and (stage not in stages)):
+                    continue
+                for metric in args.metrics:
+                    s = score(
+                        metric_value(usage, metric),
+                        metric_value(overhead[stage], metric),
+                        metric,
+                        num_bytes,
+                        args.floor,
+                    )
+                    key = (stage, metric)
+                    if (s <= 0) or ((key in best) and (s <= best[key].score)):
+                        continue
+                    best[key] = Candidate(stage, metric, qbf, s)
+            if not any(c.qbf == qbf for c in best.values()): qbf.unlink()
+        status(
+            f"Generated {args.iterations!s} QBFs, of which"
+            f" {len({c.qbf for c in best.values()})!s} are pathological"
+        )
+
+        for (stage, metric), candidate in sorted(best.items()):
+            # The score of a single run must hold up to repeated runs
+            qbf_bytes = candidate.qbf.stat().st_size
+            usage = measure(
+                args.deps_dir,
+                candidate.qbf,
+                tmp_dir,
+                args.repeat,
+                args.timeout,
+            ).get(stage)
+            if usage is None: continue
+            base = metric_value(overhead[stage], metric)
+            candidate.score = score(
+                metric_value(usage, metric),
+                base,
+                metric,
+                qbf_bytes,
+                args.floor,
+            )
+            if candidate.score <= 0: continue
+            reduced = minimize(args, candidate, base, tmp_dir)
+            usage = measure(
+                args.deps_dir, reduced, tmp_dir, args.repeat, args.timeout
+            ).get(stage)
+            reduced_bytes = reduced.stat().st_size
+            reduced_score = 0.0 if (usage is None) else score(
+                metric_value(usage, metric),
+                base,
+                metric,
+                reduced_bytes,
+                args.floor,
+            )
+            if reduced_score <= 0:
+                reduced, reduced_score, reduced_bytes = \
+                    candidate.qbf, candidate.score, qbf_bytes
+            path = add_to_corpus(
+                args.corpus_dir, candidate, reduced, reduced_score
+            )
+            status(
+                f"Added '{style(IMPORTANT, path.name)}' with"
+                f" {format_score(metric, reduced_score)}, minimized from"
+                f" {qbf_bytes!s} to {reduced_bytes!s} bytes"
+            )
+
+def oracle(args: Namespace) -> int:
+    """
+    Returns 1 if the QBF still scores at least 'args.score' in the step, which
+    qbfdd takes as the failure to keep, and 0 otherwise.
+    """
+    num_bytes = args.qbf.stat().st_size
+    with TemporaryDirectory(prefix="ferat-perffuzz-") as tmp_name:
+        usage = measure(
+            args.deps_dir, args.qbf, Path(tmp_name), args.repeat, args.timeout
+        ).get(args.stage)
+    if usage is None: return 0
+    return int(score(
+        metric_value(usage, args.metric),
+        args.overhead,
+        args.metric,
+        num_bytes,
+        args.floor,
+    ) >= args.score)
+
+def replay(args: Namespace) -> int:
+    """
+    Runs the pipeline on each instance of the corpus, and returns the number
+    of those whose score is more than 'args.factor' times what it was when it
+    was added.
+    """
+    instances = sorted(args.corpus_dir.glob("*.qdimacs"))
+    if len(instances) == 0:
+        fatal(ExitCode.CLI_ERR, f"No instances in '{args.corpus_dir!s}'")
+    num_regressions = 0
+    with TemporaryDirectory(prefix="ferat-perffuzz-") as tmp_name:
+        tmp_dir = Path(tmp_name)
+        overhead = measure_overhead(
+            args.deps_dir, tmp_dir, args.repeat, args.timeout
+        )
+        for qbf in instances:
+            with open(qbf) as file:
+                header = CORPUS_HEADER.match(file.readline())
+            if header is None:
+                warn(f"Skipping '{qbf.name}' without a perffuzz header")
+                continue
+            stage, metric, recorded = \
+                header.group(1), header.group(2), float(header.group(3))
+            usage = measure(
+                args.deps_dir, qbf, tmp_dir, args.repeat, args.timeout
+            ).get(stage)
+            if (usage is None) or (stage not in overhead):
+                warn(f"Step {stage} did not finish on '{qbf.name}'")
+                num_regressions += 1
+                continue
+            # No floor, such that improvements show as they are, down to
+            # where they are lost in noise
+            current = score(
+                metric_value(usage, metric),
+                metric_value(overhead[stage], metric),
+                metric,
+                qbf.stat().st_size,
+                0.0,
+            )
+            ratio = current / recorded
+            regressed = ratio > args.factor
+            num_regressions += regressed
+            status(
+                f"{qbf.name}: {format_score(metric, current)}"
+                f" ({style(BAD if regressed else GOOD, f'{ratio:.3f}x')}"
+                f" the recorded score)"
+            )
+    return num_regressions
+
+def format_score(metric: str, s: float) -> str:
+    if metric == Metrics.TIME: return f"{1e6 * s:.3f} us/B"
+    return f"{s:.1f} B/B"
+
+#  }}}
+
+#  Command Line {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Command Line ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def cli(parser: ArgumentParser) -> Namespace:
+    parser.add_argument(
+        "-d",
+        "--deps",
+        help="sets the path to the built dependencies (default = ./bin)",
+        default=Path(__file__).with_name("bin"),
+        type=Path,
+        dest="deps_dir",
+    )
+    parser.add_argument(
+        "--timeout",
+        help="limits each step of the pipeline to this many seconds, or no" \
+             " limit if set to 0 (default = 60)",
+        default=60.0,
+        type=float,
+        dest="timeout",
+    )
+    parser.add_argument(
+        "--repeat",
+        help="sets the number of runs whose least time and memory are" \
+             " scored, whenever a QBF is measured again (default = 3)",
+        default=3,
+        type=int,
+        dest="repeat",
+    )
+    parser.add_argument(
+        "--color",
+        help="sets the color mode (default = auto)",
+        choices=["auto", "always", "never"],
+        default="auto",
+        dest="color",
+    )
+    subparsers = parser.add_subparsers(
+        title="commands", required=True, dest="command"
+    )
+    corpus_dir = Path(__file__).parents[1] / "tests" / "ferat" / "perf"
+
+    #  Search Subparser {{{
+    #  ~~~~~~~~~~~~~~~~~~~~ Search Subparser ~~~~~~~~~~~~~~~~~~~~
+    search_parser = subparsers.add_parser(
+        Commands.SEARCH,
+        help="Generate QBFs with qbfuzz, and minimize those with the most" \
+             " time or memory per byte in a step into the corpus",
+    )
+    search_parser.add_argument(
+        "-n",
+        "--iterations",
+        help="sets the number of QBFs to generate (default = 200)",
+        default=200,
+        type=int,
+        dest="iterations",
+    )
+    search_parser.add_argument(
+        "--seed",
+        help="sets the seed of the first QBF, which is incremented for each" \
+             " other one (default = 0)",
+        default=0,
+        type=int,
+        dest="seed",
+    )
+    search_parser.add_argument(
+        "-s",
+        "--stage",
+        help="only scores this pipeline step, like 'generate.solve_qbf'," \
+             " 'generate.check_expansion', or 'generate.check_rat_proof'," \
+             " which may be given multiple times (default = all steps)",
+        action="append",
+        default=[],
+        dest="stages",
+    )
+    search_parser.add_argument(
+        "-m",
+        "--metric",
+        help="only scores this metric (default = both)",
+        action="append",
+        choices=METRICS,
+        default=None,
+        dest="metrics",
+    )
+    search_parser.add_argument(
+        "--max-vars",
+        help="sets the most variables of a QBF (default = 200)",
+        default=200,
+        type=int,
+        dest="max_vars",
+    )
+    search_parser.add_argument(
+        "--max-clauses",
+        help="sets the most clauses of a QBF (default = 2000)",
+        default=2000,
+        type=int,
+        dest="max_clauses",
+    )
+    search_parser.add_argument(
+        "--max-qsets",
+        help="sets the most quantifier blocks of a QBF (default = 6)",
+        default=6,
+        type=int,
+        dest="max_qsets",
+    )
+    search_parser.add_argument(
+        "--floor",
+        help="only scores steps that use this many times the time or memory" \
+             " of running on a trivial QBF (default = 3)",
+        default=3.0,
+        type=float,
+        dest="floor",
+    )
+    search_parser.add_argument(
+        "--keep",
+        help="keeps each reduction of qbfdd that scores at least this many" \
+             " times the unreduced QBF (default = 0.8)",
+        default=0.8,
+        type=float,
+        dest="keep",
+    )
+    search_parser.add_argument(
+        "--dd-mode",
+        help="sets the minimization strategy of qbfdd (default = ddmin)",
+        default="ddmin",
+        dest="dd_mode",
+    )
+    search_parser.add_argument(
+        "--dd-gran",
+        help="sets the minimization granularity of qbfdd, 'c' for clauses," \
+             " 'l' for literals, or 'b' for both (default = c)",
+        choices=["c", "l", "b"],
+        default="c",
+        dest="dd_gran",
+    )
+    search_parser.add_argument(
+        "--qbfuzz",
+        help="sets the path to qbfuzz (default = tests/deps/qbfuzz)",
+        default=_SCRIPTS_DIR / "qbfuzz" / "qbfuzz.py",
+        type=Path,
+        dest="qbfuzz",
+    )
+    search_parser.add_argument(
+        "--qbfdd",
+        help="sets the path to qbfdd (default = tests/deps/qbfdd)",
+        default=_SCRIPTS_DIR / "qbfdd" / "qbfdd.py",
+        type=Path,
+        dest="qbfdd",
+    )
+    #  }}}
+
+    #  Oracle Subparser {{{
+    #  ~~~~~~~~~~~~~~~~~~~~ Oracle Subparser ~~~~~~~~~~~~~~~~~~~~
+    oracle_parser = subparsers.add_parser(
+        Commands.ORACLE,
+        help="Exit with 1 if a QBF scores at least as given in a step, which" \
+             " is how 'search' runs qbfdd",
+    )
+    oracle_parser.add_argument("--stage", required=True, dest="stage")
+    oracle_parser.add_argument(
+        "--metric", choices=METRICS, required=True, dest="metric"
+    )
+    oracle_parser.add_argument(
+        "--score", type=float, required=True, dest="score"
+    )
+    oracle_parser.add_argument(
+        "--overhead", type=float, required=True, dest="overhead"
+    )
+    oracle_parser.add_argument(
+        "--floor", type=float, required=True, dest="floor"
+    )
+    oracle_parser.add_argument("qbf", type=Path)
+    #  }}}
+
+    #  Replay Subparser {{{
+    #  ~~~~~~~~~~~~~~~~~~~~ Replay Subparser ~~~~~~~~~~~~~~~~~~~~
+    replay_parser = subparsers.add_parser(
+        Commands.REPLAY,
+        help="Run the corpus, and flag the instances whose score grew",
+    )
+    replay_parser.add_argument(
+        "--factor",
+        help="flags instances that score more than this many times what" \
+             " they did when added (default = 2)",
+        default=2.0,
+        type=float,
+        dest="factor",
+    )
+    #  }}}
+
+    for sub_parser in (search_parser, replay_parser):
+        sub_parser.add_argument(
+            "corpus_dir",
+            help="sets the directory of the corpus" \
+                 " (default = tests/ferat/perf)",
+            nargs="?",
+            default=corpus_dir,
+            type=Path,
+        )
+    try:
+        return parser.parse_args(sys.argv[1:])
+    except (ArgumentError, ArgumentTypeError) as args_err:
+        fatal(ExitCode.CLI_ERR, args_err)
+
+#  }}}
+
+#  Main Entrypoint {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Main Entrypoint ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def main() -> NoReturn:
+    parser = ArgumentParser(
+        description="The FERAT performance fuzzer. Searches for small QBFs" \
+                    " that take the most time or memory per byte in a step" \
+                    " of the pipeline, minimizes them into a corpus, and" \
+                    " replays the corpus to catch regressions.",
+        allow_abbrev=True,
+    )
+    try:
+        args = cli(parser)
+        if args.color == "never": set_show_color(False)
+        elif args.color == "auto": set_show_color(sys.stdout.isatty())
+        else: set_show_color(True)
+        if args.repeat < 1:
+            fatal(ExitCode.CLI_ERR, "--repeat must be positive")
+
+        if args.command == Commands.ORACLE:
+            sys.exit(oracle(args))
+        elif args.command == Commands.SEARCH:
+            if args.metrics is None: args.metrics = list(METRICS)
+            for script in (args.qbfuzz, args.qbfdd):
+                if not script.is_file():
+                    fatal(ExitCode.CLI_ERR, f"'{script!s}' does not exist")
+            search(args)
+        else:
+            num_regressions = replay(args)
+            if num_regressions > 0:
+                status(f"{num_regressions!s} regressions")
+                sys.exit(ExitCode.PERFORMANCE_REGRESSION)
+    except FERATFatalError as ferr:
+        ferr.exit()
+    except (OSError, ValueError, subprocess.CalledProcessError) as err:
+        try:
+            fatal(ExitCode.FAIL, err)
+        except FERATFatalError as ferr:
+            ferr.exit()
+    sys.exit(0)
+
+if __name__ == "__main__":
+    main()
+
+#  }}}
+# vim: foldmethod=marker
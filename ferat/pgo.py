@@ -0,0 +1,354 @@
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import json
+import subprocess
+import sys
+from argparse import (
+    ArgumentError,
+    ArgumentParser,
+    ArgumentTypeError,
+    Namespace,
+)
+from dataclasses import asdict, dataclass
+from pathlib import Path
+from statistics import median
+from tempfile import TemporaryDirectory
+from typing import Final, NoReturn, Sequence, final
+
+from ferat.codes import ExitCode
+from ferat.proc import ResourceUsage
+from ferat.report import read_report
+from ferat.utils import (
+    BAD,
+    GOOD,
+    IMPORTANT,
+    FERATFatalError,
+    fatal,
+    set_show_color,
+    status,
+    style,
+)
+
+#  Instances {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Instances ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@final
+class Commands:
+    TRAIN: Final[str] = "train"
+    COMPARE: Final[str] = "compare"
+
+QBF_SUFFIXES: Final[tuple[str, ...]] = (".qdimacs", ".qdimacs.gz", ".q")
+
+@dataclass(frozen=True)
+class Instance:
+    """
+    A QBF, and the CNF expansion next to it with the same base name, if there
+    is one, which skips solving the QBF.
+    """
+    qbf: Path
+    expansion: Path | None
+
+def find_instances(paths: Sequence[Path]) -> list[Instance]:
+    files: list[Path] = []
+    for path in paths:
+        if path.is_dir():
+            files.extend(sorted(p for p in path.rglob("*") if p.is_file()))
+        else:
+            files.append(path)
+    instances = []
+    for qbf in files:
+        if not qbf.name.endswith(QBF_SUFFIXES): continue
+        base = qbf.name
+        for suffix in QBF_SUFFIXES:
+            base = base.removesuffix(suffix)
+        expansion = qbf.with_name(f"{base}.cnf")
+        instances.append(
+            Instance(qbf, expansion if expansion.is_file() else None)
+        )
+    return instances
+
+#  }}}
+
+#  Pipeline {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Pipeline ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def run_pipeline(
+    deps_dir: Path,
+    instance: Instance,
+    tmp_dir: Path,
+    timeout: float,
+) -> dict[str, ResourceUsage]:
+    """
+    Generates and checks a FERAT proof of 'instance' with the backends in
+    'deps_dir', and returns the resources of each step, prefixed by the
+    command that ran it. SAT instances only get as far as solving the QBF,
+    which still trains the QBF solver.
+    """
+    proof = tmp_dir / "proof.ferat"
+    report = tmp_dir / "report.json"
+    proof.unlink(missing_ok=True)
+    generate = (
+        "generate",
+        *(() if (instance.expansion is None) else (
+            "--expansion", str(instance.expansion),
+        )),
+        str(instance.qbf),
+        str(proof),
+    )
+    check = ("check", str(instance.qbf), str(proof))
+    stages: dict[str, ResourceUsage] = {}
+    for command in (generate, check):
+        if (command is check) and not proof.is_file(): break
+        report.unlink(missing_ok=True)
+        returncode = subprocess.run(
+            (
+                sys.executable,
+                "-m",
+                "ferat",
+                "--quiet",
+                "--color",
+                "never",
+                "--deps",
+                str(deps_dir),
+                "--timeout",
+                str(timeout),
+                "--report",
+                str(report),
+                "--tmp",
+                str(tmp_dir / "tmp"),
+                *command,
+            ),
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        ).returncode
+        if returncode == ExitCode.DEPS_NOT_FOUND:
+            fatal(
+                ExitCode.DEPS_NOT_FOUND,
+                f"Missing backends in '{deps_dir!s}'",
+            )
+        try:
+            steps = read_report(report)[0]["steps"]
+        except (OSError, ValueError, KeyError, IndexError):
+            continue
+        for step in steps:
+            name = f"{command[0]}.{step['step']}"
+            usage = ResourceUsage(**{
+                key: step[key] for key in asdict(ResourceUsage())
+            })
+            stages[name] = usage if (name not in stages) \
+                else stages[name] + usage
+    return stages
+
+def train(
+    deps_dir: Path,
+    instances: Sequence[Instance],
+    timeout: float,
+) -> None:
+    """
+    Runs the pipeline once on each instance with instrumented backends, which
+    write their profiles as they exit.
+    """
+    with TemporaryDirectory(prefix="ferat-pgo-") as tmp_name:
+        for instance in instances:
+            stages = run_pipeline(deps_dir, instance, Path(tmp_name), timeout)
+            status(
+                f"Trained on '{style(IMPORTANT, instance.qbf.name)}'"
+                f" in {sum(u.wall_s for u in stages.values()):.2f} s"
+            )
+
+def compare(
+    baseline_dir: Path,
+    optimized_dir: Path,
+    instances: Sequence[Instance],
+    num_runs: int,
+    timeout: float,
+) -> dict[str, dict[str, float]]:
+    """
+    Runs the pipeline on all instances with the baseline and the optimized
+    backends in turns, and returns the median of the total wall time of each
+    step over the runs of either, and the speedup of the optimized backends.
+    """
+    totals: dict[str, dict[str, list[float]]] = {}
+    with TemporaryDirectory(prefix="ferat-pgo-") as tmp_name:
+        for i in range(num_runs):
+            for build, deps_dir in (
+                ("baseline", baseline_dir),
+                ("optimized", optimized_dir),
+            ):
+                run: dict[str, float] = {}
+                for instance in instances:
+                    stages = run_pipeline(
+                        deps_dir, instance, Path(tmp_name), timeout
+                    )
+                    for name, usage in stages.items():
+                        run[name] = run.get(name, 0.0) + usage.wall_s
+                run["total"] = sum(run.values())
+                for name, wall_s in run.items():
+                    totals.setdefault(name, {"baseline": [], "optimized": []})
+                    totals[name][build].append(wall_s)
+                status(
+                    f"Finished run {i + 1!s} of {num_runs!s} of the {build}"
+                    f" in {run['total']:.2f} s"
+                )
+    results = {}
+    for name, builds in sorted(totals.items()):
+        if not (builds["baseline"] and builds["optimized"]): continue
+        baseline_s = median(builds["baseline"])
+        optimized_s = median(builds["optimized"])
+        results[name] = {
+            "baseline_s": baseline_s,
+            "optimized_s": optimized_s,
+            "speedup": baseline_s / optimized_s if (optimized_s > 0) else 1.0,
+        }
+    return results
+
+def print_speedups(results: dict[str, dict[str, float]]) -> None:
+    pad = max(len(name) for name in results)
+    status(f"{'step':<{pad}}  {'baseline':>10}  {'optimized':>10}  speedup")
+    for name, result in results.items():
+        speedup = result["speedup"]
+        color = GOOD if (speedup >= 1.0) else BAD
+        status(
+            f"{name:<{pad}}  {result['baseline_s']:>9.3f}s"
+            f"  {result['optimized_s']:>9.3f}s"
+            f"  {style(color, f'{speedup:.3f}x')}"
+        )
+
+#  }}}
+
+#  Command Line {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Command Line ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def cli(parser: ArgumentParser) -> Namespace:
+    parser.add_argument(
+        "--timeout",
+        help="limits each step of the pipeline to this many seconds, or no" \
+             " limit if set to 0 (default = 300)",
+        default=300.0,
+        type=float,
+        dest="timeout",
+    )
+    parser.add_argument(
+        "--color",
+        help="sets the color mode (default = auto)",
+        choices=["auto", "always", "never"],
+        default="auto",
+        dest="color",
+    )
+    subparsers = parser.add_subparsers(
+        title="commands", required=True, dest="command"
+    )
+    train_parser = subparsers.add_parser(
+        Commands.TRAIN,
+        help="Run the pipeline on each instance with instrumented backends",
+    )
+    train_parser.add_argument(
+        "deps_dir",
+        help="sets the directory of the instrumented backends",
+        type=Path,
+    )
+    compare_parser = subparsers.add_parser(
+        Commands.COMPARE,
+        help="Report the speedup of each step of optimized backends",
+    )
+    compare_parser.add_argument(
+        "--runs",
+        help="sets the number of runs of either build (default = 3)",
+        default=3,
+        type=int,
+        dest="runs",
+    )
+    compare_parser.add_argument(
+        "--json",
+        help="writes the time of each step and its speedup to this JSON" \
+             " file (default = no JSON)",
+        default=None,
+        type=Path,
+        dest="json",
+    )
+    compare_parser.add_argument(
+        "baseline_dir",
+        help="sets the directory of the baseline backends",
+        type=Path,
+    )
+    compare_parser.add_argument(
+        "optimized_dir",
+        help="sets the directory of the optimized backends",
+        type=Path,
+    )
+    for sub_parser in (train_parser, compare_parser):
+        sub_parser.add_argument(
+            "inputs",
+            help="sets the QBFs, or directories searched recursively for" \
+                 " them, whose CNF expansions are used if next to them",
+            type=Path,
+            nargs="+",
+        )
+    try:
+        return parser.parse_args(sys.argv[1:])
+    except (ArgumentError, ArgumentTypeError) as args_err:
+        fatal(ExitCode.CLI_ERR, args_err)
+
+#  }}}
+
+#  Main Entrypoint {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Main Entrypoint ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def main() -> NoReturn:
+    parser = ArgumentParser(
+        description="The FERAT profile-guided optimization driver. Trains" \
+                    " instrumented backends on the full pipeline, and" \
+                    " reports the speedup of the optimized backends.",
+        allow_abbrev=True,
+    )
+    try:
+        args = cli(parser)
+        if args.color == "never": set_show_color(False)
+        elif args.color == "auto": set_show_color(sys.stdout.isatty())
+        else: set_show_color(True)
+
+        instances = find_instances(args.inputs)
+        if len(instances) == 0:
+            fatal(ExitCode.CLI_ERR, "No QBFs in the given inputs")
+        timeout: float = args.timeout
+        if args.command == Commands.TRAIN:
+            train(args.deps_dir, instances, timeout)
+        else:
+            if args.runs < 1:
+                fatal(ExitCode.CLI_ERR, "--runs must be positive")
+            results = compare(
+                args.baseline_dir,
+                args.optimized_dir,
+                instances,
+                args.runs,
+                timeout,
+            )
+            if len(results) == 0:
+                fatal(ExitCode.FAIL, "No step finished with both builds")
+            print_speedups(results)
+            if args.json is not None:
+                args.json.write_text(json.dumps(results, indent=2))
+    except FERATFatalError as ferr:
+        ferr.exit()
+    except (OSError, ValueError, KeyError) as err:
+        try:
+            fatal(ExitCode.FAIL, err)
+        except FERATFatalError as ferr:
+            ferr.exit()
+    sys.exit(0)
+
+if __name__ == "__main__":
+    main()
+
+#  }}}
+# vim: foldmethod=marker
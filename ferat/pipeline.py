@@ -17,12 +17,35 @@ from argparse import (
 from functools import lru_cache, reduce
 from operator import or_
 from pathlib import Path
+from tempfile import mkdtemp
 from time import perf_counter_ns
-from typing import Final, Iterable, Iterator, NoReturn, Sequence, final
+from typing import (
+    Any,
+    Callable,
+    Final,
+    Iterable,
+    Iterator,
+    Mapping,
+    NoReturn,
+    Sequence,
+    final,
+)
 
+from ferat.batch import (
+    Job,
+    available_cpus,
+    run_batch,
+)
+from ferat.cache import ArtifactCache, cache_key, file_digest
 from ferat.codes import ExitCode
 from ferat.deps import Dependencies
-from ferat.proc import call_subprocess
+from ferat.proc import (
+    call_subprocess,
+    get_usage_records,
+    run_concurrently,
+    tee_pipe,
+)
+from ferat.report import instance_report, read_report, write_report
 from ferat.utils import (
     BAD,
     ENCODING,
@@ -37,7 +60,7 @@ from ferat.utils import (
     fatal,
     get_profile,
     get_show_color,
-    open_zip_agnostic,
+    has_ferat_index,
     set_profile,
     set_show_color,
     set_show_command,
@@ -63,8 +86,10 @@ class DepNames:
     kissat: Final[str] = "kissat"
     cadical: Final[str] = "cadical"
     drat_trim: Final[str] = "drat-trim"
+    lrat_check: Final[str] = "lrat-check"
     lrat_trim: Final[str] = "lrat-trim"
     ferat_tools: Final[str] = "ferat-tools"
+    ferat_check: Final[str] = "ferat-check"
 
     @classmethod
     def values(cls) -> Iterator[str]:
@@ -75,6 +100,15 @@ class DepNames:
         )
 
 LRAT_DEPENDENCIES: Final[set[str]] = {DepNames.cadical, DepNames.lrat_trim}
+# Only built next to drat-trim, without which 'check' splits the proof instead
+OPTIONAL_DEPENDENCIES: Final[set[str]] = {DepNames.ferat_check}
+
+# File name suffixes of FERAT proofs compressed with each format
+COMPRESS_SUFFIXES: Final[dict[str, str]] = {
+    "gz": ".gz",
+    "zstd": ".zst",
+    "xz": ".xz",
+}
 
 @final
 class Commands:
@@ -86,10 +120,12 @@ class Commands:
 class ProfileNames:
     QBF_SOLVE: Final[str] = "qbf_solve"
     GEN_RAT_PROOF: Final[str] = "gen_rat_proof"
+    GEN_LRAT_HINTS: Final[str] = "gen_lrat_hints"
     CHECK_RAT_PROOF: Final[str] = "check_rat_proof"
     CHECK_EXPANSION: Final[str] = "check_expansion"
     GEN_FERAT_PROOF: Final[str] = "gen_ferat_proof"
     SPLIT_FERAT: Final[str] = "split_ferat"
+    CHECK_FERAT_PROOF: Final[str] = "check_ferat_proof"
     TOTAL: Final[str] = "total"
 
 def start_profile() -> int:
@@ -132,6 +168,7 @@ def init_dependencies(dependencies_dir: Path, lrat: bool) -> Dependencies:
     dependencies = Dependencies(dependencies_dir)
     for name in DepNames.values():
         if (not lrat) and (name in LRAT_DEPENDENCIES): continue
+        if name in OPTIONAL_DEPENDENCIES: continue
         dependencies.add(name)
     if not dependencies.check():
         fatal(ExitCode.DEPS_NOT_FOUND, "Missing dependencies")
@@ -149,19 +186,52 @@ def check_rat_proof(
     lrat: bool,
     simple_cnf: Path | None = None,
     simple_rat: Path | None = None,
+    hints: bool = False,
+    binary: bool = False,
+    stdin: int | None = None,
+    threads: int = 1,
 ) -> tuple[Path, Path]:
     """
     Checking the correctness of the RAT proof, while optimizing it and
     trimming the input expansion. (Checker drat-trim by Wetzler,
     Heule, and Hunt, 2014.)
     """
+    # NOTE: If 'stdin' is given, drat-trim and lrat-check read the RAT proof
+    #       from it instead of 'rat', which is either still being written by
+    #       the SAT solver, or the RAT section of an indexed FERAT proof.
     # TODO: Update doc-string for LRAT
     start_time_us = start_profile()
     try:
+        if hints and not lrat:
+            # A hinted proof is already trimmed, so we only follow the hints
+            # with lrat-check instead of searching for them with drat-trim
+            assert (simple_cnf is None) and (simple_rat is None)
+            _, stdout, _, _ = call_subprocess(
+                args=(
+                    dependencies / DepNames.lrat_check,
+                    cnf,
+                    *((rat,) if (stdin is None) else ()),
+                ),
+                capture_stdout=True,
+                capture_stderr=True,
+                capture_color_stdout=OTHER_STDOUT,
+                capture_color_stderr=OTHER_STDERR,
+                expected_exit={0, 1},
+                stdin=stdin,
+            )
+            if RE_DIMACS_LINE("c", r"VERIFIED\s*$").search(stdout) is None:
+                fatal(
+                    ExitCode.INVALID_RAT_PROOF,
+                    style(BAD, "LRAT proof is invalid")
+                )
+            status(style(GOOD, "LRAT proof is valid"))
+            return cnf, rat
         _, stdout, _, _ = call_subprocess(
             args=(
                 dependencies / DepNames.lrat_trim,
-                "--no-binary",
+                *(() if binary else ("--no-binary",)),
+                "-j", # check trimmed clauses in parallel
+                str(threads),
                 cnf,
                 rat,
                 *(() if (simple_rat is None) else (simple_rat,)),
@@ -169,8 +239,9 @@ def check_rat_proof(
             ) if lrat else (
                 dependencies / DepNames.drat_trim,
                 cnf,
-                rat,
-                "-I", # force ASCII parse mode
+                *((rat,) if (stdin is None) else ()),
+                # force binary (and keep output binary) or ASCII parse mode
+                *(("-i", "-C") if binary else ("-I",)),
                 *(() if (simple_cnf is None) else ("-c", simple_cnf)),
                 *(() if (simple_rat is None) else ("-l", simple_rat)),
             ),
@@ -183,6 +254,7 @@ def check_rat_proof(
             # though 0 is the "success" condition, because drat-trim will
             # output an "error" when a proof is trivially unsat. For us, it
             # doesn't matter if it is trivial or not.
+            stdin=stdin,
         )
         # NOTE: See comment for "expected_exit" argument. We still see
         #       's VERIFIED' when it is trivially unsat!
@@ -196,29 +268,11 @@ def check_rat_proof(
         if simple_cnf is not None:
             # If the output of "drat-trim" is trivially unsatisfiable,
             # there will not be an optimized RAT or trimmed expansion.
+            # NOTE: Our modified versions of drat-trim and lrat-trim copy the
+            #       'c x' mapping comments, and reconstruct the 'c o' mapping
+            #       comment, when a core is extracted, so the trimmed CNF is
+            #       a complete expansion as it is
             if simple_cnf.is_file():
-                # If we want to extract the trimmed CNF, we need to copy over
-                # the comments of the CNF to preserve the mappings
-                with (
-                    open_zip_agnostic(cnf, "r") as cnf_file,
-                    open_zip_agnostic(simple_cnf, "r+") as simple_cnf_file,
-                ):
-                    # We need this list, because comments must go first in the
-                    # final output
-                    # WARNING: The 'c o' mapping comment is ALREADY EXPORTED by
-                    #          our modified version of drat-trim, when a core
-                    #          is extracted using '-c ...'
-                    lines = [
-                        *(
-                            f"{match_[0]}\n"
-                            for match_ in RE_DIMACS_LINE("c", "x", ".*$")
-                            .finditer(cnf_file.read())
-                        ),
-                        *simple_cnf_file.readlines(),
-                    ]
-                    simple_cnf_file.seek(0, os.SEEK_SET)
-                    simple_cnf_file.truncate(0)
-                    simple_cnf_file.writelines(lines)
                 return_cnf = simple_cnf
             else:
                 output_warning = True
@@ -244,15 +298,20 @@ def check_expansion(
     dependencies: Dependencies,
     qbf: Path,
     cnf: Path,
+    snapshot_dir: Path | None = None,
 ) -> None:
     """
     Checking the correctness of the FERAT proof's expansion step using the
     original QBF and the expanded CNF clauses. (FERAT-tools by Simader, and
-    Seidl in 2024)
+    Seidl in 2024) With a cache, the parsed QBF is kept as a snapshot, so
+    that checking the same QBF again skips parsing it.
     """
     returncode, _, _, time_us = call_subprocess(
         args=(
             dependencies / DepNames.ferat_tools,
+            *(() if (snapshot_dir is None) else (
+                f"--snapshot-dir={snapshot_dir!s}",
+            )),
             qbf,
             cnf,
         ),
@@ -324,6 +383,8 @@ def gen_rat_proof(
     cnf: Path,
     rat: Path,
     lrat: bool,
+    binary: bool = False,
+    pass_fds: Sequence[int] = (),
 ) -> None:
     """
     Calling a SAT solver on the obtained expansion clauses in CNF to generate a
@@ -336,7 +397,7 @@ def gen_rat_proof(
             dependencies / DepNames.cadical,
             *(() if get_show_color() else ("--no-colors",)),
             "--unsat",
-            "--no-binary",
+            *(() if binary else ("--no-binary",)),
             "--lrat",
             "-q",
             cnf,
@@ -345,7 +406,7 @@ def gen_rat_proof(
             dependencies / DepNames.kissat,
             *(() if get_show_color() else ("--no-colors",)),
             "--unsat",
-            "--no-binary",
+            *(() if binary else ("--no-binary",)),
             "-q",
             cnf,
             rat,
@@ -355,6 +416,7 @@ def gen_rat_proof(
         capture_color_stdout=OTHER_STDOUT,
         capture_color_stderr=OTHER_STDERR,
         expected_exit={10, 20},
+        pass_fds=pass_fds,
     )
     try:
         if returncode == 10:
@@ -368,6 +430,105 @@ def gen_rat_proof(
 
 #  }}}
 
+#  stream_rat_proof {{{
+#  ~~~~~~~~~~~~~~~~~~~~ stream_rat_proof ~~~~~~~~~~~~~~~~~~~~
+def stream_rat_proof(
+    dependencies: Dependencies,
+    cnf: Path,
+    rat: Path,
+    simple_cnf: Path,
+    simple_rat: Path,
+    binary: bool = False,
+) -> tuple[Path, Path]:
+    """
+    Runs 'gen_rat_proof' and 'check_rat_proof' at the same time. The RAT
+    proof is piped from the SAT solver into drat-trim, and teed into 'rat' for
+    the later stages, which need it if drat-trim does not optimize it.
+    """
+    solver_read_fd, solver_write_fd = os.pipe()
+    check_read_fd, check_write_fd = os.pipe()
+    tee = tee_pipe(solver_read_fd, check_write_fd, rat)
+    try:
+        # The verdict of the SAT solver comes first, since drat-trim fails
+        # whenever the SAT solver does
+        solver_result, check_result = run_concurrently(
+            lambda: gen_rat_proof(
+                dependencies,
+                cnf,
+                Path(f"/dev/fd/{solver_write_fd!s}"),
+                False,
+                binary,
+                pass_fds=(solver_write_fd,),
+            ),
+            lambda: check_rat_proof(
+                dependencies,
+                cnf,
+                rat,
+                False,
+                simple_cnf,
+                simple_rat,
+                binary=binary,
+                stdin=check_read_fd,
+            ),
+            cancel=False,
+        )
+    finally:
+        tee.join()
+    if isinstance(solver_result, BaseException): raise solver_result
+    if isinstance(check_result, BaseException): raise check_result
+    return check_result
+
+#  }}}
+
+#  gen_lrat_hints {{{
+#  ~~~~~~~~~~~~~~~~~~~~ gen_lrat_hints ~~~~~~~~~~~~~~~~~~~~
+@status_function
+def gen_lrat_hints(
+    dependencies: Dependencies,
+    cnf: Path,
+    rat: Path,
+    lrat: Path,
+    binary: bool = False,
+) -> bool:
+    """
+    Annotating the (trimmed) RAT proof with the hints found by drat-trim, so
+    that the FERAT proof can later be checked in linear time. The clause
+    indices of the LRAT proof refer to the given CNF.
+    """
+    start_time_us = start_profile()
+    try:
+        _, stdout, _, _ = call_subprocess(
+            args=(
+                dependencies / DepNames.drat_trim,
+                cnf,
+                rat,
+                # force binary (and keep output binary) or ASCII parse mode
+                *(("-i", "-C") if binary else ("-I",)),
+                "-L",
+                lrat,
+            ),
+            capture_stdout=True,
+            capture_stderr=True,
+            capture_color_stdout=OTHER_STDOUT,
+            capture_color_stderr=OTHER_STDERR,
+            expected_exit={0, 1},
+        )
+        if RE_DIMACS_LINE("s", r"VERIFIED\s*$").search(stdout) is None:
+            fatal(
+                ExitCode.INVALID_RAT_PROOF, style(BAD, "RAT proof is invalid")
+            )
+        # Without any LRAT lines, there is nothing to embed, and we fall back
+        # to the unhinted RAT proof
+        if (not lrat.is_file()) or (lrat.stat().st_size == 0):
+            warn("No LRAT proof produced by drat-trim, no hints embedded")
+            return False
+        status(style(GOOD, "Generated LRAT hints"))
+        return True
+    finally:
+        end_profile(ProfileNames.GEN_LRAT_HINTS, start_time_us)
+
+#  }}}
+
 #  gen_ferat_proof {{{
 #  ~~~~~~~~~~~~~~~~~~~~ gen_ferat_proof ~~~~~~~~~~~~~~~~~~~~
 @status_function
@@ -376,37 +537,44 @@ def gen_ferat_proof(
     cnf: Path,
     rat: Path,
     output: Path,
+    hints: bool = False,
+    binary: bool = False,
+    index: bool = False,
+    compress: str | None = None,
 ) -> None:
     """
     Merging the expansion of the QBF solver with the RAT proof of the SAT solver
-    to create a \\forall-Exp+RAT (FERAT) proof.
+    to create a \\forall-Exp+RAT (FERAT) proof. This is a single streaming
+    pass of FERAT-tools, which compresses the proof on all cores if asked to,
+    or if its name ends in '.gz', '.zst', or '.xz'.
     """
-    start_time_us = start_profile()
+    _, _, _, time_us = call_subprocess(
+        args=(
+            dependencies / DepNames.ferat_tools,
+            "merge",
+            # Marks proofs whose RAT part is in LRAT format with a leading 'l'
+            # line, so that checking only needs to follow the hints
+            *(("--hints",) if hints else ()),
+            # A binary (L)RAT proof is copied verbatim after a 'b' line
+            *(("--binary",) if binary else ()),
+            # An index of the sections lets checking read the RAT proof
+            # straight out of the FERAT proof, and is skipped for gzip
+            *(("--index",) if index else ()),
+            *(() if (compress is None) else (f"--compress={compress!s}",)),
+            cnf,
+            rat,
+            output,
+        ),
+        capture_stdout=True,
+        capture_stderr=True,
+        capture_color_stdout=OTHER_STDOUT,
+        capture_color_stderr=OTHER_STDERR,
+        expected_exit=0,
+    )
     try:
-        with open(output, "w", **ENCODING) as output_file:
-            # First, comment all lines of the CNF expansion and write it to the
-            # FERAT output
-            with open_zip_agnostic(cnf, "r") as cnf_file:
-                for cnf_line in cnf_file.readlines():
-                    if RE_DIMACS_LINE("p").match(cnf_line): continue
-                    match_ = RE_DIMACS_LINE("c", "([xo].*)$").match(cnf_line)
-                    if match_ is None:
-                        if RE_DIMACS_LINE("c").match(cnf_line):
-                            # Regular comment, just copied over
-                            output_file.write(cnf_line)
-                            continue
-                        # Regular clause, turned into 'ex' line
-                        output_file.write(f"e {cnf_line!s}")
-                    else:
-                        # 'c x' or 'c o' header turned into just 'x' and 'o'
-                        output_file.write(f"{match_[1]!s}\n")
-            # Second, read the RAT proof and write it to the FERAT file
-            # directly, so that drat-trim can process it as it is
-            with open_zip_agnostic(rat, "r") as drat_file:
-                output_file.write(drat_file.read())
         status(f"Generated FERAT proof")
     finally:
-        end_profile(ProfileNames.GEN_FERAT_PROOF, start_time_us)
+        end_profile(ProfileNames.GEN_FERAT_PROOF, int(time_us), no_start=True)
 
 #  }}}
 
@@ -415,54 +583,105 @@ def gen_ferat_proof(
 #  split_ferat {{{
 #  ~~~~~~~~~~~~~~~~~~~~ split_ferat ~~~~~~~~~~~~~~~~~~~~
 @status_function
-def split_ferat(ferat: Path, cnf: Path, rat: Path) -> None:
-    """ Splitting the FERAT proof into its CNF and RAT components. """
-    start_time_us = start_profile()
+def split_ferat(
+    dependencies: Dependencies,
+    ferat: Path,
+    cnf: Path,
+    rat: Path | None,
+) -> tuple[bool, bool, tuple[int, int] | None]:
+    """
+    Splitting the FERAT proof into its CNF and RAT components in a single
+    streaming pass of FERAT-tools. Returns whether the RAT component is a
+    hinted LRAT proof, whether it is binary, and its offset and size if the
+    proof is indexed, in which case it does not need to be written out.
+    """
+    _, stdout, _, time_us = call_subprocess(
+        args=(
+            dependencies / DepNames.ferat_tools,
+            "split",
+            ferat,
+            cnf,
+            *(() if (rat is None) else (rat,)),
+        ),
+        capture_stdout=True,
+        capture_stderr=True,
+        capture_color_stdout=OTHER_STDOUT,
+        capture_color_stderr=OTHER_STDERR,
+        expected_exit=0,
+    )
     try:
-        with (
-            open_zip_agnostic(ferat, "r") as ferat_file,
-            open(cnf, "w", **ENCODING) as cnf_file,
-            open(rat, "w", **ENCODING) as rat_file,
-        ):
-            max_var = num_clauses = insert_p_header_before = 0
-            for i, ferat_line in enumerate(ferat_file.readlines()):
-                match_ = RE_DIMACS_LINE("e", "(.*)$").match(ferat_line)
-                if match_ is None:
-                    # IMPORTANT: We need to match as little as possible to only
-                    #            get the first part of the
-                    #            'c x <exp_vars> 0 <qbf_vars> 0 <annots> 0'
-                    match_ = RE_DIMACS_LINE("x", "(.*?)", "0",
-                                            ".*$").match(ferat_line)
-                    if match_ is None: continue
-                else:
-                    # TODO: The 'p cnf ...' header has to come after the 'c x'
-                    #       and 'c o' comments, unfortunately. Maybe a fix for
-                    #       this would be nice in the future..?
-                    if insert_p_header_before < 1: insert_p_header_before = i
-                    num_clauses = num_clauses + 1
-                # Capture group 1 must always contain a space-delimited list of
-                # variables
-                max_var = max(
-                    (max_var, *(abs(int(num)) for num in match_[1].split()))
-                )
-            ferat_file.seek(0, os.SEEK_SET)
-            for i, ferat_line in enumerate(ferat_file.readlines()):
-                match_ = RE_DIMACS_LINE("([eox])", "(.*)$").match(ferat_line)
-                # See comment above for 'p cnf ...' header
-                if i == insert_p_header_before:
-                    cnf_file.write(f"p cnf {max_var!s} {num_clauses!s}\n")
-                # RAT line
-                if match_ is None:
-                    rat_file.write(ferat_line)
-                # All others here are part of the expansion, indices are
-                # capture groups
-                elif match_[1] == "e":
-                    cnf_file.write(f"{match_[2]!s}\n")
-                else:
-                    cnf_file.write(f"c {match_[1]!s} {match_[2]!s}\n")
+        flags = {
+            match_[1]: match_[2] == "1"
+            for match_ in RE_DIMACS_LINE(
+                "c", "(hints|binary)", r"([01])\s*$"
+            ).finditer(stdout)
+        }
+        rat_range = RE_DIMACS_LINE("c", "rat", r"(\d+)\s+(\d+)\s*$").search(
+            stdout
+        )
         status(f"Split FERAT proof")
+        return (
+            flags.get("hints", False),
+            flags.get("binary", False),
+            None if (rat_range is None)
+            else (int(rat_range[1]), int(rat_range[2])),
+        )
     finally:
-        end_profile(ProfileNames.SPLIT_FERAT, start_time_us)
+        end_profile(ProfileNames.SPLIT_FERAT, int(time_us), no_start=True)
+
+#  }}}
+
+#  check_ferat_proof {{{
+#  ~~~~~~~~~~~~~~~~~~~~ check_ferat_proof ~~~~~~~~~~~~~~~~~~~~
+@status_function
+def check_ferat_proof(
+    dependencies: Dependencies,
+    qbf: Path,
+    ferat: Path,
+    snapshot_dir: Path | None = None,
+) -> None:
+    """
+    Checking the FERAT proof in a single process, without splitting it
+    first. (ferat-check of FERAT-tools, which links the checking cores of
+    drat-trim and lrat-check.) The expansion clauses are parsed once, and
+    the expansion and the RAT proof are checked side by side on them.
+    """
+    returncode, stdout, _, time_us = call_subprocess(
+        args=(
+            dependencies / DepNames.ferat_check,
+            *(() if (snapshot_dir is None) else (
+                f"--snapshot-dir={snapshot_dir!s}",
+            )),
+            qbf,
+            ferat,
+        ),
+        capture_stdout=True,
+        capture_stderr=True,
+        capture_color_stdout=OTHER_STDOUT,
+        capture_color_stderr=OTHER_STDERR,
+        expected_exit={10, 20},
+    )
+    try:
+        if returncode != 10:
+            # The first check to fail names itself in the verdict
+            if re.search(r"\(RAT proof is invalid\)", stdout) is not None:
+                fatal(
+                    ExitCode.INVALID_RAT_PROOF,
+                    style(BAD, "RAT proof is invalid"),
+                )
+            fatal(
+                ExitCode.INVALID_FERAT_PROOF,
+                f"{style(BAD, 'FERAT proof is invalid')}"
+                f" (expansion is unsound)",
+            )
+        status(
+            f"{style(GOOD, 'FERAT proof is valid')} (expansion is sound, and"
+            f" RAT proof is valid)"
+        )
+    finally:
+        end_profile(
+            ProfileNames.CHECK_FERAT_PROOF, int(time_us), no_start=True
+        )
 
 #  }}}
 
@@ -537,6 +756,15 @@ def cli(parser: ArgumentParser) -> Namespace:
         type=float,
         dest="timeout",
     )
+    misc_group.add_argument(
+        "--threads",
+        help="sets the number of threads of the checkers, or one per CPU" \
+             " this process may run on if set to 0. Batch jobs share the" \
+             " CPUs among themselves (default = 0)",
+        default=0,
+        type=int,
+        dest="threads",
+    )
     misc_group.add_argument(
         "-K",
         "--keep-tmp",
@@ -581,6 +809,32 @@ def cli(parser: ArgumentParser) -> Namespace:
         default=False,
         dest="profile",
     )
+    misc_group.add_argument(
+        "--cache",
+        help="sets a directory in which the results of the expensive" \
+             " pipeline steps are kept, and reused for the same input," \
+             " tools, and options (default = no cache)",
+        default=None,
+        type=Path,
+        dest="cache_dir",
+    )
+    misc_group.add_argument(
+        "--cache-size",
+        help="limits the size of the cache in MiB, evicting the least" \
+             " recently used results, or no limit if set to 0 (default = 0)",
+        default=0,
+        type=int,
+        dest="cache_size",
+    )
+    misc_group.add_argument(
+        "--report",
+        help="writes the time, memory, and I/O used by each step to the" \
+             " given file, as CSV if its name ends in '.csv', and as JSON" \
+             " otherwise (default = no report)",
+        default=None,
+        type=Path,
+        dest="report",
+    )
     # }}}
     #  }}}
 
@@ -599,6 +853,78 @@ def cli(parser: ArgumentParser) -> Namespace:
     gen_parser = subparsers.add_parser(
         Commands.GENERATE, help="Generate a FERAT proof from a QBF"
     )
+    gen_mode_group = gen_parser.add_argument_group(title="mode")
+    gen_mode_group.add_argument(
+        "--hints",
+        help="embeds the RAT proof in LRAT format, such that checking only" \
+             " needs to follow the hints (default = True)",
+        action=BooleanOptionalAction,
+        default=True,
+        dest="hints",
+    )
+    gen_mode_group.add_argument(
+        "--binary",
+        help="keeps the RAT proof in binary format from the SAT solver" \
+             " into the FERAT proof (default = True)",
+        action=BooleanOptionalAction,
+        default=True,
+        dest="binary",
+    )
+    gen_mode_group.add_argument(
+        "--stream",
+        help="keeps intermediate files in memory (/dev/shm), and pipes the" \
+             " RAT proof from the SAT solver straight into drat-trim" \
+             " (default = False)",
+        action=BooleanOptionalAction,
+        default=False,
+        dest="stream",
+    )
+    gen_mode_group.add_argument(
+        "--index",
+        help="starts the FERAT proof with an index of its sections, such" \
+             " that checking reads the RAT proof straight out of it, unless" \
+             " the proof is gzipped (default = True)",
+        action=BooleanOptionalAction,
+        default=True,
+        dest="index",
+    )
+    gen_mode_group.add_argument(
+        "--compress",
+        help="compresses the FERAT proof with the given format on all cores," \
+             " and names proofs written to an output folder accordingly" \
+             " (default = by the suffix of the output)",
+        choices=tuple(COMPRESS_SUFFIXES),
+        default=None,
+        dest="compress",
+    )
+    gen_batch_group = gen_parser.add_argument_group(title="batch")
+    gen_batch_group.add_argument(
+        "-j",
+        "--jobs",
+        help="sets the number of input files processed in parallel, or one" \
+             " per CPU if set to 0 (default = 1)",
+        default=1,
+        type=int,
+        dest="jobs",
+    )
+    gen_batch_group.add_argument(
+        "--job-memory",
+        help="limits the address space in MiB of each process of a job, or" \
+             " no limit if set to 0. Multi-threaded tools reserve far more" \
+             " address space than they use, so this is best set well above" \
+             " their resident memory (default = 0)",
+        default=0,
+        type=int,
+        dest="job_memory",
+    )
+    gen_batch_group.add_argument(
+        "--job-cpu-time",
+        help="limits the CPU time in seconds of each process of a job, or no" \
+             " limit if set to 0 (default = 0)",
+        default=0,
+        type=int,
+        dest="job_cpu_time",
+    )
     gen_file_group = gen_parser.add_argument_group(title="files")
     gen_file_group.add_argument(
         "--expansion",
@@ -628,6 +954,16 @@ def cli(parser: ArgumentParser) -> Namespace:
     check_parser = subparsers.add_parser(
         Commands.CHECK, help="Check an existing FERAT proof with a given QBF"
     )
+    check_mode_group = check_parser.add_argument_group(title="mode")
+    check_mode_group.add_argument(
+        "--native",
+        help="checks the FERAT proof with ferat-check, which reads it only" \
+             " once, if it was built, instead of splitting it for drat-trim" \
+             " and FERAT-tools (default = True)",
+        action=BooleanOptionalAction,
+        default=True,
+        dest="native",
+    )
     check_file_group = check_parser.add_argument_group(title="files")
     check_file_group.add_argument(
         "qbf",
@@ -667,6 +1003,11 @@ def main() -> NoReturn:
     # that 'tmp_dir' is never accessed too early
     keep_tmp: bool = True
     tmp_dir: Path = Path("./tmp")
+    memory_dir: Path | None = None
+    # Likewise for the report, which is written for failed runs as well
+    report: Path | None = None
+    report_instances: list[dict[str, Any]] | None = None
+    exit_code: int = ExitCode.FAIL
     start_time_us = start_profile()
     try:
         # get arguments into a nice form with types
@@ -677,11 +1018,15 @@ def main() -> NoReturn:
         verbose: bool = args.verbose
         quiet: bool = args.quiet
         timeout: float = args.timeout
+        threads: int = args.threads or available_cpus()
         keep_tmp = args.keep_tmp
         tmp_dir = args.tmp_dir
         deps_dir: Path = args.deps_dir
         color: str = args.color
         profile: bool = args.profile
+        cache_dir: Path | None = args.cache_dir
+        cache_size: int = args.cache_size
+        report = args.report
 
         # Set globals
         set_timeout(timeout)
@@ -716,6 +1061,28 @@ def main() -> NoReturn:
             os.makedirs(tmp_dir, mode=0o755, exist_ok=True)
         # Set up dependencies
         dependencies = init_dependencies(deps_dir, lrat)
+        cache = None if (cache_dir is None) else ArtifactCache(
+            cache_dir, (cache_size * (1 << 20)) if (cache_size > 0) else None
+        )
+        snapshot_dir = None if (cache is None) else cache.snapshot_dir
+
+        def cached(
+            name: str,
+            key_parts: Sequence[Any],
+            outputs: Mapping[str, Path],
+            stage: Callable[[], Any],
+            failures: set[int] = set(),
+            inputs: Mapping[str, Path] = {},
+        ) -> Any:
+            if cache is None: return stage()
+            return cache.run(
+                name,
+                cache_key(name, *key_parts),
+                outputs,
+                stage,
+                failures,
+                inputs,
+            )
 
         status(f"Command chosen is {style(IMPORTANT, command)}")
 
@@ -726,6 +1093,11 @@ def main() -> NoReturn:
                 = args.expansion if ("expansion" in args) else None
             qbfs: Sequence[Path] = args.input
             output: Path = args.output
+            hints: bool = args.hints
+            binary: bool = args.binary
+            stream: bool = args.stream
+            index: bool = args.index
+            compress: str | None = args.compress
             # If the command picked is 'generate', we can create and check the
             # RAT separately, and then combine it into FERAT to save some time
 
@@ -754,62 +1126,293 @@ def main() -> NoReturn:
             # If 'ouput' is a folder, use the input name(s)
             outputs: Sequence[Path]
             if output.is_dir():
+                suffix = "" if (compress is None) \
+                    else COMPRESS_SUFFIXES[compress]
                 outputs = tuple(
-                    output.joinpath(f"{i.stem}.ferat") for i in qbfs
+                    output.joinpath(f"{i.stem}.ferat{suffix!s}") for i in qbfs
                 )
             else:
                 outputs = (output,)
+            if len(set(outputs)) < len(outputs):
+                fatal(
+                    ExitCode.CLI_ERR,
+                    "Multiple input files share the same name, so their"
+                    " FERAT proofs would overwrite each other",
+                )
+
+            # Multiple inputs are processed as a batch of isolated pipeline
+            # processes, each with its own temporary directory
+            if num_in > 1:
+                num_jobs = args.jobs if (args.jobs > 0) else available_cpus()
+                if num_jobs > available_cpus():
+                    warn(
+                        f"Running {num_jobs} jobs on only {available_cpus()}"
+                        f" CPUs"
+                    )
+                job_memory = (args.job_memory * (1 << 20)) or None
+                job_cpu_time = args.job_cpu_time or None
+                width = len(str(num_in))
+                jobs = [
+                    Job(
+                        qbf,
+                        output,
+                        tmp_dir / f"job-{i:0{width}d}-{qbf.stem!s}",
+                    ) for i, (qbf, output) in enumerate(zip(qbfs, outputs))
+                ]
 
-            for qbf, output in zip(qbfs, outputs):
+                def job_report(job: Job) -> Path:
+                    return job.tmp_dir.with_name(f"{job.tmp_dir.name}.json")
+
+                def job_args(job: Job) -> Sequence[str]:
+                    return (
+                        sys.executable,
+                        "-m",
+                        "ferat",
+                        "--lrat" if lrat else "--no-lrat",
+                        "--quiet",
+                        "--color",
+                        "never",
+                        "--timeout",
+                        str(timeout),
+                        "--threads",
+                        str(max(1, threads // num_jobs)),
+                        "--deps",
+                        str(deps_dir),
+                        *(() if (cache_dir is None) else (
+                            "--cache", str(cache_dir),
+                            "--cache-size", str(cache_size),
+                        )),
+                        *(() if (report is None) else (
+                            "--report", str(job_report(job)),
+                        )),
+                        "--tmp",
+                        str(job.tmp_dir),
+                        "--keep-tmp" if keep_tmp else "--no-keep-tmp",
+                        Commands.GENERATE,
+                        "--hints" if hints else "--no-hints",
+                        "--binary" if binary else "--no-binary",
+                        "--stream" if stream else "--no-stream",
+                        "--index" if index else "--no-index",
+                        *(() if (compress is None) else (
+                            "--compress", compress,
+                        )),
+                        str(job.qbf),
+                        str(job.output),
+                    )
+
+                status(
+                    f"Processing {num_in} inputs with {num_jobs} job(s)"
+                )
+                num_failed = run_batch(
+                    jobs, job_args, num_jobs, job_memory, job_cpu_time
+                )
+                if report is not None:
+                    report_instances = []
+                    for job in jobs:
+                        try:
+                            report_instances += read_report(job_report(job))
+                        except (OSError, ValueError, KeyError):
+                            # The job did not get far enough to report
+                            report_instances.append(instance_report(
+                                job.qbf,
+                                command,
+                                job.returncode or 0,
+                                job.time_s,
+                                (),
+                            ))
+                if num_failed > 0:
+                    fatal(
+                        ExitCode.BATCH_FAILED,
+                        f"{num_failed} of {num_in} inputs failed",
+                    )
+            else:
+                qbf, output = qbfs[0], outputs[0]
                 status("")
                 status(f"Processing '{style(IMPORTANT, qbf)}'")
 
-                # name tmp files
+                # name tmp files, which are kept in memory when streaming
                 out_stem = output.stem
-                rat = tmp_dir / f"{out_stem!s}.rat"
-                simple_cnf: Path = tmp_dir / f"{out_stem!s}-simplified.cnf"
-                simple_rat: Path = tmp_dir / f"{out_stem!s}-simplified.rat"
+                work_dir = tmp_dir
+                if stream and Path("/dev/shm").is_dir():
+                    memory_dir = Path(
+                        mkdtemp(prefix=f"ferat-{out_stem!s}-", dir="/dev/shm")
+                    )
+                    work_dir = memory_dir
+                elif stream:
+                    warn(
+                        "No '/dev/shm' found, intermediate files stay on disk"
+                    )
+                rat = work_dir / f"{out_stem!s}.rat"
+                simple_cnf: Path = work_dir / f"{out_stem!s}-simplified.cnf"
+                simple_rat: Path = work_dir / f"{out_stem!s}-simplified.rat"
+                simple_lrat: Path = work_dir / f"{out_stem!s}-simplified.lrat"
 
                 # if '--expansion' is given, we know that the provided file
                 # *has* to be associated with this one input/output tuple
                 if expansion is None:
-                    cnf = tmp_dir / f"{out_stem!s}.cnf"
+                    cnf = work_dir / f"{out_stem!s}.cnf"
                     # solve QBF and generate CNF expansion
-                    solve_qbf(dependencies, qbf, cnf)
+                    cached(
+                        "solve_qbf",
+                        (
+                            file_digest(qbf),
+                            file_digest(dependencies / DepNames.ijtihad),
+                        ),
+                        {"expansion": cnf},
+                        lambda: solve_qbf(dependencies, qbf, cnf),
+                        {ExitCode.QBF_SAT},
+                    )
                 else:
                     status(f"Using given expansion")
                     cnf = expansion
                 # Create and check RAT proof, simplify to RAT' and CNF' (as
                 # minimal unsatisfiable core)
-                gen_rat_proof(dependencies, cnf, rat, lrat)
-                ferat_cnf, ferat_rat = check_rat_proof(
-                    dependencies, cnf, rat, lrat, simple_cnf, simple_rat
+                def rat_proof() -> tuple[Path, Path]:
+                    if stream and not lrat:
+                        return stream_rat_proof(
+                            dependencies,
+                            cnf,
+                            rat,
+                            simple_cnf,
+                            simple_rat,
+                            binary,
+                        )
+                    gen_rat_proof(dependencies, cnf, rat, lrat, binary)
+                    return check_rat_proof(
+                        dependencies,
+                        cnf,
+                        rat,
+                        lrat,
+                        simple_cnf,
+                        simple_rat,
+                        binary=binary,
+                        threads=threads,
+                    )
+
+                ferat_cnf: Path
+                ferat_rat: Path
+                ferat_cnf, ferat_rat = cached(
+                    "rat_proof",
+                    (
+                        file_digest(cnf),
+                        *(
+                            file_digest(dependencies / tool) for tool in (
+                                (DepNames.cadical, DepNames.lrat_trim) if lrat
+                                else (DepNames.kissat, DepNames.drat_trim)
+                            )
+                        ),
+                        lrat,
+                        binary,
+                    ),
+                    {"rat": rat, "core": simple_cnf, "proof": simple_rat},
+                    rat_proof,
+                    {ExitCode.EXPANSION_SAT},
+                    {"expansion": cnf},
                 )
                 # Input QBF and CNF' to check expansion step
-                check_expansion(dependencies, qbf, ferat_cnf)
+                check_expansion(dependencies, qbf, ferat_cnf, snapshot_dir)
+                # In LRAT mode, RAT' already carries hints. Otherwise, we let
+                # drat-trim find them for CNF' and RAT'
+                hinted = lrat
+                if hints and not lrat:
+                    hinted = gen_lrat_hints(
+                        dependencies, ferat_cnf, ferat_rat, simple_lrat, binary
+                    )
+                    if hinted: ferat_rat = simple_lrat
                 # Generate FERAT proof, which is a mix of CNF' and (d)RAT'
-                gen_ferat_proof(dependencies, ferat_cnf, ferat_rat, output)
+                gen_ferat_proof(
+                    dependencies,
+                    ferat_cnf,
+                    ferat_rat,
+                    output,
+                    hinted,
+                    binary,
+                    index,
+                    compress,
+                )
         #  }}}
         #  Check Command {{{
         #  ~~~~~~~~~~~~~~~~~~~~ Check Command ~~~~~~~~~~~~~~~~~~~~
         elif command == Commands.CHECK:
             qbf = args.qbf # already typed
             ferat: Path = args.ferat
+            native: bool = args.native
             # If the command picked is 'check', we skip all steps that
             # produce the FERAT proof and only check the RAT properties and
-            # the expansion
-            cnf_comp = tmp_dir / f"{qbf.stem!s}-fsplit.cnf"
-            rat_comp = tmp_dir / f"{qbf.stem!s}-fsplit.rat"
-            split_ferat(ferat, cnf_comp, rat_comp)
-            check_rat_proof(dependencies, cnf_comp, rat_comp, lrat)
-            check_expansion(dependencies, qbf, cnf_comp)
+            # the expansion. ferat-check reads the proof once, and checks both
+            # on its own, while LRAT mode needs lrat-trim on a split proof
+            ferat_check = dependencies / DepNames.ferat_check
+            if native and (not lrat) and ferat_check.is_file():
+                check_ferat_proof(dependencies, qbf, ferat, snapshot_dir)
+            else:
+                cnf_comp = tmp_dir / f"{qbf.stem!s}-fsplit.cnf"
+                rat_comp = tmp_dir / f"{qbf.stem!s}-fsplit.rat"
+                # The RAT section of an indexed proof runs to its end, so the
+                # checkers read it straight out of the proof instead of a
+                # copy. lrat-trim needs it as a file, so it always gets a copy
+                indexed = (not lrat) and has_ferat_index(ferat)
+                hinted, binary, rat_range = split_ferat(
+                    dependencies,
+                    ferat,
+                    cnf_comp,
+                    None if indexed else rat_comp,
+                )
+                if hinted and not lrat:
+                    status("FERAT proof carries LRAT hints")
+                rat_fd: int | None = None
+                if indexed:
+                    assert rat_range is not None
+                    rat_fd = os.open(ferat, os.O_RDONLY)
+                    if os.fstat(rat_fd).st_size != sum(rat_range):
+                        os.close(rat_fd)
+                        fatal(
+                            ExitCode.INVALID_FERAT_PROOF,
+                            "FERAT proof does not match its index",
+                        )
+                    os.lseek(rat_fd, rat_range[0], os.SEEK_SET)
+                # Both checks only read the split components, so they run
+                # side by side, and the first failure stops the other check
+                run_concurrently(
+                    lambda: check_rat_proof(
+                        dependencies,
+                        cnf_comp,
+                        rat_comp,
+                        lrat,
+                        hints=hinted,
+                        binary=binary,
+                        stdin=rat_fd,
+                        threads=threads,
+                    ),
+                    lambda: check_expansion(
+                        dependencies, qbf, cnf_comp, snapshot_dir
+                    ),
+                )
         #  }}}
+        exit_code = 0
 
     except FERATFatalError as ferr:
+        exit_code = ferr.exit_code
         ferr.exit()
     finally:
         end_profile(ProfileNames.TOTAL, start_time_us)
+        if (report is not None) and (args.command != Commands.VERSION):
+            if report_instances is None:
+                report_instances = [instance_report(
+                    args.qbf if (args.command == Commands.CHECK)
+                    else args.input[0],
+                    args.command,
+                    exit_code,
+                    1e-6 * (start_profile() - start_time_us),
+                    get_usage_records(),
+                )]
+            try:
+                write_report(report, report_instances)
+            except OSError as oserr:
+                warn(f"Unable to write report '{report!s}': {oserr!s}")
         if (not keep_tmp) and tmp_dir.is_dir(): shutil.rmtree(tmp_dir)
+        if (memory_dir is not None) and memory_dir.is_dir():
+            if keep_tmp: status(f"Kept intermediate files in '{memory_dir!s}'")
+            else: shutil.rmtree(memory_dir)
 
     # Success!
     sys.exit(0)
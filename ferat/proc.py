@@ -2,13 +2,20 @@
 #  Date: 17.01.2024
 #  (c) Marcel Simader 2024, Johannes Kepler Universität Linz
 
+import os
+import selectors
 import signal
 import subprocess
 import sys
-from io import StringIO
-from threading import Event, Lock, Thread, current_thread
-from time import perf_counter_ns
-from typing import IO, Any, Sequence
+from collections import deque
+from contextlib import ExitStack
+from dataclasses import dataclass, fields
+from pathlib import Path
+from queue import SimpleQueue
+from tempfile import TemporaryFile
+from threading import Lock, Thread, get_ident
+from time import monotonic, perf_counter_ns, sleep
+from typing import IO, Any, Callable, Final, Sequence
 
 from ferat.codes import ExitCode
 from ferat.utils import (
@@ -20,16 +27,234 @@ from ferat.utils import (
     fatal,
     get_show_color,
     get_show_command,
+    get_step,
     get_timeout,
     status,
     style,
-    write_encoding_agnostic,
 )
 
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Resource Accounting ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@dataclass
+class ResourceUsage:
+    """
+    The resources used by a process, as reported by 'wait4' or 'getrusage'.
+    On Linux, the peak memory of a subprocess includes what this process used
+    when it was forked.
+    """
+    wall_s: float = 0.0
+    user_s: float = 0.0
+    sys_s: float = 0.0
+    max_rss_kib: int = 0
+    in_blocks: int = 0
+    out_blocks: int = 0
+    voluntary_switches: int = 0
+    involuntary_switches: int = 0
+
+    @classmethod
+    def from_rusage(cls, wall_s: float, rusage: Any) -> "ResourceUsage":
+        return cls(
+            wall_s=wall_s,
+            user_s=rusage.ru_utime,
+            sys_s=rusage.ru_stime,
+            max_rss_kib=rusage.ru_maxrss,
+            in_blocks=rusage.ru_inblock,
+            out_blocks=rusage.ru_oublock,
+            voluntary_switches=rusage.ru_nvcsw,
+            involuntary_switches=rusage.ru_nivcsw,
+        )
+
+    def __add__(self, other: "ResourceUsage") -> "ResourceUsage":
+        summed = ResourceUsage(**{
+            field.name: getattr(self, field.name) + getattr(other, field.name)
+            for field in fields(self)
+        })
+        # Peak memory does not add up
+        summed.max_rss_kib = max(self.max_rss_kib, other.max_rss_kib)
+        return summed
+
+@dataclass
+class UsageRecord:
+    """
+    The resources used by one subprocess of a pipeline step.
+    """
+    step: str
+    tool: str
+    returncode: int
+    usage: ResourceUsage
+
+_usage_lock: Lock = Lock()
+_usage_records: list[UsageRecord] = []
+
+def get_usage_records() -> list[UsageRecord]:
+    with _usage_lock:
+        return list(_usage_records)
+
+def _record_usage(
+    tool: str, returncode: int, wall_s: float, rusage: Any | None
+) -> None:
+    usage = ResourceUsage(wall_s=wall_s) if (rusage is None) \
+        else ResourceUsage.from_rusage(wall_s, rusage)
+    record = UsageRecord(get_step() or "pipeline", tool, returncode, usage)
+    with _usage_lock:
+        _usage_records.append(record)
+
+def wait_with_usage(
+    proc: subprocess.Popen,
+    deadline: float | None,
+    timeout: float | None = None,
+) -> Any | None:
+    """
+    Waits for 'proc' to exit and reaps it with 'wait4', to get the resources
+    it used. Returns None if the process was reaped elsewhere. Raises
+    'TimeoutExpired' once 'deadline' passes.
+    """
+    def remaining() -> float | None:
+        if deadline is None: return None
+        time_left = deadline - monotonic()
+        if time_left <= 0.0:
+            raise subprocess.TimeoutExpired(proc.args, timeout or 0.0)
+        return time_left
+
+    pidfd: int | None = None
+    try:
+        pidfd = os.pidfd_open(proc.pid)
+    except (AttributeError, OSError):
+        pass
+    try:
+        if pidfd is not None:
+            # A pid file descriptor becomes readable once the process exits
+            with selectors.DefaultSelector() as selector:
+                selector.register(pidfd, selectors.EVENT_READ)
+                while len(selector.select(remaining())) == 0: pass
+            _, wait_status, rusage = os.wait4(proc.pid, 0)
+        else:
+            # The poll which finds the process exited has already reaped it,
+            # so its status is the one we keep
+            delay = 1e-3
+            while True:
+                pid, wait_status, rusage = os.wait4(proc.pid, os.WNOHANG)
+                if pid != 0: break
+                time_left = remaining()
+                sleep(delay if (time_left is None) else min(delay, time_left))
+                delay = min(2 * delay, 0.05)
+    except ChildProcessError:
+        proc.wait()
+        return None
+    finally:
+        if pidfd is not None: os.close(pidfd)
+    proc.returncode = os.waitstatus_to_exitcode(wait_status)
+    return rusage
+
 #  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 #  ~~~~~~~~~~~~~~~~~~~~ Process Execution ~~~~~~~~~~~~~~~~~~~~
 #  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+# The subprocess each thread is currently running, and the threads whose work
+# was cancelled, so that 'run_concurrently' can stop the processes of the
+# other threads when one of them fails
+_running_lock: Lock = Lock()
+_running: dict[int, subprocess.Popen] = {}
+_cancelled: set[int] = set()
+
+def _register_subprocess(proc: subprocess.Popen) -> None:
+    with _running_lock:
+        _running[get_ident()] = proc
+        if get_ident() in _cancelled: proc.kill()
+
+def _unregister_subprocess() -> None:
+    with _running_lock:
+        _running.pop(get_ident(), None)
+
+def _cancel_threads(threads: Sequence[Thread]) -> None:
+    with _running_lock:
+        for thread in threads:
+            if thread.ident is None: continue
+            _cancelled.add(thread.ident)
+            proc = _running.get(thread.ident)
+            if (proc is not None) and (proc.poll() is None): proc.kill()
+
+def run_concurrently(
+    *funcs: Callable[[], Any], cancel: bool = True
+) -> list[Any]:
+    """
+    Runs the given functions in their own threads, and returns their results
+    in order. When one of them raises an exception, the subprocesses of all
+    others are killed, and the first exception is re-raised once all threads
+    have stopped. If 'cancel' is False, all functions run to completion
+    instead, and exceptions are returned in place of their results.
+    """
+    results: list[Any] = [None] * len(funcs)
+    done: SimpleQueue[tuple[int, BaseException | None]] = SimpleQueue()
+
+    def run(i: int, func: Callable[[], Any]) -> None:
+        try:
+            results[i] = func()
+            done.put((i, None))
+        except BaseException as exc:
+            results[i] = exc
+            done.put((i, exc))
+
+    threads = [
+        Thread(name=f"ferat-concurrent-{i}", target=run, args=(i, func))
+        for i, func in enumerate(funcs)
+    ]
+    for thread in threads: thread.start()
+    first_exc: BaseException | None = None
+    try:
+        for _ in threads:
+            _, exc = done.get()
+            if cancel and (exc is not None) and (first_exc is None):
+                first_exc = exc
+                _cancel_threads(threads)
+    except BaseException as exc:
+        first_exc = exc
+        _cancel_threads(threads)
+    finally:
+        for thread in threads: thread.join()
+        with _running_lock:
+            for thread in threads: _cancelled.discard(thread.ident or 0)
+    if first_exc is not None: raise first_exc
+    return results
+
+def tee_pipe(from_fd: int, to_fd: int, to_file: SomePath) -> Thread:
+    """
+    Copies everything read from 'from_fd' both to 'to_fd' and to the file
+    'to_file' in a background thread, and closes both descriptors at the end.
+    When the reader of 'to_fd' goes away, the rest is still copied to the file,
+    so that the writer of 'from_fd' is never blocked.
+    """
+
+    def copy() -> None:
+        reader_open = True
+        try:
+            with open(to_file, "wb") as file:
+                while len(chunk := os.read(from_fd, CAPTURE_CHUNK_SIZE)) > 0:
+                    file.write(chunk)
+                    if not reader_open: continue
+                    try:
+                        view = memoryview(chunk)
+                        while len(view) > 0:
+                            view = view[os.write(to_fd, view):]
+                    except BrokenPipeError:
+                        reader_open = False
+        finally:
+            os.close(from_fd)
+            os.close(to_fd)
+
+    t = Thread(name=f"ferat-tee-{from_fd}", target=copy, daemon=True)
+    t.start()
+    return t
+
+def close_fds(fds: Sequence[int]) -> None:
+    for fd in fds:
+        try:
+            os.close(fd)
+        except OSError:
+            pass
+
 def assert_exit_code(expected: int | set[int], actual: int) -> None:
     """
     Asserts that the given exit code is either the exact value or one of
@@ -48,65 +273,109 @@ def assert_exit_code(expected: int | set[int], actual: int) -> None:
         f"Expected exit code {exps_str!s}, but got {actual!s}{signal_name!s}",
     )
 
-def async_pipe(
-    from_io: IO[bytes],
-    to_ios: Sequence[IO[str] | IO[bytes]],
-    colors: Sequence[EscSeq],
-    line_lock: Lock,
-    interrupt: Event,
-    timeout: float | None,
-) -> Thread:
-    timeout = -1.0 if (timeout is None) else timeout
-
-    def write_to_streams(content: bytes | None, *, flush: bool) -> None:
-        written: list[int] = []
-        for to_io, color in zip(to_ios, colors):
-            write_color = get_show_color() and (color is not NORMAL)
-            if content is not None:
-                if write_color: write_encoding_agnostic(color, to_io)
-                written.append(write_encoding_agnostic(content, to_io))
-            if write_color: write_encoding_agnostic(NORMAL, to_io)
-            if flush: to_io.flush()
-        assert (content is None) \
-            or all(num_bytes == len(content) for num_bytes in written)
-
-    def write_controller() -> None:
-        buf: bytes = b""
-        break_loop = False
-
-        line_lock.acquire(True, timeout)
-        while not break_loop:
-            break_loop = interrupt.is_set() or \
-                from_io.closed or (not from_io.readable())
-            if not break_loop:
-                ch = from_io.read(1)
-                if len(ch) > 0: buf += ch
-                else: break_loop = True
-            if len(buf) >= 2:
-                if buf.endswith(b"\r\n") or buf.endswith(b"\n\r"):
-                    # Skip carriage returns entirely in '\n\r' or '\r\n'
-                    buf = buf[:-2] + b"\n"
-            elif not break_loop:
-                # (not break_loop) and (not buffer_full), keep reading
-                continue
-            write_to_streams(buf, flush=False)
-            if b"\n" in buf:
-                # Give other threads opportunity to write some lines, but only
-                # if we just ended a whole line (or timed out)
-                if line_lock.locked(): line_lock.release()
-                line_lock.acquire(True, timeout)
-            buf = b""
-        # Write one last NORMAL, to be sure, and then flush
-        write_to_streams(None, flush=True)
-        if line_lock.locked(): line_lock.release()
-
-    t = Thread(
-        name=f"ferat-worker-{id(from_io)}",
-        target=write_controller,
-        daemon=True
-    )
-    t.start()
-    return t
+#  ~~~~~~~~~~~~~~~~~~~~ Output Capture ~~~~~~~~~~~~~~~~~~~~
+
+# Size of the chunks in which the output of a subprocess is read
+CAPTURE_CHUNK_SIZE: Final[int] = 1 << 16
+# Amount of output of each stream that is kept for the caller to parse. All
+# lines we look for are status lines at the very end of the output
+CAPTURE_RETAIN_SIZE: Final[int] = 1 << 20
+
+class OutputTail:
+    """
+    Keeps the last 'limit' bytes of a stream of output, in whole lines.
+    """
+
+    def __init__(self, limit: int = CAPTURE_RETAIN_SIZE) -> None:
+        self.limit = limit
+        self.chunks: deque[bytes] = deque()
+        self.size = 0
+        self.truncated = False
+
+    def append(self, data: bytes) -> None:
+        self.chunks.append(data)
+        self.size += len(data)
+        while (self.size - len(self.chunks[0])) >= self.limit:
+            self.size -= len(self.chunks.popleft())
+            self.truncated = True
+
+    def getvalue(self) -> str:
+        data = b"".join(self.chunks)
+        if len(data) > self.limit:
+            data = data[-self.limit:]
+            self.truncated = True
+        if self.truncated:
+            # Do not hand out the rest of a line whose start was dropped
+            data = data[data.find(b"\n") + 1:]
+        return data.decode(ENCODING["encoding"], errors="replace")
+
+    @classmethod
+    def from_file(cls, file: IO[bytes], limit: int = CAPTURE_RETAIN_SIZE) \
+            -> "OutputTail":
+        tail = cls(limit)
+        size = file.seek(0, os.SEEK_END)
+        file.seek(max(0, size - limit))
+        tail.truncated = size > limit
+        tail.append(file.read())
+        return tail
+
+class _ShownStream:
+    """
+    One output stream of a subprocess which is shown while it runs. Line ends
+    are normalized, and only whole lines are written, so that lines of the
+    standard output and error do not interleave.
+    """
+
+    def __init__(self, to_io: IO[str], color: EscSeq) -> None:
+        self.to_io = to_io
+        self.color = color
+        self.tail = OutputTail()
+        self.pending = b""
+
+    def feed(self, chunk: bytes) -> None:
+        data = self.pending + chunk
+        # Keep a trailing '\r', it may be the start of '\r\n'
+        keep_cr = data.endswith(b"\r") and (len(chunk) > 0)
+        if keep_cr: data = data[:-1]
+        data = data.replace(b"\r\n", b"\n").replace(b"\n\r", b"\n")
+        if len(chunk) == 0:
+            cut = len(data)
+        else:
+            cut = max(data.rfind(b"\n"), data.rfind(b"\r")) + 1
+            # Do not hold back overly long lines
+            if len(data) - cut >= CAPTURE_CHUNK_SIZE: cut = len(data)
+        self.pending = data[cut:] + (b"\r" if keep_cr else b"")
+        self.write(data[:cut])
+
+    def write(self, data: bytes) -> None:
+        if len(data) == 0: return
+        self.tail.append(data)
+        text = data.decode(ENCODING["encoding"], errors="replace")
+        if get_show_color() and (self.color is not NORMAL):
+            text = f"{self.color}{text}{NORMAL}"
+        self.to_io.write(text)
+        self.to_io.flush()
+
+def pump_output(
+    streams: dict[int, _ShownStream], deadline: float | None
+) -> None:
+    """
+    Reads the output of a subprocess in chunks, as it becomes available, until
+    all streams are closed. Raises 'TimeoutError' once 'deadline' passes.
+    """
+    with selectors.DefaultSelector() as selector:
+        for fd in streams: selector.register(fd, selectors.EVENT_READ)
+        while len(selector.get_map()) > 0:
+            timeout = None if (deadline is None) \
+                else max(0.0, deadline - monotonic())
+            events = selector.select(timeout)
+            if (len(events) == 0) and (deadline is not None) \
+                    and (monotonic() >= deadline):
+                raise TimeoutError()
+            for key, _ in events:
+                chunk = os.read(key.fd, CAPTURE_CHUNK_SIZE)
+                streams[key.fd].feed(chunk)
+                if len(chunk) == 0: selector.unregister(key.fd)
 
 def call_subprocess(
     args: Sequence[Any],
@@ -117,86 +386,102 @@ def call_subprocess(
     capture_color_stderr: EscSeq = NORMAL,
     shell: bool = False,
     cwd: SomePath | None = None,
+    stdin: int | None = None,
+    pass_fds: Sequence[int] = (),
 ) -> tuple[int, str, str, float]:
     """
     Function calling a subprocess. Potential exceptions and assertions are
     handled and logged automatically. Returns a tuple of an exit code, the
     stdout stream, the stderr stream, and the execution time in microseconds.
+    Only the last 'CAPTURE_RETAIN_SIZE' bytes of each stream are returned.
+    The file descriptors 'stdin' and 'pass_fds' are handed over to the
+    subprocess, and are closed in this process.
     """
+    proc: subprocess.Popen | None = None
+    arg_strs = tuple(str(arg) for arg in args)
+    timeout = None if (get_timeout() <= 0.0) else get_timeout()
     try:
-        arg_strs = tuple(str(arg) for arg in args)
         if get_show_command():
             only_capture = False
             status(f"Invoking '{' '.join(arg_strs)}'...")
         else:
             only_capture = True
-        start_time_us = perf_counter_ns() * 1e-3
-        proc = subprocess.Popen(
-            args=arg_strs,
-            stdout=subprocess.PIPE if capture_stdout else sys.stdout,
-            stderr=subprocess.PIPE if capture_stderr else sys.stderr,
-            shell=shell,
-            cwd=cwd,
-            text=False,
-            close_fds=True,
-        )
-        tot_time_us: float
-        stdout_io, stderr_io = StringIO(), StringIO()
-        timeout = None if (get_timeout() <= 0.0) else get_timeout()
-        if only_capture:
-            proc.wait(timeout)
-            tot_time_us = (perf_counter_ns() * 1e-3) - start_time_us
-            if proc.stdout is not None:
-                write_encoding_agnostic(proc.stdout.read(), stdout_io)
-            if proc.stderr is not None:
-                write_encoding_agnostic(proc.stderr.read(), stderr_io)
-        else:
-            t1, t2 = None, None
-            line_lock = Lock()
-            interrupt = Event()
-            interrupt.clear()
-            try:
+        stdout_tail, stderr_tail = OutputTail(), OutputTail()
+        with ExitStack() as files:
+            # When nothing is shown, the output goes straight to files, which
+            # are only read once the subprocess is done
+            def output_target(capture: bool, show_io: IO[str]) -> Any:
+                if not capture: return show_io
+                if not only_capture: return subprocess.PIPE
+                return files.enter_context(TemporaryFile())
+            stdout_target = output_target(capture_stdout, sys.stdout)
+            stderr_target = output_target(capture_stderr, sys.stderr)
+            start_time_us = perf_counter_ns() * 1e-3
+            deadline = None if (timeout is None) else monotonic() + timeout
+            proc = subprocess.Popen(
+                args=arg_strs,
+                stdout=stdout_target,
+                stderr=stderr_target,
+                shell=shell,
+                cwd=cwd,
+                text=False,
+                close_fds=True,
+                stdin=stdin,
+                pass_fds=pass_fds,
+            )
+            _register_subprocess(proc)
+            close_fds((*(() if (stdin is None) else (stdin,)), *pass_fds))
+            stdin, pass_fds = None, ()
+            if not only_capture:
+                streams: dict[int, _ShownStream] = {}
                 if proc.stdout is not None:
-                    t1 = async_pipe(
-                        proc.stdout,
-                        (stdout_io, sys.stdout),
-                        (NORMAL, capture_color_stdout),
-                        line_lock,
-                        interrupt,
-                        0.4,
+                    shown_stdout = _ShownStream(
+                        sys.stdout, capture_color_stdout
                     )
+                    streams[proc.stdout.fileno()] = shown_stdout
+                    stdout_tail = shown_stdout.tail
                 if proc.stderr is not None:
-                    proc.stderr
-                    t2 = async_pipe(
-                        proc.stderr,
-                        (stderr_io, sys.stderr),
-                        (NORMAL, capture_color_stderr),
-                        line_lock,
-                        interrupt,
-                        0.4,
+                    shown_stderr = _ShownStream(
+                        sys.stderr, capture_color_stderr
                     )
-                proc.wait(timeout)
-                #  if proc.stdout is not None:
-                #      proc.stdout.close()
-                #  if proc.stderr is not None:
-                #      proc.stderr.close()
-                tot_time_us = (perf_counter_ns() * 1e-3) - start_time_us
-            except Exception as exc:
-                proc.kill()
-                interrupt.set()
-                raise exc
-            finally:
-                if t1 is not None: t1.join()
-                if t2 is not None: t2.join()
+                    streams[proc.stderr.fileno()] = shown_stderr
+                    stderr_tail = shown_stderr.tail
+                try:
+                    pump_output(streams, deadline)
+                except TimeoutError:
+                    raise subprocess.TimeoutExpired(arg_strs, timeout or 0.0)
+            rusage = wait_with_usage(proc, deadline, timeout)
+            tot_time_us = (perf_counter_ns() * 1e-3) - start_time_us
+            _record_usage(
+                Path(arg_strs[0]).name,
+                proc.returncode,
+                1e-6 * tot_time_us,
+                rusage,
+            )
+            if only_capture:
+                if capture_stdout:
+                    stdout_tail = OutputTail.from_file(stdout_target)
+                if capture_stderr:
+                    stderr_tail = OutputTail.from_file(stderr_target)
         assert_exit_code(expected_exit, proc.returncode)
         return (
             proc.returncode,
-            stdout_io.getvalue(),
-            stderr_io.getvalue(),
+            stdout_tail.getvalue(),
+            stderr_tail.getvalue(),
             tot_time_us,
         )
     except subprocess.TimeoutExpired as e:
         fatal(ExitCode.PROCESS_TIMED_OUT, e)
     except (OSError, subprocess.SubprocessError) as e:
         fatal(ExitCode.PROCESS_OS_ERROR, e)
+    finally:
+        if proc is not None:
+            # Do not leave children behind when we give up on them
+            if proc.poll() is None:
+                proc.kill()
+                proc.wait()
+            for pipe in (proc.stdout, proc.stderr):
+                if pipe is not None: pipe.close()
+        close_fds((*(() if (stdin is None) else (stdin,)), *pass_fds))
+        _unregister_subprocess()
     assert False, "unhandled state"
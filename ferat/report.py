@@ -0,0 +1,99 @@
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import csv
+import json
+import resource
+from dataclasses import asdict, fields
+from functools import reduce
+from operator import add
+from pathlib import Path
+from typing import Any, Final, Sequence
+
+from ferat.proc import ResourceUsage, UsageRecord
+
+#  Resource Reports {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Resource Reports ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+CSV_KEYS: Final[tuple[str, ...]] = (
+    "input",
+    "command",
+    "exit_code",
+    "step",
+    "tool",
+    "returncode",
+    *(field.name for field in fields(ResourceUsage)),
+)
+
+def instance_report(
+    input_: Path,
+    command: str,
+    exit_code: int,
+    wall_s: float,
+    records: Sequence[UsageRecord],
+) -> dict[str, Any]:
+    """
+    Creates the report of one pipeline run, with the resources used by each
+    subprocess, by the pipeline itself, and in total.
+    """
+    own = ResourceUsage.from_rusage(
+        wall_s, resource.getrusage(resource.RUSAGE_SELF)
+    )
+    # The pipeline waits for its steps, so its own wall time is the total
+    total = reduce(add, (record.usage for record in records), own)
+    total.wall_s = wall_s
+    return {
+        "input": str(input_),
+        "command": command,
+        "exit_code": exit_code,
+        "steps": [
+            {
+                "step": record.step,
+                "tool": record.tool,
+                "returncode": record.returncode,
+                **asdict(record.usage),
+            }
+            for record in records
+        ],
+        "pipeline": asdict(own),
+        "total": asdict(total),
+    }
+
+def read_report(path: Path) -> list[dict[str, Any]]:
+    return json.loads(path.read_text())["instances"]
+
+def write_report(path: Path, instances: Sequence[dict[str, Any]]) -> None:
+    """
+    Writes the reports of one or more pipeline runs as JSON, or as CSV with
+    one row per subprocess, pipeline, and total, if 'path' ends in '.csv'.
+    """
+    if path.suffix.lower() != ".csv":
+        total = reduce(
+            add,
+            (ResourceUsage(**instance["total"]) for instance in instances),
+            ResourceUsage(),
+        )
+        path.write_text(
+            json.dumps(
+                {"instances": list(instances), "total": asdict(total)},
+                indent=2,
+            )
+        )
+        return
+    with open(path, "w", newline="") as file:
+        writer = csv.DictWriter(file, CSV_KEYS)
+        writer.writeheader()
+        for instance in instances:
+            common = {
+                key: instance[key] for key in ("input", "command", "exit_code")
+            }
+            for step in instance["steps"]:
+                writer.writerow({**common, **step})
+            for step in ("pipeline", "total"):
+                writer.writerow({**common, "step": step, **instance[step]})
+
+#  }}}
+# vim: foldmethod=marker
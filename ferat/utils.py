@@ -8,6 +8,7 @@ import sys
 from io import BytesIO, RawIOBase, StringIO, TextIOBase
 from os import PathLike
 from pathlib import Path
+from threading import RLock, local
 from typing import (
     IO,
     Any,
@@ -48,6 +49,9 @@ _SHOW_COLOR: bool = True
 _SHOW_COMMAND: bool = True
 _SHOW_STATUS: bool = True
 _PROFILE: bool = False
+_STATUS_LOCK: Final[RLock] = RLock()
+# The pipeline step each thread is currently in, for resource accounting
+_STEP: Final[local] = local()
 
 def set_timeout(v: float) -> None:
     global _TIMEOUT
@@ -115,6 +119,17 @@ def is_gzipped(file_path: SomePath) -> bool:
         warn(f"Encountered error while checking for gzipped file: {oerr!s}")
         return False
 
+# Start of the index line of FERAT proofs written by 'ferat-tools merge --index'
+FERAT_INDEX_TAG: Final[bytes] = b"c ferat-index 1 "
+
+def has_ferat_index(file_path: SomePath) -> bool:
+    try:
+        with open(file_path, 'rb') as file:
+            return file.read(len(FERAT_INDEX_TAG)) == FERAT_INDEX_TAG
+    except OSError as oerr:
+        warn(f"Encountered error while checking for an index: {oerr!s}")
+        return False
+
 def open_zip_agnostic(file_path: SomePath, mode: str) -> IO[str]:
     # TODO(Marcel): I feel like there is a nicer way to force files to open in
     #               text mode while also supporting gzip...
@@ -201,9 +216,11 @@ def status(
 ) -> None:
     indent = "" if (_indent <= _INDENT_BASE) else (" " * _indent)
     o = str(o)
-    for line in (o.splitlines() if (len(o) > 0) else (o,)):
-        print_style(color, f"[FERAT]{indent}", end="", file=file)
-        print(f" {line}", end=end, file=file, flush=flush)
+    # Concurrent pipeline steps must not interleave within a line
+    with _STATUS_LOCK:
+        for line in (o.splitlines() if (len(o) > 0) else (o,)):
+            print_style(color, f"[FERAT]{indent}", end="", file=file)
+            print(f" {line}", end=end, file=file, flush=flush)
 
 def warn(o: Any, /, color: EscSeq = WARNING, end: str = "\n") -> None:
     status(style(color, o), color, end, file=sys.stderr, flush=True)
@@ -255,10 +272,17 @@ def fatal(
         o = f"Exception '{o!s}' of type {type(o).__name__!r}"
     raise FERATFatalError(exit, o, color, end)
 
+def get_step() -> str | None:
+    """
+    Returns the name of the pipeline step the calling thread is in, if any.
+    """
+    return getattr(_STEP, "name", None)
+
 def status_function(func: Callable[_P, _R]) -> Callable[_P, _R]:
     """
     Wraps every function with this decorator in two status messages. If a doc
-    string is specified on the function, it will be printed as well.
+    string is specified on the function, it will be printed as well. While
+    the function runs, its name is the pipeline step of the calling thread.
     """
 
     def __wrapped__(*args: _P.args, **kwargs: _P.kwargs) -> _R:
@@ -270,7 +294,12 @@ def status_function(func: Callable[_P, _R]) -> Callable[_P, _R]:
                 for docstr_line in inspect.cleandoc(func.__doc__).splitlines():
                     status(style(DIM, f">>> {docstr_line}"))
             _indent -= _INDENT_CHANGE
-        ret = func(*args, **kwargs)
+        outer_step = get_step()
+        _STEP.name = func.__name__
+        try:
+            ret = func(*args, **kwargs)
+        finally:
+            _STEP.name = outer_step
         return ret
 
     __wrapped__.__name__ = f"wrapped_{func.__name__!s}"
@@ -0,0 +1,529 @@
+#! /usr/bin/env python3
+#  Author: Marcel Simader (marcel.simader@jku.at)
+#  Date: 17.10.2026
+#  (c) Marcel Simader 2026, Johannes Kepler Universität Linz
+
+import gzip
+import sys
+from argparse import ArgumentParser, Namespace
+from dataclasses import dataclass, field
+from itertools import accumulate, product
+from math import prod
+from pathlib import Path
+from random import Random
+from typing import IO, Final, Iterator, Sequence
+
+#  QBF {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ QBF ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+# The kinds of errors that can be put into an expansion, each of which the
+# checker reports for exactly the clauses it was put into
+INVALID_KINDS: Final[tuple[str, ...]] = ("literal", "annotation", "origin")
+
+@dataclass
+class Clause:
+    """
+    A QBF clause, with its existential literals as (block, position, sign),
+    and its universal literals as (block, position, sign), where the blocks
+    count from 0, and position is the index of the variable in its block.
+    """
+    lits: list[int]
+    exist: list[tuple[int, int, bool]]
+    univ: list[tuple[int, int, bool]]
+    # The assignments of each universal block up to the deepest existential
+    # block that falsify all universal literals of the clause in that block
+    falsifying: list[list[int]] = field(default_factory=list)
+
+    @property
+    def depth(self) -> int:
+        return 1 + max((block for block, _, _ in self.exist), default=-1)
+
+    @property
+    def num_expanded(self) -> int:
+        return prod(len(indices) for indices in self.falsifying)
+
+@dataclass
+class QBF:
+    """
+    A QBF with a prefix of 'num_blocks' pairs of a universal and an
+    existential block, and the sampled assignments of each universal block.
+    The variables of block 'k' are numbered after those of block 'k - 1',
+    universals first.
+    """
+    num_blocks: int
+    num_univ: int
+    num_exist: int
+    clauses: list[Clause]
+    assignments: list[list[int]]
+
+    def univ_var(self, block: int, pos: int) -> int:
+        return 1 + block * (self.num_univ + self.num_exist) + pos
+
+    def exist_var(self, block: int, pos: int) -> int:
+        return self.univ_var(block, self.num_univ + pos)
+
+    def is_exist(self, var: int) -> bool:
+        return (var - 1) % (self.num_univ + self.num_exist) >= self.num_univ
+
+    @property
+    def num_vars(self) -> int:
+        return self.num_blocks * (self.num_univ + self.num_exist)
+
+def sample_assignments(rng: Random, num_univ: int, num: int) -> list[int]:
+    """
+    Samples 'num' distinct assignments of a universal block as bit masks, in
+    complementary pairs, so that every literal of the block is satisfied by
+    some assignment whenever 'num' is at least 2.
+    """
+    full = (1 << num_univ) - 1
+    if num >= full + 1: return list(range(full + 1))
+    chosen: list[int] = []
+    while len(chosen) < num:
+        mask = rng.randint(0, full)
+        if mask in chosen: continue
+        chosen.append(mask)
+        if (len(chosen) < num) and (full ^ mask) not in chosen:
+            chosen.append(full ^ mask)
+    return chosen
+
+def generate_qbf(args: Namespace) -> QBF:
+    rng = Random(args.seed)
+    num_blocks, num_univ, num_exist = args.blocks, args.univ, args.exist
+    qbf = QBF(
+        num_blocks,
+        num_univ,
+        num_exist,
+        [],
+        [
+            sample_assignments(rng, num_univ, args.assignments)
+            for _ in range(num_blocks)
+        ],
+    )
+    num_vars = qbf.num_vars
+    block_size = num_univ + num_exist
+    for i in range(args.clauses + (1 if args.unsat else 0)):
+        if i == args.clauses:
+            # Falsified by some assignment, so its expansion is empty
+            variables = [qbf.univ_var(0, 0)]
+        else:
+            width = rng.randint(args.min_width, args.max_width)
+            variables = rng.sample(range(1, num_vars + 1), width)
+            if not any(map(qbf.is_exist, variables)):
+                variables[0] = qbf.exist_var(
+                    rng.randrange(num_blocks), rng.randrange(num_exist)
+                )
+        clause = Clause([], [], [])
+        for var in variables:
+            sign = (i == args.clauses) or (rng.random() < 0.5)
+            block, pos = divmod(var - 1, block_size)
+            clause.lits.append(var if sign else -var)
+            if pos < num_univ: clause.univ.append((block, pos, sign))
+            else: clause.exist.append((block, pos - num_univ, sign))
+        for block in range(clause.depth):
+            clause.falsifying.append([
+                index for index, mask in enumerate(qbf.assignments[block])
+                if all(
+                    bool(mask >> pos & 1) != sign
+                    for univ_block, pos, sign in clause.univ
+                    if univ_block == block
+                )
+            ])
+        qbf.clauses.append(clause)
+    return qbf
+
+#  }}}
+
+#  Expansion {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Expansion ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+@dataclass
+class Invalid:
+    """
+    An error put into the expansion of a clause, in its expansion with the
+    given ordinal, which is its 'index'-th clause overall (from 1).
+    """
+    kind: str
+    clause: int
+    ordinal: int
+    index: int = 0
+    # The clause claimed as origin, for 'origin' errors
+    origin: int = 0
+
+class Expansion:
+    """
+    The expansion of a QBF by all combinations of the sampled assignments
+    of its universal blocks. The copies of the existential block 'k' are
+    numbered after those of block 'k - 1', and copy 'i' of block 'k' belongs
+    to the 'i'-th combination of the assignments of blocks 0 to 'k' (in
+    mixed radix), so that clauses sorted by variable are sorted by block.
+    """
+
+    def __init__(self, qbf: QBF) -> None:
+        self.qbf = qbf
+        self.radices = [len(masks) for masks in qbf.assignments]
+        self.num_copies = list(accumulate(self.radices, lambda a, b: a * b))
+        self.bases = [
+            0, *accumulate(n * qbf.num_exist for n in self.num_copies)
+        ]
+
+    @property
+    def num_vars(self) -> int:
+        return self.bases[-1]
+
+    def var(self, block: int, copy: int, pos: int) -> int:
+        return 1 + self.bases[block] + copy * self.qbf.num_exist + pos
+
+    def mappings(self) -> Iterator[str]:
+        """
+        Yields the 'c x' lines of every copy of every existential block,
+        annotated with the assignments of the universal blocks up to it.
+        """
+        qbf = self.qbf
+        for block in range(qbf.num_blocks):
+            exist_vars = " ".join(
+                str(qbf.exist_var(block, pos)) for pos in range(qbf.num_exist)
+            )
+            chunks = [
+                [
+                    " ".join(
+                        str(qbf.univ_var(univ_block, pos)
+                            * (1 if (mask >> pos & 1) else -1))
+                        for pos in range(qbf.num_univ)
+                    ) for mask in qbf.assignments[univ_block]
+                ] for univ_block in range(block + 1)
+            ]
+            for copy, annotation in enumerate(product(*chunks)):
+                exp_vars = " ".join(
+                    str(self.var(block, copy, pos))
+                    for pos in range(qbf.num_exist)
+                )
+                yield (
+                    f"c x {exp_vars} 0 {exist_vars} 0"
+                    f" {' '.join(annotation)} 0"
+                )
+
+    def copies(self, digits: Sequence[int]) -> list[int]:
+        copies = []
+        copy = 0
+        for radix, digit in zip(self.radices, digits):
+            copy = copy * radix + digit
+            copies.append(copy)
+        return copies
+
+    def clause_lits(self, clause: Clause, copies: Sequence[int]) -> list[int]:
+        return [
+            self.var(block, copies[block], pos) * (1 if sign else -1)
+            for block, pos, sign in clause.exist
+        ]
+
+    def clauses(
+        self, invalid: dict[tuple[int, int], Invalid]
+    ) -> Iterator[str]:
+        """
+        Yields the expansion of each clause by every combination of the
+        assignments that falsify its universal literals, with errors put in
+        as given by 'invalid'.
+        """
+        for i, clause in enumerate(self.qbf.clauses):
+            for ordinal, digits in enumerate(product(*clause.falsifying)):
+                copies = self.copies(digits)
+                lits = self.clause_lits(clause, copies)
+                error = invalid.get((i, ordinal))
+                if error is not None:
+                    lits = self.corrupt(error, clause, digits, lits)
+                yield " ".join(map(str, (*lits, 0)))
+
+    def corrupt(
+        self,
+        error: Invalid,
+        clause: Clause,
+        digits: Sequence[int],
+        lits: list[int],
+    ) -> list[int]:
+        if error.kind == "literal":
+            # No clause contains the negated literal, as clauses have no
+            # complementary literals
+            lits[0] = -lits[0]
+        elif error.kind == "annotation":
+            # Use the copy of the deepest literal for an assignment that
+            # satisfies a universal literal of the clause, which must not be
+            # in the annotation
+            block = min(
+                block for block, indices in enumerate(clause.falsifying)
+                if len(indices) < self.radices[block]
+            )
+            other = next(
+                index for index in range(self.radices[block])
+                if index not in clause.falsifying[block]
+            )
+            wrong = [*digits[:block], other, *digits[block + 1:]]
+            deepest = max(
+                range(len(clause.exist)), key=lambda k: clause.exist[k][0]
+            )
+            wrong_lits = self.clause_lits(clause, self.copies(wrong))
+            lits[deepest] = wrong_lits[deepest]
+        return lits
+
+    def origins(
+        self, invalid: dict[tuple[int, int], Invalid]
+    ) -> Iterator[str]:
+        """
+        Yields the 'c o' line in chunks, one per clause.
+        """
+        yield "c o"
+        for i, clause in enumerate(self.qbf.clauses):
+            num = clause.num_expanded
+            if num == 0: continue
+            wrong = sorted(
+                (ordinal, error.origin)
+                for (j, ordinal), error in invalid.items()
+                if (j == i) and (error.kind == "origin")
+            )
+            if len(wrong) == 0:
+                yield f" {i + 1!s}" * num
+                continue
+            last = 0
+            for ordinal, origin in wrong:
+                yield f" {i + 1!s}" * (ordinal - last)
+                yield f" {origin + 1!s}"
+                last = ordinal + 1
+            yield f" {i + 1!s}" * (num - last)
+        yield " 0\n"
+
+def choose_invalid(
+    rng: Random, qbf: QBF, kind: str, num: int
+) -> dict[tuple[int, int], Invalid]:
+    def eligible(i: int, clause: Clause) -> bool:
+        if (clause.num_expanded == 0) or (len(clause.exist) == 0):
+            return False
+        if kind == "annotation":
+            return any(
+                len(indices) < len(qbf.assignments[block])
+                for block, indices in enumerate(clause.falsifying)
+            )
+        return True
+
+    exist_lits = [
+        frozenset(lit for lit in clause.lits if qbf.is_exist(abs(lit)))
+        for clause in qbf.clauses
+    ]
+    candidates = [
+        i for i, clause in enumerate(qbf.clauses) if eligible(i, clause)
+    ]
+    if len(candidates) == 0:
+        print(f"No clause can be made invalid by {kind!r}", file=sys.stderr)
+        sys.exit(1)
+    weights = [qbf.clauses[i].num_expanded for i in candidates]
+    num = min(num, sum(weights))
+    invalid: dict[tuple[int, int], Invalid] = {}
+    while len(invalid) < num:
+        i = rng.choices(candidates, weights)[0]
+        ordinal = rng.randrange(qbf.clauses[i].num_expanded)
+        if (i, ordinal) in invalid: continue
+        error = Invalid(kind, i, ordinal)
+        if kind == "origin":
+            # Any clause with other existential literals fails
+            others = [
+                j for j, lits in enumerate(exist_lits)
+                if lits != exist_lits[i]
+            ]
+            if len(others) == 0: continue
+            error.origin = rng.choice(others)
+        invalid[(i, ordinal)] = error
+    offsets = [0, *accumulate(clause.num_expanded for clause in qbf.clauses)]
+    for error in invalid.values():
+        error.index = offsets[error.clause] + error.ordinal + 1
+    return invalid
+
+#  }}}
+
+#  Output {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Output ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def open_output(path: Path) -> IO[str]:
+    if path.suffix == ".gz":
+        return gzip.open(path, "wt", compresslevel=1)
+    return open(path, "w", buffering=1 << 20)
+
+def write_qbf(path: Path, qbf: QBF, command: str) -> None:
+    with open_output(path) as file:
+        file.write(f"c {command}\n")
+        file.write(f"p cnf {qbf.num_vars!s} {len(qbf.clauses)!s}\n")
+        for block in range(qbf.num_blocks):
+            for quant, first in (("a", 0), ("e", qbf.num_univ)):
+                size = qbf.num_univ if (quant == "a") else qbf.num_exist
+                variables = " ".join(
+                    str(qbf.univ_var(block, first + pos))
+                    for pos in range(size)
+                )
+                file.write(f"{quant} {variables} 0\n")
+        for clause in qbf.clauses:
+            file.write(" ".join(map(str, (*clause.lits, 0))))
+            file.write("\n")
+
+def write_expansion(
+    path: Path,
+    expansion: Expansion,
+    invalid: dict[tuple[int, int], Invalid],
+) -> int:
+    num_clauses = sum(clause.num_expanded for clause in expansion.qbf.clauses)
+    with open_output(path) as file:
+        for line in expansion.mappings():
+            file.write(line)
+            file.write("\n")
+        for chunk in expansion.origins(invalid):
+            file.write(chunk)
+        file.write(f"p cnf {expansion.num_vars!s} {num_clauses!s}\n")
+        lines: list[str] = []
+        for line in expansion.clauses(invalid):
+            lines.append(line)
+            if len(lines) >= 4096:
+                lines.append("")
+                file.write("\n".join(lines))
+                lines.clear()
+        lines.append("")
+        file.write("\n".join(lines))
+    return num_clauses
+
+#  }}}
+
+#  Command Line {{{
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~ Command Line ~~~~~~~~~~~~~~~~~~~~
+#  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+def cli() -> Namespace:
+    parser = ArgumentParser(
+        description="Generates a random QBF, and directly a valid CNF" \
+                    " expansion of it with 'c x' and 'c o' sections, or one" \
+                    " with a given number of invalid clauses. The expansion" \
+                    " has one clause per QBF clause and combination of the" \
+                    " sampled assignments of the universal blocks up to its" \
+                    " deepest existential that falsifies its universal" \
+                    " literals.",
+    )
+    parser.add_argument(
+        "-b",
+        "--blocks",
+        help="sets the number of pairs of a universal and an existential" \
+             " block (default = 3)",
+        default=3,
+        type=int,
+    )
+    parser.add_argument(
+        "-u",
+        "--univ",
+        help="sets the number of universals per block (default = 4)",
+        default=4,
+        type=int,
+    )
+    parser.add_argument(
+        "-e",
+        "--exist",
+        help="sets the number of existentials per block (default = 8)",
+        default=8,
+        type=int,
+    )
+    parser.add_argument(
+        "-a",
+        "--assignments",
+        help="sets the number of sampled assignments per universal block," \
+             " which multiplies the size of the expansion per block" \
+             " (default = 4)",
+        default=4,
+        type=int,
+    )
+    parser.add_argument(
+        "-c",
+        "--clauses",
+        help="sets the number of QBF clauses (default = 1000)",
+        default=1000,
+        type=int,
+    )
+    parser.add_argument(
+        "--min-width",
+        help="sets the minimum clause width (default = 2)",
+        default=2,
+        type=int,
+    )
+    parser.add_argument(
+        "--max-width",
+        help="sets the maximum clause width (default = 6)",
+        default=6,
+        type=int,
+    )
+    parser.add_argument(
+        "--unsat",
+        help="adds a clause that some assignment falsifies, so that the" \
+             " expansion contains the empty clause",
+        action="store_true",
+    )
+    parser.add_argument(
+        "--invalid",
+        help="makes clauses of the expansion invalid, by negating a literal," \
+             " by using a variable with the wrong annotation, or by giving" \
+             " the wrong origin, and prints their indices",
+        choices=INVALID_KINDS,
+        default=None,
+    )
+    parser.add_argument(
+        "--num-invalid",
+        help="sets the number of invalid clauses (default = 1)",
+        default=1,
+        type=int,
+    )
+    parser.add_argument(
+        "-s",
+        "--seed",
+        help="sets the random seed (default = 0)",
+        default=0,
+        type=int,
+    )
+    parser.add_argument(
+        "qbf",
+        help="sets the path to the QBF, gzipped if it ends in '.gz'",
+        type=Path,
+    )
+    parser.add_argument(
+        "expansion",
+        help="sets the path to the CNF expansion, gzipped if it ends in '.gz'",
+        type=Path,
+    )
+    args = parser.parse_args()
+    if min(args.blocks, args.univ, args.exist, args.assignments) < 1:
+        parser.error("blocks, universals, existentials, and assignments" \
+                     " must be positive")
+    if not (1 <= args.min_width <= args.max_width):
+        parser.error("widths must satisfy 1 <= --min-width <= --max-width")
+    if args.max_width > args.blocks * (args.univ + args.exist):
+        parser.error("--max-width exceeds the number of variables")
+    return args
+
+def main() -> None:
+    args = cli()
+    qbf = generate_qbf(args)
+    expansion = Expansion(qbf)
+    invalid = {} if (args.invalid is None) else choose_invalid(
+        Random(args.seed + 1), qbf, args.invalid, args.num_invalid
+    )
+    command = " ".join(("expgen.py", *sys.argv[1:]))
+    write_qbf(args.qbf, qbf, command)
+    num_clauses = write_expansion(args.expansion, expansion, invalid)
+    print(
+        f"c expansion {expansion.num_vars!s} variables {num_clauses!s}"
+        " clauses"
+    )
+    for error in sorted(invalid.values(), key=lambda error: error.index):
+        print(f"c invalid {error.kind} {error.index!s}")
+
+if __name__ == "__main__":
+    main()
+
+#  }}}
+# vim: foldmethod=marker